@@ -0,0 +1,146 @@
+#pragma once
+
+#include <QtGlobal>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#endif
+
+// 自旋等待时的 CPU 提示：x86 上是 pause，ARM 上是 yield 指令；
+// 降低自旋对同核超线程的干扰，也避免退出自旋时的内存顺序冲突惩罚
+inline void cpuRelax()
+{
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    _mm_pause();
+#elif defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    asm volatile("yield" ::: "memory");
+#else
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+#endif
+}
+
+// 等待各阶段命中次数的快照
+struct AdaptiveWaitStats {
+    quint64 immediate = 0; // 不用等，条件已满足
+    quint64 spins = 0;     // 在自旋阶段等到
+    quint64 yields = 0;    // 在让出时间片阶段等到
+    quint64 parks = 0;     // 最终休眠等到
+    int spinBudget = 0;    // 当前自旋次数预算
+    quint64 avgWaitNs = 0; // 近期等待时长的指数滑动平均
+};
+
+/*
+ * AdaptiveWaiter：先自旋、再让出、最后休眠的自适应等待
+ *
+ * - 自旋阶段每次迭代执行一次 cpuRelax()，迭代次数按启动时测得的单次耗时换算成时间预算；
+ * - 每次等待结束后用实际等待时长更新 EWMA：近期等待普遍很短，就把自旋预算放大到约 2 倍 EWMA，
+ *   一旦等待长到超过休眠/唤醒本身的代价，自旋纯属浪费，预算收缩到最小值；
+ * - 只由一个线程（拥有它的消费者）调用 wait()，统计计数可被 UI 线程随时读取。
+ */
+class AdaptiveWaiter
+{
+public:
+    static constexpr int kMinSpin = 16;
+    static constexpr int kYieldRounds = 8;
+    static constexpr qint64 kMaxSpinNs = 50000;  // 单次自旋最长约 50 µs
+    static constexpr qint64 kParkCostNs = 20000; // 粗略的休眠 + 唤醒代价
+
+    AdaptiveWaiter() : m_spinBudget(kMinSpin) { m_stats.spinBudget.store(kMinSpin, std::memory_order_relaxed); }
+
+    // ready()：不加锁地检查条件是否满足；park()：休眠直到可能满足（允许虚假返回）
+    template <typename Ready, typename Park>
+    void wait(Ready ready, Park park)
+    {
+        if (ready()) {
+            m_stats.immediate.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        const auto begin = std::chrono::steady_clock::now();
+        for (int i = 0; i < m_spinBudget; ++i) {
+            cpuRelax();
+            if (ready()) {
+                finish(m_stats.spins, begin);
+                return;
+            }
+        }
+        for (int i = 0; i < kYieldRounds; ++i) {
+            std::this_thread::yield();
+            if (ready()) {
+                finish(m_stats.yields, begin);
+                return;
+            }
+        }
+        do {
+            park();
+        } while (!ready());
+        finish(m_stats.parks, begin);
+    }
+
+    AdaptiveWaitStats stats() const
+    {
+        AdaptiveWaitStats s;
+        s.immediate = m_stats.immediate.load(std::memory_order_relaxed);
+        s.spins = m_stats.spins.load(std::memory_order_relaxed);
+        s.yields = m_stats.yields.load(std::memory_order_relaxed);
+        s.parks = m_stats.parks.load(std::memory_order_relaxed);
+        s.spinBudget = m_stats.spinBudget.load(std::memory_order_relaxed);
+        s.avgWaitNs = m_stats.avgWaitNs.load(std::memory_order_relaxed);
+        return s;
+    }
+
+    // 单次 cpuRelax() 的耗时（纳秒），首次调用时测量一次
+    static double relaxNs()
+    {
+        static const double ns = [] {
+            constexpr int kRounds = 2000;
+            const auto begin = std::chrono::steady_clock::now();
+            for (int i = 0; i < kRounds; ++i) {
+                cpuRelax();
+            }
+            const auto total = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - begin).count();
+            return qMax(1.0, double(total) / kRounds);
+        }();
+        return ns;
+    }
+
+private:
+    void finish(std::atomic<quint64> &phase, std::chrono::steady_clock::time_point begin)
+    {
+        phase.fetch_add(1, std::memory_order_relaxed);
+        const qint64 waited = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - begin).count();
+        // EWMA，权重 1/8
+        m_ewmaNs += (double(waited) - m_ewmaNs) / 8.0;
+        retune();
+    }
+
+    void retune()
+    {
+        int budget = kMinSpin;
+        if (m_ewmaNs < kParkCostNs) {
+            const double spinNs = qMin(2.0 * m_ewmaNs, double(kMaxSpinNs));
+            budget = qMax(kMinSpin, static_cast<int>(spinNs / relaxNs()));
+        }
+        m_spinBudget = budget;
+        m_stats.spinBudget.store(budget, std::memory_order_relaxed);
+        m_stats.avgWaitNs.store(static_cast<quint64>(m_ewmaNs), std::memory_order_relaxed);
+    }
+
+    // 以下两项只由等待线程读写
+    int m_spinBudget;
+    double m_ewmaNs = 0.0;
+
+    struct {
+        std::atomic<quint64> immediate{0};
+        std::atomic<quint64> spins{0};
+        std::atomic<quint64> yields{0};
+        std::atomic<quint64> parks{0};
+        std::atomic<int> spinBudget{0};
+        std::atomic<quint64> avgWaitNs{0};
+    } m_stats;
+};
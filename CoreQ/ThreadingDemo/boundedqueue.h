@@ -0,0 +1,591 @@
+#pragma once
+
+#include <QDeadlineTimer>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSemaphore>
+#include <QWaitCondition>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// 队列状态变化时如何唤醒等待者
+enum class WakeStrategy {
+    WakeAll,  // 每次入队/出队都 wakeAll（旧行为）：多个等待者时一项唤醒所有人，只有一个能拿到
+    Counted,  // 记录等待者人数，没人等待时不碰条件变量，有人等待时按新增的元素/空位数 wakeOne
+    Semaphore // 空位和元素各用一个 QSemaphore 计数，release 一次恰好放行一个等待者
+};
+
+/*
+ * BoundedQueue：有界阻塞队列（QMutex + 两个 QWaitCondition，或两个 QSemaphore）
+ *
+ * 与 QVector<int> 版缓冲区相比：
+ * - 元素类型任意，支持只可移动的类型；入队/出队都是 move，emplace 直接在槽位上构造；
+ * - 存储是构造时一次性分配的环形槽位数组，入队/出队不再为每个元素分配内存，
+ *   出队也不需要像 takeFirst() 那样搬移剩余元素；
+ * - close() 之后入队全部失败，出队会先取完剩余元素再返回 false，便于优雅退出。
+ *
+ * 唤醒统计：wakeups() 是等待者被唤醒的次数（每次约等于一次上下文切换），
+ * wastedWakeups() 是醒来后条件仍不满足、只能再次休眠的次数。
+ */
+template <typename T>
+class BoundedQueue
+{
+public:
+    explicit BoundedQueue(std::size_t capacity, WakeStrategy wake = WakeStrategy::Counted)
+        : m_capacity(capacity > 0 ? capacity : 1)
+        , m_slots(new Slot[m_capacity])
+        , m_wake(wake)
+        , m_freeSlots(static_cast<int>(m_capacity))
+    {
+    }
+
+    ~BoundedQueue()
+    {
+        while (m_count > 0) {
+            slotAt(m_head)->~T();
+            m_head = (m_head + 1) % m_capacity;
+            --m_count;
+        }
+    }
+
+    BoundedQueue(const BoundedQueue &) = delete;
+    BoundedQueue &operator=(const BoundedQueue &) = delete;
+
+    WakeStrategy wakeStrategy() const { return m_wake; }
+
+    // 阻塞入队：队列满时等待，队列关闭时返回 false
+    bool push(const T &item) { return emplace(item); }
+    bool push(T &&item) { return emplace(std::move(item)); }
+
+    template <typename... Args>
+    bool emplace(Args &&...args)
+    {
+        if (m_wake == WakeStrategy::Semaphore) {
+            acquireFree(-1);
+            return constructAcquired(std::forward<Args>(args)...);
+        }
+        QMutexLocker locker(&m_mutex);
+        while (m_count == m_capacity && !m_closed) {
+            waitNotFull(ULONG_MAX);
+        }
+        if (m_closed) {
+            return false;
+        }
+        constructBack(std::forward<Args>(args)...);
+        signal(m_notEmpty, m_waitingConsumers, 1);
+        return true;
+    }
+
+    // 限时入队：满时最多等待 timeoutMs 毫秒；超时或已关闭返回 false，此时 item 不会被移动
+    bool pushFor(T &&item, int timeoutMs)
+    {
+        if (m_wake == WakeStrategy::Semaphore) {
+            if (!acquireFree(timeoutMs)) {
+                return false;
+            }
+            return constructAcquired(std::move(item));
+        }
+        QMutexLocker locker(&m_mutex);
+        if (m_count == m_capacity && !m_closed) {
+            const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+            while (m_count == m_capacity && !m_closed) {
+                const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    deadline - std::chrono::steady_clock::now()).count();
+                if (left <= 0) {
+                    return false;
+                }
+                waitNotFull(static_cast<unsigned long>(left));
+            }
+        }
+        if (m_closed) {
+            return false;
+        }
+        constructBack(std::move(item));
+        signal(m_notEmpty, m_waitingConsumers, 1);
+        return true;
+    }
+
+    // 覆盖入队：满时先丢弃最旧的一项再放入，从不阻塞；
+    // 返回被覆盖的项数（0 或 1），队列已关闭返回 -1
+    int pushOverwrite(T &&item)
+    {
+        if (m_wake == WakeStrategy::Semaphore) {
+            return pushOverwriteSemaphore(std::move(item));
+        }
+        QMutexLocker locker(&m_mutex);
+        if (m_closed) {
+            return -1;
+        }
+        int evicted = 0;
+        if (m_count == m_capacity) {
+            slotAt(m_head)->~T();
+            m_head = (m_head + 1) % m_capacity;
+            --m_count;
+            evicted = 1;
+        }
+        constructBack(std::move(item));
+        signal(m_notEmpty, m_waitingConsumers, 1);
+        return evicted;
+    }
+
+    // 非阻塞入队：满或已关闭时返回 false
+    bool tryPush(T &&item) { return tryEmplace(std::move(item)); }
+
+    template <typename... Args>
+    bool tryEmplace(Args &&...args)
+    {
+        if (m_wake == WakeStrategy::Semaphore) {
+            if (!m_freeSlots.tryAcquire()) {
+                return false;
+            }
+            return constructAcquired(std::forward<Args>(args)...);
+        }
+        QMutexLocker locker(&m_mutex);
+        if (m_closed || m_count == m_capacity) {
+            return false;
+        }
+        constructBack(std::forward<Args>(args)...);
+        signal(m_notEmpty, m_waitingConsumers, 1);
+        return true;
+    }
+
+    // 批量入队：逐段放入（每段一次加锁、一次唤醒），元素被 move 走；返回实际放入的数量
+    std::size_t pushBatch(T *items, std::size_t count)
+    {
+        if (m_wake == WakeStrategy::Semaphore) {
+            return pushBatchSemaphore(items, count);
+        }
+        std::size_t pushed = 0;
+        QMutexLocker locker(&m_mutex);
+        while (pushed < count) {
+            while (m_count == m_capacity && !m_closed) {
+                waitNotFull(ULONG_MAX);
+            }
+            if (m_closed) {
+                break;
+            }
+            const std::size_t begin = pushed;
+            while (pushed < count && m_count < m_capacity) {
+                constructBack(std::move(items[pushed]));
+                ++pushed;
+            }
+            signal(m_notEmpty, m_waitingConsumers, pushed - begin);
+        }
+        return pushed;
+    }
+
+    // 阻塞出队：队列空时等待；已关闭且取空后返回 false
+    bool pop(T &out)
+    {
+        if (m_wake == WakeStrategy::Semaphore) {
+            acquireUsed();
+            return takeAcquired(out);
+        }
+        QMutexLocker locker(&m_mutex);
+        while (m_count == 0 && !m_closed) {
+            waitNotEmpty();
+        }
+        if (m_count == 0) {
+            return false;
+        }
+        takeFront(out);
+        signal(m_notFull, m_waitingProducers, 1);
+        return true;
+    }
+
+    bool tryPop(T &out)
+    {
+        if (m_wake == WakeStrategy::Semaphore) {
+            if (!m_usedSlots.tryAcquire()) {
+                return false;
+            }
+            return takeAcquired(out);
+        }
+        QMutexLocker locker(&m_mutex);
+        if (m_count == 0) {
+            return false;
+        }
+        takeFront(out);
+        signal(m_notFull, m_waitingProducers, 1);
+        return true;
+    }
+
+    // 批量出队：至少等到一项，然后一次取走最多 maxItems 项追加到 out；返回取到的数量
+    std::size_t popBatch(std::vector<T> &out, std::size_t maxItems)
+    {
+        if (m_wake == WakeStrategy::Semaphore) {
+            return popBatchSemaphore(out, maxItems);
+        }
+        QMutexLocker locker(&m_mutex);
+        while (m_count == 0 && !m_closed) {
+            waitNotEmpty();
+        }
+        const std::size_t n = m_count < maxItems ? m_count : maxItems;
+        takeFrontN(out, n);
+        if (n > 0) {
+            signal(m_notFull, m_waitingProducers, n);
+        }
+        return n;
+    }
+
+    // 攒批出队：至少等到一项，之后最多再等 lingerUs 微秒凑满 maxItems 项（先到者为准），
+    // 一次取走追加到 out；返回取到的数量。lingerUs <= 0 时等同 popBatch
+    std::size_t popBatchFor(std::vector<T> &out, std::size_t maxItems, int lingerUs)
+    {
+        if (lingerUs <= 0 || maxItems <= 1) {
+            return popBatch(out, maxItems);
+        }
+        if (m_wake == WakeStrategy::Semaphore) {
+            return popBatchForSemaphore(out, maxItems, lingerUs);
+        }
+        QMutexLocker locker(&m_mutex);
+        while (m_count == 0 && !m_closed) {
+            waitNotEmpty();
+        }
+        if (m_count < maxItems && !m_closed) {
+            const QDeadlineTimer deadline(std::chrono::microseconds(lingerUs), Qt::PreciseTimer);
+            while (m_count < maxItems && !m_closed && !deadline.hasExpired()) {
+                waitNotEmpty(deadline);
+            }
+        }
+        const std::size_t n = m_count < maxItems ? m_count : maxItems;
+        takeFrontN(out, n);
+        if (n > 0) {
+            signal(m_notFull, m_waitingProducers, n);
+        }
+        return n;
+    }
+
+    // 关闭队列并唤醒所有等待者
+    void close()
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_closed) {
+            return;
+        }
+        m_closed = true;
+        m_notFull.wakeAll();
+        m_notEmpty.wakeAll();
+        if (m_wake == WakeStrategy::Semaphore) {
+            // 放出足够多的令牌让所有阻塞在 acquire 上的线程返回，醒来后看到 m_closed 即退出
+            m_freeSlots.release(kCloseTokens);
+            m_usedSlots.release(kCloseTokens);
+        }
+    }
+
+    bool isClosed() const
+    {
+        QMutexLocker locker(&m_mutex);
+        return m_closed;
+    }
+
+    std::size_t size() const
+    {
+        QMutexLocker locker(&m_mutex);
+        return m_count;
+    }
+
+    std::size_t capacity() const { return m_capacity; }
+
+    // 因满/空进入等待的累计次数（原子读，统计时不必争用队列锁）
+    quint64 fullWaits() const { return m_fullWaits.load(std::memory_order_relaxed); }
+    quint64 emptyWaits() const { return m_emptyWaits.load(std::memory_order_relaxed); }
+    // 生产者因队列满而阻塞的累计时长（纳秒）
+    quint64 fullWaitNs() const { return m_fullWaitNs.load(std::memory_order_relaxed); }
+    // 等待者被唤醒的次数，以及其中醒来后条件仍不满足的次数
+    quint64 wakeups() const { return m_wakeups.load(std::memory_order_relaxed); }
+    quint64 wastedWakeups() const { return m_wastedWakeups.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr int kCloseTokens = INT_MAX / 4;
+
+    struct Slot
+    {
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+
+    // ---- 条件变量模式（调用方持有 m_mutex） ----
+
+    void waitNotFull(unsigned long timeoutMs)
+    {
+        m_fullWaits.fetch_add(1, std::memory_order_relaxed);
+        ++m_waitingProducers;
+        const auto begin = std::chrono::steady_clock::now();
+        const bool woken = m_notFull.wait(&m_mutex, timeoutMs);
+        const auto waited = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - begin).count();
+        --m_waitingProducers;
+        m_fullWaitNs.fetch_add(static_cast<quint64>(waited), std::memory_order_relaxed);
+        countWakeup(woken, m_count == m_capacity && !m_closed);
+    }
+
+    void waitNotEmpty(QDeadlineTimer deadline = QDeadlineTimer(QDeadlineTimer::Forever))
+    {
+        m_emptyWaits.fetch_add(1, std::memory_order_relaxed);
+        ++m_waitingConsumers;
+        const bool woken = m_notEmpty.wait(&m_mutex, deadline);
+        --m_waitingConsumers;
+        countWakeup(woken, m_count == 0 && !m_closed);
+    }
+
+    // 超时返回的不算唤醒；醒来时条件仍不满足（被别人抢先）记为无效唤醒
+    void countWakeup(bool woken, bool stillBlocked)
+    {
+        if (!woken) {
+            return;
+        }
+        m_wakeups.fetch_add(1, std::memory_order_relaxed);
+        if (stillBlocked) {
+            m_wastedWakeups.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    // 新增了 n 个元素/空位后通知对侧等待者
+    void signal(QWaitCondition &cond, std::size_t waiting, std::size_t n)
+    {
+        if (m_wake == WakeStrategy::WakeAll) {
+            cond.wakeAll();
+            return;
+        }
+        // Counted：没人等待时直接跳过；有人等待时最多唤醒 n 个，多出的等待者继续睡
+        for (std::size_t i = 0; i < n && i < waiting; ++i) {
+            cond.wakeOne();
+        }
+    }
+
+    // ---- 信号量模式：m_freeSlots 计空位，m_usedSlots 计元素，m_mutex 只保护环形索引 ----
+
+    // 先尝试不阻塞地取令牌，失败才计一次等待；timeoutMs < 0 表示一直等
+    bool acquireFree(int timeoutMs)
+    {
+        if (m_freeSlots.tryAcquire()) {
+            return true;
+        }
+        m_fullWaits.fetch_add(1, std::memory_order_relaxed);
+        const auto begin = std::chrono::steady_clock::now();
+        bool acquired = true;
+        if (timeoutMs < 0) {
+            m_freeSlots.acquire();
+        } else {
+            acquired = m_freeSlots.tryAcquire(1, timeoutMs);
+        }
+        const auto waited = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - begin).count();
+        m_fullWaitNs.fetch_add(static_cast<quint64>(waited), std::memory_order_relaxed);
+        countWakeup(acquired, false);
+        return acquired;
+    }
+
+    void acquireUsed()
+    {
+        if (m_usedSlots.tryAcquire()) {
+            return;
+        }
+        m_emptyWaits.fetch_add(1, std::memory_order_relaxed);
+        m_usedSlots.acquire();
+        countWakeup(true, false);
+    }
+
+    // 在 acquire 到一个空位令牌后放入元素
+    template <typename... Args>
+    bool constructAcquired(Args &&...args)
+    {
+        {
+            QMutexLocker locker(&m_mutex);
+            if (m_closed) {
+                locker.unlock();
+                m_freeSlots.release();
+                return false;
+            }
+            constructBack(std::forward<Args>(args)...);
+        }
+        m_usedSlots.release();
+        return true;
+    }
+
+    // 在 acquire 到一个元素令牌后取出元素；关闭后令牌可能多于元素，取空即返回 false
+    bool takeAcquired(T &out)
+    {
+        {
+            QMutexLocker locker(&m_mutex);
+            if (m_count == 0) {
+                return false;
+            }
+            takeFront(out);
+        }
+        m_freeSlots.release();
+        return true;
+    }
+
+    int pushOverwriteSemaphore(T &&item)
+    {
+        // 有空位就占空位；没有就占一个元素令牌，把最旧的元素所在槽位直接让给新元素
+        bool evict = false;
+        for (;;) {
+            if (m_freeSlots.tryAcquire()) {
+                break;
+            }
+            if (m_usedSlots.tryAcquire()) {
+                evict = true;
+                break;
+            }
+            // 消费者已取走元素但还没归还空位令牌，稍等即可
+            std::this_thread::yield();
+        }
+        {
+            QMutexLocker locker(&m_mutex);
+            if (m_closed) {
+                locker.unlock();
+                (evict ? m_usedSlots : m_freeSlots).release();
+                return -1;
+            }
+            if (evict && m_count > 0) {
+                slotAt(m_head)->~T();
+                m_head = (m_head + 1) % m_capacity;
+                --m_count;
+            }
+            constructBack(std::move(item));
+        }
+        m_usedSlots.release();
+        return evict ? 1 : 0;
+    }
+
+    std::size_t pushBatchSemaphore(T *items, std::size_t count)
+    {
+        std::size_t pushed = 0;
+        while (pushed < count) {
+            acquireFree(-1);
+            // 第一个空位可能要等，其余只拿当前已有的，整段一次加锁、一次 release
+            int extra = qMin(static_cast<int>(count - pushed - 1), m_freeSlots.available());
+            if (extra > 0 && !m_freeSlots.tryAcquire(extra)) {
+                extra = 0;
+            }
+            const std::size_t n = static_cast<std::size_t>(extra) + 1;
+            {
+                QMutexLocker locker(&m_mutex);
+                if (m_closed) {
+                    locker.unlock();
+                    m_freeSlots.release(static_cast<int>(n));
+                    break;
+                }
+                for (std::size_t i = 0; i < n; ++i) {
+                    constructBack(std::move(items[pushed + i]));
+                }
+            }
+            pushed += n;
+            m_usedSlots.release(static_cast<int>(n));
+        }
+        return pushed;
+    }
+
+    std::size_t popBatchSemaphore(std::vector<T> &out, std::size_t maxItems)
+    {
+        if (maxItems == 0) {
+            return 0;
+        }
+        acquireUsed();
+        int extra = qMin(static_cast<int>(qMin<std::size_t>(maxItems - 1, INT_MAX)), m_usedSlots.available());
+        if (extra > 0 && !m_usedSlots.tryAcquire(extra)) {
+            extra = 0;
+        }
+        std::size_t n = 0;
+        {
+            QMutexLocker locker(&m_mutex);
+            n = qMin(static_cast<std::size_t>(extra) + 1, m_count);
+            takeFrontN(out, n);
+        }
+        if (n > 0) {
+            m_freeSlots.release(static_cast<int>(n));
+        }
+        return n;
+    }
+
+    // QSemaphore 的限时等待只精确到毫秒，凑批的等待时间因此会向上取整到毫秒
+    std::size_t popBatchForSemaphore(std::vector<T> &out, std::size_t maxItems, int lingerUs)
+    {
+        acquireUsed();
+        std::size_t tokens = 1;
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(lingerUs);
+        while (tokens < maxItems) {
+            if (m_usedSlots.tryAcquire()) {
+                ++tokens;
+                continue;
+            }
+            const auto leftUs = std::chrono::duration_cast<std::chrono::microseconds>(
+                deadline - std::chrono::steady_clock::now()).count();
+            if (leftUs <= 0 || !m_usedSlots.tryAcquire(1, static_cast<int>((leftUs + 999) / 1000))) {
+                break;
+            }
+            ++tokens;
+        }
+        std::size_t n = 0;
+        {
+            QMutexLocker locker(&m_mutex);
+            n = qMin(tokens, m_count);
+            takeFrontN(out, n);
+        }
+        if (n > 0) {
+            m_freeSlots.release(static_cast<int>(n));
+        }
+        return n;
+    }
+
+    // ---- 环形槽位（调用方持有 m_mutex） ----
+
+    T *slotAt(std::size_t index) { return std::launder(reinterpret_cast<T *>(m_slots[index].storage)); }
+
+    template <typename... Args>
+    void constructBack(Args &&...args)
+    {
+        const std::size_t tail = (m_head + m_count) % m_capacity;
+        new (m_slots[tail].storage) T(std::forward<Args>(args)...);
+        ++m_count;
+    }
+
+    void takeFront(T &out)
+    {
+        T *item = slotAt(m_head);
+        out = std::move(*item);
+        item->~T();
+        m_head = (m_head + 1) % m_capacity;
+        --m_count;
+    }
+
+    void takeFrontN(std::vector<T> &out, std::size_t n)
+    {
+        for (std::size_t i = 0; i < n; ++i) {
+            T *item = slotAt(m_head);
+            out.push_back(std::move(*item));
+            item->~T();
+            m_head = (m_head + 1) % m_capacity;
+            --m_count;
+        }
+    }
+
+    const std::size_t m_capacity;
+    std::unique_ptr<Slot[]> m_slots;
+    const WakeStrategy m_wake;
+    std::size_t m_head = 0;
+    std::size_t m_count = 0;
+    bool m_closed = false;
+    std::size_t m_waitingProducers = 0; // 受 m_mutex 保护
+    std::size_t m_waitingConsumers = 0;
+    std::atomic<quint64> m_fullWaits{0};
+    std::atomic<quint64> m_emptyWaits{0};
+    std::atomic<quint64> m_fullWaitNs{0};
+    std::atomic<quint64> m_wakeups{0};
+    std::atomic<quint64> m_wastedWakeups{0};
+
+    mutable QMutex m_mutex;
+    QWaitCondition m_notFull;
+    QWaitCondition m_notEmpty;
+    QSemaphore m_freeSlots;
+    QSemaphore m_usedSlots;
+};
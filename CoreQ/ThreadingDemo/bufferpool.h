@@ -0,0 +1,200 @@
+#pragma once
+
+#include <QMutex>
+#include <QMutexLocker>
+#include <QWaitCondition>
+#include <QtGlobal>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+template <typename T>
+class BufferPool;
+
+/*
+ * PooledBuffer：从 BufferPool 借出的一块缓冲区的句柄（只可移动）
+ *
+ * 在流水线各阶段之间传递的只是这个句柄（一个指针加一个引用计数），数据本身不复制；
+ * 句柄析构或 reset() 时缓冲区自动归还给池。句柄持有池的 shared_ptr，
+ * 所以即使取消时还有数据留在队列里，池也会等最后一个句柄归还后才销毁。
+ */
+template <typename T>
+class PooledBuffer
+{
+public:
+    PooledBuffer() = default;
+    ~PooledBuffer() { reset(); }
+
+    PooledBuffer(PooledBuffer &&other) noexcept
+        : m_pool(std::move(other.m_pool)), m_data(std::exchange(other.m_data, nullptr))
+    {
+    }
+
+    PooledBuffer &operator=(PooledBuffer &&other) noexcept
+    {
+        if (this != &other) {
+            reset();
+            m_pool = std::move(other.m_pool);
+            m_data = std::exchange(other.m_data, nullptr);
+        }
+        return *this;
+    }
+
+    PooledBuffer(const PooledBuffer &) = delete;
+    PooledBuffer &operator=(const PooledBuffer &) = delete;
+
+    explicit operator bool() const { return m_data != nullptr; }
+    T *data() { return m_data; }
+    const T *data() const { return m_data; }
+    std::size_t size() const { return m_pool ? m_pool->bufferSize() : 0; }
+    T &operator[](std::size_t i) { return m_data[i]; }
+    const T &operator[](std::size_t i) const { return m_data[i]; }
+
+    // 提前归还缓冲区
+    void reset()
+    {
+        if (m_data) {
+            m_pool->release(m_data);
+            m_data = nullptr;
+        }
+        m_pool.reset();
+    }
+
+private:
+    friend class BufferPool<T>;
+    PooledBuffer(std::shared_ptr<BufferPool<T>> pool, T *data) : m_pool(std::move(pool)), m_data(data) {}
+
+    std::shared_ptr<BufferPool<T>> m_pool;
+    T *m_data = nullptr;
+};
+
+/*
+ * BufferPool：固定数量、固定大小的缓冲区池
+ *
+ * - 所有缓冲区在 create() 时一次性分配（一整块连续内存，每块按缓存行对齐），之后不再分配；
+ * - 空闲缓冲区放在栈里（后进先出，刚归还的那块多半还在缓存中）；
+ * - acquire() 在池被借空时阻塞，等下游归还——池的大小因此也是流水线中在途数据量的上限，
+ *   相当于另一种背压；close() 让阻塞中和之后的 acquire() 立即失败，用于取消。
+ * 必须通过 create() 以 shared_ptr 持有（句柄要引用池）。
+ */
+template <typename T>
+class BufferPool : public std::enable_shared_from_this<BufferPool<T>>
+{
+    static_assert(std::is_trivially_destructible<T>::value, "缓冲区元素只在池构造时初始化，不会逐个析构");
+
+public:
+    static std::shared_ptr<BufferPool> create(std::size_t buffers, std::size_t bufferSize)
+    {
+        return std::shared_ptr<BufferPool>(new BufferPool(buffers, bufferSize));
+    }
+
+    BufferPool(const BufferPool &) = delete;
+    BufferPool &operator=(const BufferPool &) = delete;
+
+    // 借出一块缓冲区（内容是上一次使用留下的，调用方负责覆盖）；池已关闭时返回空句柄
+    PooledBuffer<T> acquire()
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_free.empty() && !m_closed) {
+            m_exhaustedWaits.fetch_add(1, std::memory_order_relaxed);
+            do {
+                m_available.wait(&m_mutex);
+            } while (m_free.empty() && !m_closed);
+        }
+        if (m_closed) {
+            return PooledBuffer<T>();
+        }
+        T *data = m_free.back();
+        m_free.pop_back();
+        const std::size_t inUse = m_buffers - m_free.size();
+        m_inUse.store(inUse, std::memory_order_relaxed);
+        if (inUse > m_peakInUse.load(std::memory_order_relaxed)) {
+            m_peakInUse.store(inUse, std::memory_order_relaxed);
+        }
+        return PooledBuffer<T>(this->shared_from_this(), data);
+    }
+
+    void close()
+    {
+        QMutexLocker locker(&m_mutex);
+        m_closed = true;
+        m_available.wakeAll();
+    }
+
+    std::size_t bufferSize() const { return m_bufferSize; }
+    std::size_t bufferCount() const { return m_buffers; }
+    std::size_t inUse() const { return m_inUse.load(std::memory_order_relaxed); }
+    std::size_t peakInUse() const { return m_peakInUse.load(std::memory_order_relaxed); }
+    // 池做过的堆分配次数（缓冲区存储和空闲栈），在各分配处计数：稳态下借还不分配，保持不变
+    quint64 allocations() const { return m_allocations.load(std::memory_order_relaxed); }
+    // acquire() 因池被借空而等待的次数
+    quint64 exhaustedWaits() const { return m_exhaustedWaits.load(std::memory_order_relaxed); }
+
+private:
+    friend class PooledBuffer<T>;
+    static constexpr std::size_t kAlign = 64;
+
+    BufferPool(std::size_t buffers, std::size_t bufferSize)
+        : m_buffers(buffers > 0 ? buffers : 1)
+        , m_bufferSize(bufferSize > 0 ? bufferSize : 1)
+        , m_stride((m_bufferSize * sizeof(T) + kAlign - 1) / kAlign * kAlign)
+        , m_storage(allocateStorage(m_stride * m_buffers))
+    {
+        m_free.reserve(m_buffers);
+        if (m_free.capacity() > 0) {
+            m_allocations.fetch_add(1, std::memory_order_relaxed);
+        }
+        for (std::size_t i = m_buffers; i > 0; --i) {
+            T *data = reinterpret_cast<T *>(m_storage.get() + (i - 1) * m_stride);
+            std::uninitialized_value_construct_n(data, m_bufferSize);
+            pushFree(data);
+        }
+    }
+
+    unsigned char *allocateStorage(std::size_t bytes)
+    {
+        m_allocations.fetch_add(1, std::memory_order_relaxed);
+        return new (std::align_val_t(kAlign)) unsigned char[bytes];
+    }
+
+    // 空闲栈容量变了说明 vector 重新分配过，同样计入（预留了全部缓冲区，正常不会发生）
+    void pushFree(T *data)
+    {
+        const std::size_t capacity = m_free.capacity();
+        m_free.push_back(data);
+        if (m_free.capacity() != capacity) {
+            m_allocations.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    void release(T *data)
+    {
+        QMutexLocker locker(&m_mutex);
+        pushFree(data);
+        m_inUse.store(m_buffers - m_free.size(), std::memory_order_relaxed);
+        m_available.wakeOne();
+    }
+
+    struct AlignedDelete {
+        void operator()(unsigned char *p) const { ::operator delete[](p, std::align_val_t(kAlign)); }
+    };
+
+    const std::size_t m_buffers;
+    const std::size_t m_bufferSize;
+    const std::size_t m_stride;
+    std::atomic<quint64> m_allocations{0}; // 在 m_storage 之前声明：构造 m_storage 时就要计数
+    std::unique_ptr<unsigned char[], AlignedDelete> m_storage;
+
+    QMutex m_mutex;
+    QWaitCondition m_available;
+    std::vector<T *> m_free; // 只在 m_mutex 内访问
+    bool m_closed = false;
+
+    std::atomic<std::size_t> m_inUse{0};
+    std::atomic<std::size_t> m_peakInUse{0};
+    std::atomic<quint64> m_exhaustedWaits{0};
+};
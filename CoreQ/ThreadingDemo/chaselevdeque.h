@@ -0,0 +1,125 @@
+#pragma once
+
+#include <QtGlobal>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+/*
+ * ChaseLevDeque：工作窃取用的无锁双端队列（Chase & Lev 2005，内存序按 Lê 等 2013 的 C11 版本）
+ *
+ * - 只有拥有者线程调用 push()/pop()，操作 bottom 一端（LIFO，刚拆出来的子任务最热、最先做）；
+ * - 任意线程都可以 steal()，从 top 一端取最老的任务（通常是粒度最大的那一块）；
+ * - 只剩最后一个元素时拥有者和窃取者用 top 上的 CAS 决出胜负；
+ * - 环形数组满了由拥有者扩容为两倍，旧数组可能还被窃取者读着，留到析构时统一释放。
+ * 论文里 push 用的是 release 栅栏 + relaxed 写 bottom，这里直接对 bottom 做 release 写，x86 上两者相同。
+ * 只存放指针，元素本身的生命周期由调用方管理。
+ */
+template <typename T>
+class ChaseLevDeque
+{
+public:
+    explicit ChaseLevDeque(std::size_t initialCapacity = 256)
+    {
+        std::size_t capacity = 1;
+        while (capacity < initialCapacity) {
+            capacity <<= 1;
+        }
+        m_retired.emplace_back(new Array(capacity));
+        m_array.store(m_retired.back().get(), std::memory_order_relaxed);
+    }
+
+    ChaseLevDeque(const ChaseLevDeque &) = delete;
+    ChaseLevDeque &operator=(const ChaseLevDeque &) = delete;
+
+    // 仅拥有者
+    void push(T *item)
+    {
+        const qint64 b = m_bottom.load(std::memory_order_relaxed);
+        const qint64 t = m_top.load(std::memory_order_acquire);
+        Array *array = m_array.load(std::memory_order_relaxed);
+        if (b - t > static_cast<qint64>(array->capacity) - 1) {
+            array = grow(array, t, b);
+        }
+        array->put(b, item);
+        // release：窃取者 acquire 读到新的 bottom 时，也能看到元素和它指向的任务内容
+        m_bottom.store(b + 1, std::memory_order_release);
+    }
+
+    // 仅拥有者；空时返回 nullptr
+    T *pop()
+    {
+        const qint64 b = m_bottom.load(std::memory_order_relaxed) - 1;
+        Array *array = m_array.load(std::memory_order_relaxed);
+        m_bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        qint64 t = m_top.load(std::memory_order_relaxed);
+        if (t > b) {
+            m_bottom.store(b + 1, std::memory_order_release);
+            return nullptr;
+        }
+        T *item = array->get(b);
+        if (t == b) {
+            // 最后一个元素：和窃取者抢
+            if (!m_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                item = nullptr;
+            }
+            m_bottom.store(b + 1, std::memory_order_release);
+        }
+        return item;
+    }
+
+    // 任意线程；空或与其他线程竞争失败时返回 nullptr（失败时调用方换一个目标即可，不必重试）
+    T *steal()
+    {
+        qint64 t = m_top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const qint64 b = m_bottom.load(std::memory_order_acquire);
+        if (t >= b) {
+            return nullptr;
+        }
+        Array *array = m_array.load(std::memory_order_acquire);
+        T *item = array->get(t);
+        if (!m_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            return nullptr;
+        }
+        return item;
+    }
+
+    // 近似长度，仅用于统计和判断是否值得去偷
+    std::size_t sizeApprox() const
+    {
+        const qint64 b = m_bottom.load(std::memory_order_relaxed);
+        const qint64 t = m_top.load(std::memory_order_relaxed);
+        return b > t ? static_cast<std::size_t>(b - t) : 0;
+    }
+
+private:
+    struct Array {
+        explicit Array(std::size_t n) : capacity(n), mask(n - 1), slots(new std::atomic<T *>[n]) {}
+
+        T *get(qint64 i) const { return slots[static_cast<std::size_t>(i) & mask].load(std::memory_order_relaxed); }
+        void put(qint64 i, T *item) { slots[static_cast<std::size_t>(i) & mask].store(item, std::memory_order_relaxed); }
+
+        const std::size_t capacity;
+        const std::size_t mask;
+        std::unique_ptr<std::atomic<T *>[]> slots;
+    };
+
+    Array *grow(Array *old, qint64 t, qint64 b)
+    {
+        m_retired.emplace_back(new Array(old->capacity * 2));
+        Array *array = m_retired.back().get();
+        for (qint64 i = t; i < b; ++i) {
+            array->put(i, old->get(i));
+        }
+        m_array.store(array, std::memory_order_release);
+        return array;
+    }
+
+    alignas(64) std::atomic<qint64> m_top{0};
+    alignas(64) std::atomic<qint64> m_bottom{0};
+    std::atomic<Array *> m_array{nullptr};
+    std::vector<std::unique_ptr<Array>> m_retired; // 当前数组和扩容前的旧数组，只有拥有者修改
+};
@@ -69,6 +69,10 @@ void ConditionVariableWidget::initUI()
     
     m_statusLabel = new QLabel("就绪");
     statusLayout->addWidget(m_statusLabel);
+
+    m_waitStatsLabel = new QLabel();
+    m_waitStatsLabel->setToolTip("消费者等待数据时：立即拿到 / 自旋中等到 / 让出时间片后等到 / 休眠后被唤醒");
+    statusLayout->addWidget(m_waitStatsLabel);
     
     // Log Area
     m_logDisplay = new QTextEdit();
@@ -100,6 +104,10 @@ void ConditionVariableWidget::startProducerConsumer()
     
     // Start Consumers
     int consumers = m_consumerCount->value();
+    m_waiters.clear();
+    for (int i = 0; i < consumers; ++i) {
+        m_waiters.emplace_back(new AdaptiveWaiter);
+    }
     for (int i = 0; i < consumers; ++i) {
         m_threads.emplace_back(&ConditionVariableWidget::consumerThread, this, i + 1);
     }
@@ -111,8 +119,13 @@ void ConditionVariableWidget::stopAll()
 {
     if (!m_running) return;
     
-    m_running = false;
-    
+    // 在 m_mutex 内清除运行标志：消费者在条件变量上休眠时不带超时，
+    // 如果不加锁，它检查完谓词、还没真正睡下时这次写入和下面的 notify_all 可能都被错过，join 就会一直卡住
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_running = false;
+    }
+
     // 唤醒所有等待中的线程，让它们有机会检查 m_running 并退出
     m_cv_not_empty.notify_all();
     m_cv_not_full.notify_all();
@@ -128,6 +141,7 @@ void ConditionVariableWidget::stopAll()
     std::lock_guard<std::mutex> lock(m_mutex);
     std::queue<int> empty;
     std::swap(m_buffer, empty);
+    m_bufferCount = 0;
     
     m_startBtn->setEnabled(true);
     m_stopBtn->setEnabled(false);
@@ -159,6 +173,7 @@ void ConditionVariableWidget::producerThread()
         // 生产数据
         int data = ++m_producedCount;
         m_buffer.push(data);
+        m_bufferCount.store(static_cast<int>(m_buffer.size()), std::memory_order_release);
         
         logMessage(QString("生产者 生产了数据: %1 (缓冲: %2)").arg(data).arg(m_buffer.size()));
         
@@ -174,21 +189,27 @@ void ConditionVariableWidget::producerThread()
 
 void ConditionVariableWidget::consumerThread(int id)
 {
+    AdaptiveWaiter &waiter = *m_waiters[static_cast<size_t>(id - 1)];
     while (m_running) {
+        // 等待缓冲区不空：先不加锁地自旋/让出，短等待不必进内核；
+        // 仍等不到才在条件变量上休眠，由生产者 notify_one 或 stopAll 的 notify_all 唤醒（不再定时轮询）
+        waiter.wait([this] {
+            return m_bufferCount.load(std::memory_order_acquire) > 0 || !m_running;
+        }, [this] {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cv_not_empty.wait(lock, [this] { return !m_buffer.empty() || !m_running; });
+        });
+
         std::unique_lock<std::mutex> lock(m_mutex);
-        
-        // 等待缓冲区不空
-        if (!m_cv_not_empty.wait_for(lock, std::chrono::milliseconds(100), [this] {
-            return !m_buffer.empty() || !m_running;
-        })) {
-            continue;
-        }
-        
         if (!m_running) break;
+        if (m_buffer.empty()) {
+            continue; // 被其他消费者抢先取走了
+        }
         
         // 消费数据
         int data = m_buffer.front();
         m_buffer.pop();
+        m_bufferCount.store(static_cast<int>(m_buffer.size()), std::memory_order_release);
         m_consumedCount++;
         
         logMessage(QString("消费者#%1 消费了数据: %2 (缓冲: %3)").arg(id).arg(data).arg(m_buffer.size()));
@@ -234,6 +255,15 @@ void ConditionVariableWidget::updateUI()
         m_statusLabel->setText(QString("运行中 - 生产总数: %1, 消费总数: %2")
                                .arg(m_producedCount).arg(m_consumedCount));
     }
+
+    QStringList waitLines;
+    for (size_t i = 0; i < m_waiters.size(); ++i) {
+        const AdaptiveWaitStats st = m_waiters[i]->stats();
+        waitLines << QString("消费者#%1: 立即 %2 | 自旋 %3 | 让出 %4 | 休眠 %5 | 自旋预算 %6 次 | 平均等待 %7 µs")
+                         .arg(i + 1).arg(st.immediate).arg(st.spins).arg(st.yields).arg(st.parks)
+                         .arg(st.spinBudget).arg(st.avgWaitNs / 1000.0, 0, 'f', 1);
+    }
+    m_waitStatsLabel->setText(waitLines.join('\n'));
 }
 
 void ConditionVariableWidget::clearLog()
@@ -13,6 +13,9 @@
 #include <thread>
 #include <queue>
 #include <atomic>
+#include <memory>
+#include <vector>
+#include "adaptivewait.h"
 
 /**
  * @class ConditionVariableWidget
@@ -22,6 +25,7 @@
  * 1. wait(): 消费者等待数据
  * 2. notify_one() / notify_all(): 生产者唤醒消费者
  * 3. unique_lock: 配合条件变量使用的锁
+ * 4. 消费者用 AdaptiveWaiter 先自旋、再让出、最后才在条件变量上休眠
  */
 class ConditionVariableWidget : public QWidget
 {
@@ -52,6 +56,7 @@ private:
     QTextEdit *m_logDisplay;
     QProgressBar *m_bufferBar;
     QLabel *m_statusLabel;
+    QLabel *m_waitStatsLabel; // 每个消费者的等待阶段统计
     
     // Threading members
     std::mutex m_mutex;
@@ -60,6 +65,10 @@ private:
     
     std::queue<int> m_buffer;
     const size_t MAX_BUFFER_SIZE = 10;
+    std::atomic<int> m_bufferCount{0}; // m_buffer 大小的镜像（持锁写），供消费者自旋时无锁检查
+
+    // 每个消费者一个自适应等待器，下标为 id - 1
+    std::vector<std::unique_ptr<AdaptiveWaiter>> m_waiters;
     
     std::vector<std::thread> m_threads;
     std::atomic<bool> m_running{false};
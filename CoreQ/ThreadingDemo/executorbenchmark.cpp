@@ -0,0 +1,159 @@
+#include "executorbenchmark.h"
+#include <QThread>
+#include <QThreadPool>
+#include <algorithm>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <random>
+#include <vector>
+#include "taskexecutor.h"
+#include "workstealingpool.h"
+
+namespace {
+
+// 串行执行器：invoke 依次执行两边，顺便数一下拆了多少次
+class InlineExecutor : public TaskExecutor
+{
+public:
+    QString name() const override { return "串行"; }
+    int threadCount() const override { return 1; }
+    void execute(std::function<void()> task) override { task(); }
+    void invoke(const std::function<void()> &a, const std::function<void()> &b) override
+    {
+        ++forks;
+        a();
+        b();
+    }
+
+    quint64 forks = 0;
+};
+
+quint64 serialFib(int n)
+{
+    return n < 2 ? static_cast<quint64>(n) : serialFib(n - 1) + serialFib(n - 2);
+}
+
+quint64 parallelFib(TaskExecutor &executor, int n, int cutoff)
+{
+    if (n <= cutoff) {
+        return serialFib(n);
+    }
+    quint64 x = 0;
+    quint64 y = 0;
+    executor.invoke([&] { x = parallelFib(executor, n - 1, cutoff); },
+                    [&] { y = parallelFib(executor, n - 2, cutoff); });
+    return x + y;
+}
+
+int medianOfThree(int a, int b, int c)
+{
+    return std::max(std::min(a, b), std::min(std::max(a, b), c));
+}
+
+// 三路划分（< 枢轴、== 枢轴、> 枢轴），两侧递归；重复值很多时中间一段直接跳过，不会退化
+void parallelQuickSort(TaskExecutor &executor, int *first, int *last, int cutoff)
+{
+    if (last - first <= cutoff) {
+        std::sort(first, last);
+        return;
+    }
+    const int pivot = medianOfThree(*first, first[(last - first) / 2], *(last - 1));
+    int *lessEnd = std::partition(first, last, [pivot](int v) { return v < pivot; });
+    int *equalEnd = std::partition(lessEnd, last, [pivot](int v) { return !(pivot < v); });
+    executor.invoke([&] { parallelQuickSort(executor, first, lessEnd, cutoff); },
+                    [&] { parallelQuickSort(executor, equalEnd, last, cutoff); });
+}
+
+// 根任务也交给执行器：让递归从工作线程里开始，调用线程只等结果
+// （promise 随任务一起销毁，等待方在 set_value() 还没返回时就离开也不会访问已销毁的对象）
+void runOn(TaskExecutor &executor, const std::function<void()> &work)
+{
+    auto done = std::make_shared<std::promise<void>>();
+    std::future<void> finished = done->get_future();
+    executor.execute([&work, done] {
+        work();
+        done->set_value();
+    });
+    finished.wait();
+}
+
+quint64 elapsedNs(std::chrono::steady_clock::time_point begin)
+{
+    return static_cast<quint64>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - begin).count());
+}
+
+} // namespace
+
+QVector<ExecutorBenchResult> runExecutorBenchmark(const ExecutorBenchConfig &config)
+{
+    const int threads = config.threads > 0 ? config.threads : qMax(1, QThread::idealThreadCount());
+    const int cutoff = qMax(1, config.cutoff);
+    const int repeats = qMax(1, config.repeats);
+
+    std::vector<int> input;
+    if (config.workload == ExecutorWorkload::QuickSort) {
+        std::mt19937 rng(12345);
+        input.resize(static_cast<std::size_t>(config.size) * 1000);
+        for (int &v : input) {
+            v = static_cast<int>(rng() % 1000000);
+        }
+    }
+    const quint64 expectedFib = config.workload == ExecutorWorkload::Fibonacci ? serialFib(config.size) : 0;
+
+    // 跑 repeats 次取最快，并检查结果
+    auto measure = [&](TaskExecutor &executor, ExecutorBenchResult &result) {
+        result.executor = executor.name();
+        result.threads = executor.threadCount();
+        result.correct = true;
+        for (int i = 0; i < repeats; ++i) {
+            std::vector<int> data = input;
+            quint64 fib = 0;
+            const auto begin = std::chrono::steady_clock::now();
+            runOn(executor, [&] {
+                if (config.workload == ExecutorWorkload::Fibonacci) {
+                    fib = parallelFib(executor, config.size, cutoff);
+                } else {
+                    parallelQuickSort(executor, data.data(), data.data() + data.size(), cutoff);
+                }
+            });
+            const quint64 ns = elapsedNs(begin);
+            result.bestNs = i == 0 ? ns : qMin(result.bestNs, ns);
+            result.correct = result.correct
+                && (config.workload == ExecutorWorkload::Fibonacci ? fib == expectedFib
+                                                                   : std::is_sorted(data.begin(), data.end()));
+        }
+    };
+
+    QVector<ExecutorBenchResult> results;
+
+    InlineExecutor inlineExecutor;
+    ExecutorBenchResult serial;
+    measure(inlineExecutor, serial);
+    serial.forks = inlineExecutor.forks / static_cast<quint64>(repeats);
+    results.append(serial);
+
+    {
+        QThreadPool pool;
+        pool.setMaxThreadCount(threads);
+        QThreadPoolExecutor executor(&pool);
+        ExecutorBenchResult result;
+        result.forks = serial.forks;
+        measure(executor, result);
+        result.detail = "所有任务经过同一条加锁队列";
+        results.append(result);
+    }
+
+    {
+        WorkStealingPool pool(threads);
+        ExecutorBenchResult result;
+        result.forks = serial.forks;
+        measure(pool, result);
+        const WorkStealingStats stats = pool.stats();
+        result.detail = QString("%1 次运行合计：本地弹出 %2，窃取 %3 次（尝试 %4 次），休眠 %5 次")
+            .arg(repeats).arg(stats.localPops).arg(stats.steals).arg(stats.stealAttempts).arg(stats.parks);
+        results.append(result);
+    }
+    return results;
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <QString>
+#include <QVector>
+#include <QtGlobal>
+
+// 细粒度递归任务：每次递归拆成两半，低于串行阈值后不再拆
+enum class ExecutorWorkload { Fibonacci, QuickSort };
+
+struct ExecutorBenchConfig {
+    ExecutorWorkload workload = ExecutorWorkload::Fibonacci;
+    int size = 30;    // fib 的 n；快速排序为元素个数（千）
+    int cutoff = 12;  // 串行阈值：fib 的 n 不超过它、或快速排序的区间不超过它个元素时直接串行
+    int threads = 0;  // 两个线程池的线程数，0 表示 QThread::idealThreadCount()
+    int repeats = 3;  // 每个执行器跑几次，取最快的一次
+};
+
+struct ExecutorBenchResult {
+    QString executor;
+    int threads = 1;
+    quint64 bestNs = 0;
+    quint64 forks = 0;   // 每次运行拆出的任务数（invoke 次数）
+    bool correct = false;
+    QString detail;      // 执行器特有的统计（如窃取次数）
+};
+
+/*
+ * 依次用 串行、QThreadPool、WorkStealingPool 跑同一个递归任务，结果按这个顺序返回
+ * 串行版本走完全相同的递归，只是 invoke 直接依次调用两边，作为加速比的基准
+ */
+QVector<ExecutorBenchResult> runExecutorBenchmark(const ExecutorBenchConfig &config);
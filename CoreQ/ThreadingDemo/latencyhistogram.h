@@ -0,0 +1,122 @@
+#pragma once
+
+#include <QtAlgorithms>
+#include <QtGlobal>
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+// LatencyHistogram 的一份快照：普通数组，可以随意合并、求分位数
+struct HistogramSnapshot
+{
+    static constexpr int kSubBucketBits = 4;
+    static constexpr int kSubBuckets = 1 << kSubBucketBits;   // 每个 2 的幂区间再均分 16 份
+    static constexpr int kBucketCount = kSubBuckets * 61;     // 覆盖整个 quint64 范围
+
+    std::array<quint64, kBucketCount> counts{};
+    quint64 count = 0;
+    quint64 sum = 0;
+    quint64 max = 0;
+
+    // 数值 -> 桶下标：小于 32 的值一一对应，之后每个 2 的幂区间 16 个桶，相对误差不超过 1/16
+    static int bucketOf(quint64 value)
+    {
+        if (value < 2 * kSubBuckets) {
+            return static_cast<int>(value);
+        }
+        const int msb = 63 - static_cast<int>(qCountLeadingZeroBits(value));
+        const int shift = msb - kSubBucketBits;
+        return kSubBuckets * shift + static_cast<int>(value >> shift);
+    }
+
+    // 桶内的最大值（分位数取桶上界，宁可略偏大）
+    static quint64 bucketUpperBound(int index)
+    {
+        if (index < 2 * kSubBuckets) {
+            return static_cast<quint64>(index);
+        }
+        const int shift = index / kSubBuckets - 1;
+        const quint64 mantissa = static_cast<quint64>(index % kSubBuckets + kSubBuckets);
+        return ((mantissa + 1) << shift) - 1;
+    }
+
+    // q ∈ [0, 1]，例如 0.99 表示 p99
+    quint64 percentile(double q) const
+    {
+        if (count == 0) {
+            return 0;
+        }
+        const quint64 rank = qMax<quint64>(1, static_cast<quint64>(q * count + 0.5));
+        quint64 seen = 0;
+        for (int i = 0; i < kBucketCount; ++i) {
+            seen += counts[static_cast<std::size_t>(i)];
+            if (seen >= rank) {
+                return qMin(bucketUpperBound(i), max);
+            }
+        }
+        return max;
+    }
+
+    double mean() const { return count > 0 ? double(sum) / count : 0.0; }
+
+    void merge(const HistogramSnapshot &other)
+    {
+        for (std::size_t i = 0; i < counts.size(); ++i) {
+            counts[i] += other.counts[i];
+        }
+        count += other.count;
+        sum += other.sum;
+        max = qMax(max, other.max);
+    }
+};
+
+/*
+ * LatencyHistogram：无锁的对数-线性直方图（HdrHistogram 思路的简化版）
+ *
+ * - record() 只做一次桶下标计算和几次 relaxed fetch_add，可以在热路径上由任意多个线程并发调用；
+ * - 桶按 2 的幂分段、段内再线性均分 16 份，固定 976 个桶，覆盖 0 ~ 2^64，相对误差 ≤ 6.25%；
+ * - snapshot() 逐桶读取，并发写入时只是一个近似一致的快照，用于显示/导出足够。
+ * 单位由调用方约定（本项目统一记录纳秒）。
+ */
+class LatencyHistogram
+{
+public:
+    void record(quint64 value)
+    {
+        m_counts[static_cast<std::size_t>(HistogramSnapshot::bucketOf(value))].fetch_add(1, std::memory_order_relaxed);
+        m_count.fetch_add(1, std::memory_order_relaxed);
+        m_sum.fetch_add(value, std::memory_order_relaxed);
+        quint64 seen = m_max.load(std::memory_order_relaxed);
+        while (value > seen && !m_max.compare_exchange_weak(seen, value, std::memory_order_relaxed)) {
+        }
+    }
+
+    HistogramSnapshot snapshot() const
+    {
+        HistogramSnapshot s;
+        for (std::size_t i = 0; i < s.counts.size(); ++i) {
+            s.counts[i] = m_counts[i].load(std::memory_order_relaxed);
+        }
+        s.count = m_count.load(std::memory_order_relaxed);
+        s.sum = m_sum.load(std::memory_order_relaxed);
+        s.max = m_max.load(std::memory_order_relaxed);
+        return s;
+    }
+
+    // 清零（与 record 并发时可能漏掉少量样本，只在统计窗口切换时使用）
+    void reset()
+    {
+        for (auto &c : m_counts) {
+            c.store(0, std::memory_order_relaxed);
+        }
+        m_count.store(0, std::memory_order_relaxed);
+        m_sum.store(0, std::memory_order_relaxed);
+        m_max.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    std::array<std::atomic<quint64>, HistogramSnapshot::kBucketCount> m_counts{};
+    std::atomic<quint64> m_count{0};
+    std::atomic<quint64> m_sum{0};
+    std::atomic<quint64> m_max{0};
+};
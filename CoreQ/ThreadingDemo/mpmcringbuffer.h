@@ -0,0 +1,128 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+
+/*
+ * MpmcRingBuffer：有界多生产者/多消费者无锁环形队列（Vyukov 序号槽算法）
+ *
+ * 原理：
+ * - 每个槽位带一个序号 seq，seq == pos 表示可写，seq == pos + 1 表示可读；
+ * - 生产者/消费者各自用 CAS 抢占全局位置 m_enqueuePos / m_dequeuePos，
+ *   抢到后只操作自己的槽位，不同槽位之间没有任何共享写；
+ * - 读完后把 seq 推进一整圈（pos + capacity），供下一轮生产者使用。
+ *
+ * 特点：
+ * - tryPush / tryPop 永不阻塞，满/空时直接返回 false，阻塞策略由调用方决定；
+ * - 头尾索引、每个槽位都按缓存行对齐，避免伪共享；
+ * - 容量不要求是 2 的幂（用取模定位槽位），便于和 UI 上的“缓冲区大小”保持一致；
+ * - 容量至少为 2：只有 1 个槽位时，读完推进后的序号 pos + 1 同时也是“下一轮可写”，
+ *   第二次 tryPush 会覆盖还没读走的元素，tryPop 随后永远等不到自己的序号。请求 1 时按 2 分配。
+ */
+template <typename T>
+class MpmcRingBuffer
+{
+public:
+    static constexpr std::size_t kCacheLine = 64;
+
+    explicit MpmcRingBuffer(std::size_t capacity)
+        : m_capacity(capacity > 2 ? capacity : 2)
+        , m_slots(new Slot[m_capacity])
+    {
+        for (std::size_t i = 0; i < m_capacity; ++i) {
+            m_slots[i].seq.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    ~MpmcRingBuffer()
+    {
+        // 析构时不会再有并发访问，把剩余元素析构掉即可
+        T item;
+        while (tryPop(item)) {
+        }
+    }
+
+    MpmcRingBuffer(const MpmcRingBuffer &) = delete;
+    MpmcRingBuffer &operator=(const MpmcRingBuffer &) = delete;
+
+    bool tryPush(const T &item) { return tryEmplace(item); }
+    bool tryPush(T &&item) { return tryEmplace(std::move(item)); }
+
+    // 原地构造：抢到槽位后直接在槽内构造元素
+    template <typename... Args>
+    bool tryEmplace(Args &&...args)
+    {
+        Slot *slot = nullptr;
+        std::size_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+        for (;;) {
+            slot = &m_slots[pos % m_capacity];
+            const std::size_t seq = slot->seq.load(std::memory_order_acquire);
+            const std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+            if (diff == 0) {
+                if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false; // 已满：该槽位上一轮的数据还没被消费
+            } else {
+                pos = m_enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+        new (slot->storage) T(std::forward<Args>(args)...);
+        slot->seq.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool tryPop(T &out)
+    {
+        Slot *slot = nullptr;
+        std::size_t pos = m_dequeuePos.load(std::memory_order_relaxed);
+        for (;;) {
+            slot = &m_slots[pos % m_capacity];
+            const std::size_t seq = slot->seq.load(std::memory_order_acquire);
+            const std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos + 1);
+            if (diff == 0) {
+                if (m_dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false; // 已空：该槽位还没被写入
+            } else {
+                pos = m_dequeuePos.load(std::memory_order_relaxed);
+            }
+        }
+        T *item = slot->ptr();
+        out = std::move(*item);
+        item->~T();
+        slot->seq.store(pos + m_capacity, std::memory_order_release);
+        return true;
+    }
+
+    std::size_t capacity() const { return m_capacity; }
+
+    // 近似元素个数：并发下只是快照，仅用于显示/统计
+    std::size_t sizeApprox() const
+    {
+        const std::size_t tail = m_enqueuePos.load(std::memory_order_acquire);
+        const std::size_t head = m_dequeuePos.load(std::memory_order_acquire);
+        return tail > head ? tail - head : 0;
+    }
+
+private:
+    struct alignas(kCacheLine) Slot
+    {
+        std::atomic<std::size_t> seq{0};
+        alignas(T) unsigned char storage[sizeof(T)];
+
+        T *ptr() { return std::launder(reinterpret_cast<T *>(storage)); }
+    };
+
+    const std::size_t m_capacity;
+    std::unique_ptr<Slot[]> m_slots;
+
+    alignas(kCacheLine) std::atomic<std::size_t> m_enqueuePos{0};
+    alignas(kCacheLine) std::atomic<std::size_t> m_dequeuePos{0};
+};
@@ -0,0 +1,197 @@
+#pragma once
+
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+#include <QWaitCondition>
+#include <QtGlobal>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "taskexecutor.h"
+
+// 分块参数：每次从剩余区间里取一块交给工作线程，块越大调度开销越小、尾部越不均衡
+struct ParallelMapOptions {
+    int threads = 0;                 // 并发的取块循环数，0 表示执行器的线程数（没有执行器时为 idealThreadCount()）
+    TaskExecutor *executor = nullptr; // 为空时每个取块循环一个 std::thread，否则作为任务提交给执行器
+    bool adaptive = true;            // false 时每块固定 fixedChunk 项
+    std::size_t fixedChunk = 4096;
+    std::size_t minChunk = 64;       // 自适应块大小的上下限
+    std::size_t maxChunk = 1 << 20;
+    quint64 targetChunkNs = 200000;  // 自适应时每块的目标耗时，也是取消的最坏响应时间
+};
+
+/*
+ * ParallelMapJob：对 [0, count) 做分块并行的 map
+ *
+ * - 映射函数按区间调用 fn(begin, end)，一块只经过一次 std::function 调用，单项的调度开销被整块摊薄；
+ * - 取块是一次 fetch_add：块大小可以逐次不同，区间仍然不重不漏；
+ * - 自适应块大小：每个线程用上一块实测的单项耗时把下一块调到约 targetChunkNs，
+ *   同时不超过 剩余项数 / (2 × 线程数)（guided 调度），接近末尾时块自动变小，各线程差不多同时结束；
+ * - 取消是协作式的：每块开始前检查一次，已经开始的块会做完；
+ * - 进度按块累加到一个 relaxed 原子计数上，UI 定时读取，不为每一项发信号；
+ * - 指定 executor 时不自己起线程，threads 个取块循环作为任务交给执行器（执行器须比作业活得久）。
+ * 析构时取消并等待所有工作线程。
+ */
+class ParallelMapJob
+{
+public:
+    using RangeFn = std::function<void(std::size_t begin, std::size_t end)>;
+
+    ParallelMapJob(std::size_t count, RangeFn fn, const ParallelMapOptions &options = ParallelMapOptions())
+        : m_count(count), m_fn(std::move(fn)), m_options(options)
+    {
+        if (m_options.threads <= 0) {
+            m_options.threads = m_options.executor ? m_options.executor->threadCount() : QThread::idealThreadCount();
+            m_options.threads = qMax(1, m_options.threads);
+        }
+        m_options.fixedChunk = qMax<std::size_t>(1, m_options.fixedChunk);
+        m_options.minChunk = qMax<std::size_t>(1, m_options.minChunk);
+        m_options.maxChunk = qMax(m_options.minChunk, m_options.maxChunk);
+    }
+
+    ~ParallelMapJob()
+    {
+        cancel();
+        wait();
+    }
+
+    ParallelMapJob(const ParallelMapJob &) = delete;
+    ParallelMapJob &operator=(const ParallelMapJob &) = delete;
+
+    void start()
+    {
+        m_startTime = Clock::now();
+        m_started = true;
+        {
+            QMutexLocker locker(&m_doneMutex);
+            m_active = m_options.threads;
+        }
+        for (int i = 0; i < m_options.threads; ++i) {
+            if (m_options.executor) {
+                m_options.executor->execute([this] { runWorker(); });
+            } else {
+                m_threads.emplace_back([this] { runWorker(); });
+            }
+        }
+    }
+
+    void cancel() { m_cancelled.store(true, std::memory_order_relaxed); }
+
+    void wait()
+    {
+        {
+            QMutexLocker locker(&m_doneMutex);
+            while (m_started && !m_done) {
+                m_doneCondition.wait(&m_doneMutex);
+            }
+        }
+        for (auto &thread : m_threads) {
+            if (thread.joinable()) {
+                thread.join();
+            }
+        }
+        m_threads.clear();
+    }
+
+    bool isFinished() const
+    {
+        QMutexLocker locker(&m_doneMutex);
+        return m_started && m_done;
+    }
+    bool isCancelled() const { return m_cancelled.load(std::memory_order_relaxed); }
+
+    std::size_t count() const { return m_count; }
+    int threads() const { return m_options.threads; }
+    quint64 processed() const { return m_processed.load(std::memory_order_relaxed); }
+    quint64 chunks() const { return m_chunks.load(std::memory_order_relaxed); }
+    std::size_t largestChunk() const { return m_largestChunk.load(std::memory_order_relaxed); }
+
+    // 从 start() 到最后一个工作线程退出（未结束时到现在）
+    quint64 elapsedNs() const
+    {
+        const quint64 finished = m_finishedNs.load(std::memory_order_acquire);
+        return finished > 0 ? finished : nsSince(m_startTime);
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    static quint64 nsSince(Clock::time_point from)
+    {
+        return static_cast<quint64>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - from).count());
+    }
+
+    std::size_t nextChunkSize(double nsPerItem) const
+    {
+        if (!m_options.adaptive) {
+            return m_options.fixedChunk;
+        }
+        std::size_t size = m_options.minChunk;
+        if (nsPerItem > 0.0) {
+            size = static_cast<std::size_t>(qMin(double(m_options.maxChunk), m_options.targetChunkNs / nsPerItem));
+        }
+        const std::size_t claimed = qMin(m_count, m_next.load(std::memory_order_relaxed));
+        const std::size_t guided = (m_count - claimed) / (2 * static_cast<std::size_t>(m_options.threads));
+        return qBound(m_options.minChunk, qMin(size, guided), m_options.maxChunk);
+    }
+
+    void runWorker()
+    {
+        double nsPerItem = 0.0; // 第一块还没有测量值，从 minChunk 开始
+        while (!m_cancelled.load(std::memory_order_relaxed)) {
+            const std::size_t size = nextChunkSize(nsPerItem);
+            const std::size_t begin = m_next.fetch_add(size, std::memory_order_relaxed);
+            if (begin >= m_count) {
+                break;
+            }
+            const std::size_t end = qMin(m_count, begin + size);
+            const auto chunkStart = Clock::now();
+            m_fn(begin, end);
+            const quint64 ns = nsSince(chunkStart);
+            // 指数平均，避免单块的抖动（被抢占、缺页）把下一块调得过小或过大
+            const double sample = double(ns) / double(end - begin);
+            nsPerItem = nsPerItem > 0.0 ? 0.5 * nsPerItem + 0.5 * sample : sample;
+
+            m_processed.fetch_add(end - begin, std::memory_order_relaxed);
+            m_chunks.fetch_add(1, std::memory_order_relaxed);
+            std::size_t largest = m_largestChunk.load(std::memory_order_relaxed);
+            while (end - begin > largest
+                   && !m_largestChunk.compare_exchange_weak(largest, end - begin, std::memory_order_relaxed)) {
+            }
+        }
+        // 计数、结束时间和完成标志都在锁内更新，并在锁内通知：wait()/isFinished() 只认 m_done，
+        // 看到它时结束时间已经写好；解锁之后本线程不再访问 this，等待方随即销毁作业也是安全的
+        QMutexLocker locker(&m_doneMutex);
+        if (--m_active == 0) {
+            m_finishedNs.store(qMax<quint64>(1, nsSince(m_startTime)), std::memory_order_release);
+            m_done = true;
+            m_doneCondition.wakeAll();
+        }
+    }
+
+    const std::size_t m_count;
+    const RangeFn m_fn;
+    ParallelMapOptions m_options;
+
+    alignas(64) std::atomic<std::size_t> m_next{0};
+    alignas(64) std::atomic<quint64> m_processed{0};
+    std::atomic<quint64> m_chunks{0};
+    std::atomic<std::size_t> m_largestChunk{0};
+    std::atomic<bool> m_cancelled{false};
+    std::atomic<quint64> m_finishedNs{0};
+
+    Clock::time_point m_startTime;
+    bool m_started = false;
+    std::vector<std::thread> m_threads;
+    mutable QMutex m_doneMutex;
+    QWaitCondition m_doneCondition;
+    int m_active = 0;     // 还没退出的取块循环数（m_doneMutex 保护）
+    bool m_done = false;  // 最后一个取块循环已退出（m_doneMutex 保护）
+};
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <QString>
+#include <QVector>
+#include <QtGlobal>
+#include "pipelineengine.h"
+
+// 单个阶段的伸缩范围；minWorkers == maxWorkers 表示不参与伸缩
+struct PipelineScaleBounds {
+    int minWorkers = 1;
+    int maxWorkers = 1;
+};
+
+// 一次伸缩决定，供界面记录日志
+struct PipelineScaleDecision {
+    int stage = 0;
+    QString name;
+    int from = 0;
+    int to = 0;
+    double utilization = 0.0;
+    double queueFill = 0.0;
+};
+
+/*
+ * PipelineAutoscaler：根据队列深度和忙碌比例调整每个阶段的工作线程数
+ *
+ * 由调用方定时调用 sample()（例如界面的统计定时器），每次与上一次快照做差：
+ * - 忙碌比例 = Δ忙碌时长 / (间隔 × 存活线程数)，队列占用 = 输入边长度 / 容量；
+ * - 扩容：忙碌比例 ≥ growUtilization 且输入边积压 ≥ growQueueFill，连续 growSamples 次；
+ * - 缩容：按少一个线程估算的忙碌比例仍 < shrinkUtilization 且输入边基本为空，连续 shrinkSamples 次；
+ * - 防振荡（hysteresis）：扩缩阈值之间留有空档，缩容要求的连续次数更多，
+ *   每次调整后该阶段冷却 cooldownSamples 次不再调整，每次只增减一个线程。
+ * 数据源的忙碌时长包含限速等待，不适合用这套规则，默认范围为 [1, 1] 即不伸缩。
+ */
+class PipelineAutoscaler
+{
+public:
+    double growUtilization = 0.85;
+    double growQueueFill = 0.5;
+    double shrinkUtilization = 0.6;
+    double shrinkQueueFill = 0.1;
+    int growSamples = 2;
+    int shrinkSamples = 4;
+    int cooldownSamples = 3;
+
+    explicit PipelineAutoscaler(const QVector<PipelineScaleBounds> &bounds) : m_bounds(bounds) {}
+
+    // 采样一次并按需调整 engine；返回本次做出的调整
+    QVector<PipelineScaleDecision> sample(PipelineEngine &engine)
+    {
+        QVector<PipelineScaleDecision> decisions;
+        const QVector<PipelineStageStats> now = engine.stats();
+        const quint64 nowNs = engine.elapsedNs();
+        if (m_last.size() != now.size()) {
+            // 第一次采样只记录基线
+            m_last = now;
+            m_lastNs = nowNs;
+            m_state = QVector<StageState>(now.size());
+            return decisions;
+        }
+        const double intervalNs = qMax(1.0, double(nowNs - m_lastNs));
+
+        for (int i = 0; i < now.size(); ++i) {
+            const PipelineStageStats &s = now[i];
+            const PipelineScaleBounds bounds = m_bounds.value(i);
+            StageState &state = m_state[i];
+            if (s.finished || engine.isStopping() || bounds.maxWorkers <= bounds.minWorkers) {
+                continue;
+            }
+
+            const int workers = qMax(1, s.workers);
+            const double utilization = (s.busyNs - m_last[i].busyNs) / (intervalNs * workers);
+            const double fill = s.inputCapacity > 0 ? double(s.inputDepth) / s.inputCapacity : 0.0;
+            const int target = s.targetWorkers;
+
+            const bool wantGrow = utilization >= growUtilization && fill >= growQueueFill && target < bounds.maxWorkers;
+            const double utilizationIfShrunk = workers > 1 ? utilization * workers / (workers - 1) : 1.0;
+            const bool wantShrink = utilizationIfShrunk < shrinkUtilization && fill <= shrinkQueueFill
+                && target > bounds.minWorkers;
+            state.growStreak = wantGrow ? state.growStreak + 1 : 0;
+            state.shrinkStreak = wantShrink ? state.shrinkStreak + 1 : 0;
+
+            if (state.cooldown > 0) {
+                --state.cooldown;
+                continue;
+            }
+
+            int next = target;
+            if (state.growStreak >= growSamples) {
+                next = target + 1;
+            } else if (state.shrinkStreak >= shrinkSamples) {
+                next = target - 1;
+            }
+            if (next == target) {
+                continue;
+            }
+            engine.setWorkers(i, next);
+            state.growStreak = 0;
+            state.shrinkStreak = 0;
+            state.cooldown = cooldownSamples;
+
+            PipelineScaleDecision decision;
+            decision.stage = i;
+            decision.name = s.name;
+            decision.from = target;
+            decision.to = next;
+            decision.utilization = utilization;
+            decision.queueFill = fill;
+            decisions.push_back(decision);
+        }
+
+        m_last = now;
+        m_lastNs = nowNs;
+        return decisions;
+    }
+
+private:
+    struct StageState {
+        int growStreak = 0;
+        int shrinkStreak = 0;
+        int cooldown = 0;
+    };
+
+    QVector<PipelineScaleBounds> m_bounds;
+    QVector<PipelineStageStats> m_last;
+    quint64 m_lastNs = 0;
+    QVector<StageState> m_state;
+};
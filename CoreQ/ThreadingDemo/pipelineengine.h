@@ -0,0 +1,953 @@
+#pragma once
+
+#include <QDeadlineTimer>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QWaitCondition>
+#include <QtGlobal>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "boundedqueue.h"
+#include "latencyhistogram.h"
+#include "pipelinetrace.h"
+
+// 单个阶段的累计统计（UI 定时取两次快照做差得到速率和忙闲比）
+struct PipelineStageStats {
+    QString name;
+    int workers = 0;             // 当前存活的工作线程数
+    int targetWorkers = 0;       // setWorkers() 设定的目标线程数（缩减时存活数会滞后一项）
+    quint64 processed = 0;       // 已处理（已交给下游）的项数
+    quint64 batches = 0;         // 调用阶段函数的次数（逐项阶段等于 processed）
+    quint64 busyNs = 0;          // 所有工作线程执行阶段函数的累计耗时
+    std::size_t inputDepth = 0;  // 输入队列当前长度（数据源为 0）
+    std::size_t inputCapacity = 0;
+    bool finished = false;       // 所有工作线程都已退出
+
+    // 输入边是重排序缓冲区时有效：衡量为了恢复顺序付出了多少缓冲
+    bool orderedInput = false;
+    std::size_t reorderMaxHeld = 0; // 缓冲区中同时暂存的最多项数
+    quint64 reorderOutOfOrder = 0;  // 到达时不是下一个期望序号、只能先暂存的项数
+    quint64 reorderWindowWaits = 0; // 序号超出窗口、上游工作线程被迫等待的次数
+};
+
+// 单个阶段的排队/服务时间分布（纳秒），只统计带 trace 成员的数据类型
+struct PipelineStageLatency {
+    QString name;
+    HistogramSnapshot queue;     // 上游完成（入队）-> 本阶段取出
+    HistogramSnapshot service;   // 本阶段取出 -> 本阶段完成；攒批时整批的耗时计到批里每一项上
+    HistogramSnapshot sinceBorn; // 进入流水线 -> 本阶段完成，终点阶段即端到端延迟
+};
+
+// 攒批参数：下游一次最多取 maxItems 项，凑不满时从拿到第一项起最多再等 lingerUs 微秒
+struct PipelineBatch {
+    std::size_t maxItems = 1;
+    int lingerUs = 0;
+};
+
+// 阶段之间的一条边：上游 push，下游 pop，上游全部退出后 close
+template <typename T>
+class PipelineEdge
+{
+public:
+    virtual ~PipelineEdge() = default;
+    virtual bool push(T &&item) = 0;
+    virtual bool pop(T &out) = 0;
+
+    // 批量入队，元素被 move 走；返回实际放入的数量（边关闭时少于 items.size()）
+    virtual std::size_t pushBatch(std::vector<T> &items)
+    {
+        std::size_t pushed = 0;
+        while (pushed < items.size() && push(std::move(items[pushed]))) {
+            ++pushed;
+        }
+        return pushed;
+    }
+
+    // 攒批出队（见 PipelineBatch），追加到 out；边关闭且取空后返回 0
+    virtual std::size_t popBatch(std::vector<T> &out, const PipelineBatch &batch) = 0;
+
+    virtual void close() = 0;
+    virtual std::size_t size() const = 0;
+    virtual std::size_t capacity() const = 0;
+    virtual void fillStats(PipelineStageStats &stats) const { Q_UNUSED(stats); }
+};
+
+// 普通边：先进先出的有界队列
+template <typename T>
+class QueueEdge : public PipelineEdge<T>
+{
+public:
+    explicit QueueEdge(std::size_t capacity) : m_queue(capacity) {}
+    bool push(T &&item) override { return m_queue.push(std::move(item)); }
+    bool pop(T &out) override { return m_queue.pop(out); }
+    std::size_t pushBatch(std::vector<T> &items) override { return m_queue.pushBatch(items.data(), items.size()); }
+    std::size_t popBatch(std::vector<T> &out, const PipelineBatch &batch) override
+    {
+        return m_queue.popBatchFor(out, batch.maxItems, batch.lingerUs);
+    }
+    void close() override { m_queue.close(); }
+    std::size_t size() const override { return m_queue.size(); }
+    std::size_t capacity() const override { return m_queue.capacity(); }
+
+private:
+    BoundedQueue<T> m_queue;
+};
+
+/*
+ * ResequencingEdge：保序边（有界重排序缓冲区）
+ *
+ * 上游多个工作线程并行处理后完成顺序会被打乱；每项带一个从 0 开始连续的序号 seqOf(item)，
+ * 本边按序号放进 window 个槽位的环形缓冲区（槽位 = 序号 % window），下游只能按序号依次取走。
+ * - 序号超出 [下一个期望序号, +window) 的项让上游等待，缓冲区大小因此有界；
+ * - 不会死锁的前提：上游阶段的输入本身按序号排列（例如单线程数据源）。这样期望序号那一项
+ *   要么已经在某个工作线程手里，要么排在输入队列最前面；它一定在窗口内，push 从不等待；
+ * - close() 后下游取完连续的部分即结束。
+ */
+template <typename T, typename SeqOf>
+class ResequencingEdge : public PipelineEdge<T>
+{
+public:
+    ResequencingEdge(std::size_t window, SeqOf seqOf)
+        : m_window(window > 0 ? window : 1), m_slots(m_window), m_seqOf(std::move(seqOf))
+    {
+    }
+
+    bool push(T &&item) override
+    {
+        const quint64 seq = m_seqOf(item);
+        QMutexLocker locker(&m_mutex);
+        while (!m_closed && seq >= m_next + m_window) {
+            ++m_windowWaits;
+            m_windowOpen.wait(&m_mutex);
+        }
+        if (m_closed) {
+            return false;
+        }
+        if (seq != m_next) {
+            ++m_outOfOrder;
+        }
+        m_slots[seq % m_window] = std::move(item);
+        ++m_held;
+        m_maxHeld = qMax(m_maxHeld, m_held);
+        if (seq == m_next) {
+            m_headReady.wakeOne();
+        }
+        return true;
+    }
+
+    bool pop(T &out) override
+    {
+        QMutexLocker locker(&m_mutex);
+        std::optional<T> *head = &m_slots[m_next % m_window];
+        while (!head->has_value() && !m_closed) {
+            m_headReady.wait(&m_mutex);
+            head = &m_slots[m_next % m_window];
+        }
+        if (!head->has_value()) {
+            return false;
+        }
+        out = std::move(**head);
+        head->reset();
+        ++m_next;
+        --m_held;
+        advanced();
+        return true;
+    }
+
+    // 攒批时只取从期望序号开始连续到达的部分，凑不满就在 lingerUs 内等后续序号补上
+    std::size_t popBatch(std::vector<T> &out, const PipelineBatch &batch) override
+    {
+        QMutexLocker locker(&m_mutex);
+        while (!m_slots[m_next % m_window].has_value() && !m_closed) {
+            m_headReady.wait(&m_mutex);
+        }
+        const std::size_t maxItems = qMax<std::size_t>(1, batch.maxItems);
+        std::size_t taken = takeReady(out, maxItems);
+        if (taken > 0 && taken < maxItems && batch.lingerUs > 0) {
+            const QDeadlineTimer deadline(std::chrono::microseconds(batch.lingerUs), Qt::PreciseTimer);
+            while (taken < maxItems && !m_closed && m_headReady.wait(&m_mutex, deadline)) {
+                taken += takeReady(out, maxItems - taken);
+            }
+            taken += takeReady(out, maxItems - taken);
+        }
+        return taken;
+    }
+
+    void close() override
+    {
+        QMutexLocker locker(&m_mutex);
+        m_closed = true;
+        m_windowOpen.wakeAll();
+        m_headReady.wakeAll();
+    }
+
+    std::size_t size() const override
+    {
+        QMutexLocker locker(&m_mutex);
+        return m_held;
+    }
+
+    std::size_t capacity() const override { return m_window; }
+
+    void fillStats(PipelineStageStats &stats) const override
+    {
+        QMutexLocker locker(&m_mutex);
+        stats.orderedInput = true;
+        stats.reorderMaxHeld = m_maxHeld;
+        stats.reorderOutOfOrder = m_outOfOrder;
+        stats.reorderWindowWaits = m_windowWaits;
+    }
+
+private:
+    // 取走从 m_next 开始连续就绪的项，最多 maxItems 个（调用方持有 m_mutex）
+    std::size_t takeReady(std::vector<T> &out, std::size_t maxItems)
+    {
+        std::size_t taken = 0;
+        while (taken < maxItems && m_slots[m_next % m_window].has_value()) {
+            std::optional<T> &head = m_slots[m_next % m_window];
+            out.push_back(std::move(*head));
+            head.reset();
+            ++m_next;
+            --m_held;
+            ++taken;
+        }
+        if (taken > 0) {
+            advanced();
+        }
+        return taken;
+    }
+
+    // m_next 前移之后：等待中的上游里可能有人的序号已经落入窗口；新的队头已就绪就再叫醒一个下游
+    void advanced()
+    {
+        m_windowOpen.wakeAll();
+        if (m_slots[m_next % m_window].has_value()) {
+            m_headReady.wakeOne();
+        }
+    }
+
+    const std::size_t m_window;
+    std::vector<std::optional<T>> m_slots;
+    SeqOf m_seqOf;
+    quint64 m_next = 0;
+    std::size_t m_held = 0;
+    std::size_t m_maxHeld = 0;
+    quint64 m_outOfOrder = 0;
+    quint64 m_windowWaits = 0;
+    bool m_closed = false;
+
+    mutable QMutex m_mutex;
+    QWaitCondition m_windowOpen;
+    QWaitCondition m_headReady;
+};
+
+// 某个阶段的输出端，作为下一个阶段的输入；T 是在这条边上流动的数据类型
+template <typename T>
+class PipelinePort
+{
+public:
+    PipelinePort() = default;
+    bool isValid() const { return m_edge != nullptr; }
+
+private:
+    friend class PipelineEngine;
+    explicit PipelinePort(std::shared_ptr<PipelineEdge<T>> edge) : m_edge(std::move(edge)) {}
+    std::shared_ptr<PipelineEdge<T>> m_edge;
+};
+
+/*
+ * PipelineEngine：由有界队列串起来的多阶段流水线
+ *
+ * - 阶段是带类型的可调用对象：数据源 bool(Out&)（返回 false 表示耗尽），中间阶段 Out(In&&)，
+ *   终点 void(In&&)；相邻阶段之间默认是一条 BoundedQueue（QueueEdge），满了自然形成背压；
+ * - 每个阶段有自己的若干工作线程，同一阶段的最后一个工作线程退出时关闭输出队列，
+ *   关闭沿着流水线逐级传递；
+ * - 多线程阶段的输出顺序会被打乱，addOrderedStage 在输出边上放一个有界的重排序缓冲区，
+ *   下游按序号原样收到数据；
+ * - 攒批阶段（addBatchStage/addBatchSink）按 PipelineBatch 一次从输入边取一批，阶段函数按批调用，
+ *   固定开销和队列加锁按批摊薄；批大小与凑批等待时间是吞吐和延迟之间的取舍；
+ * - 追踪：数据类型带 PipelineTraceStamp trace 成员时，引擎在每个阶段记录入队、出队、完成的时刻，
+ *   累计到每阶段的排队/服务时间直方图（latencies()），设置了 PipelineTraceBuffer 时还逐项记录区间，
+ *   可导出为 Chrome trace-event JSON；不带该成员的类型在编译期去掉全部追踪代码；
+ * - setWorkers() 可以在运行中增减某个阶段的工作线程：增加时立即启动新线程，减少时多出来的线程
+ *   处理完手头这一项后自行退出（不会因此关闭输出边，至少保留一个）；
+ * - stop()：数据源停止产出，已在队列里的数据继续流完（优雅停止）；
+ *   cancel()：立即关闭所有队列，工作线程处理完手头这一项就退出，队列里剩下的数据丢弃；
+ * - 统计全部是 relaxed 原子计数，stats() 可以在任意线程随时调用。
+ * 构建（addSource/addStage/addSink）必须在 start() 之前完成。
+ */
+class PipelineEngine
+{
+public:
+    explicit PipelineEngine(std::size_t edgeCapacity = 64) : m_edgeCapacity(edgeCapacity) {}
+
+    ~PipelineEngine()
+    {
+        cancel();
+        wait();
+    }
+
+    PipelineEngine(const PipelineEngine &) = delete;
+    PipelineEngine &operator=(const PipelineEngine &) = delete;
+
+    // 数据源：produce(Out&) 填好一项返回 true，返回 false 表示没有更多数据
+    template <typename Out, typename Produce>
+    PipelinePort<Out> addSource(const QString &name, Produce produce, int workers = 1, std::size_t capacity = 0)
+    {
+        std::shared_ptr<PipelineEdge<Out>> output = makeQueue<Out>(capacity);
+        m_stages.push_back(std::make_unique<SourceStage<Out, Produce>>(this, name, workers, std::move(produce), output));
+        return PipelinePort<Out>(output);
+    }
+
+    // 中间阶段：Out fn(In&&)，输出类型由 fn 的返回值推导
+    template <typename In, typename Fn>
+    auto addStage(const QString &name, const PipelinePort<In> &input, Fn fn, int workers = 1, std::size_t capacity = 0)
+        -> PipelinePort<std::decay_t<std::invoke_result_t<Fn &, In &&>>>
+    {
+        using Out = std::decay_t<std::invoke_result_t<Fn &, In &&>>;
+        return addTransform<In, Out>(name, input, std::move(fn), workers, makeQueue<Out>(capacity));
+    }
+
+    // 保序的中间阶段：可以多线程并行处理，但下游按 seqOf(输出项) 的顺序收到数据；
+    // 序号必须从 0 开始连续且按序进入本阶段，window 是重排序缓冲区的槽位数
+    template <typename In, typename Fn, typename SeqOf>
+    auto addOrderedStage(const QString &name, const PipelinePort<In> &input, Fn fn, SeqOf seqOf, int workers,
+                         std::size_t window) -> PipelinePort<std::decay_t<std::invoke_result_t<Fn &, In &&>>>
+    {
+        using Out = std::decay_t<std::invoke_result_t<Fn &, In &&>>;
+        std::shared_ptr<PipelineEdge<Out>> output = std::make_shared<ResequencingEdge<Out, SeqOf>>(window, std::move(seqOf));
+        return addTransform<In, Out>(name, input, std::move(fn), workers, output);
+    }
+
+    // 攒批的中间阶段：void fn(std::vector<In>& batch, std::vector<Out>& results)，
+    // 两个 vector 由工作线程复用（调用前 results 已清空），输出类型需显式给出
+    template <typename Out, typename In, typename Fn>
+    PipelinePort<Out> addBatchStage(const QString &name, const PipelinePort<In> &input, Fn fn, const PipelineBatch &batch,
+                                    int workers = 1, std::size_t capacity = 0)
+    {
+        return addBatchTransform<In, Out>(name, input, std::move(fn), batch, workers, makeQueue<Out>(capacity));
+    }
+
+    // 攒批且保序的中间阶段（序号要求同 addOrderedStage）
+    template <typename Out, typename In, typename Fn, typename SeqOf>
+    PipelinePort<Out> addOrderedBatchStage(const QString &name, const PipelinePort<In> &input, Fn fn, SeqOf seqOf,
+                                           const PipelineBatch &batch, int workers, std::size_t window)
+    {
+        std::shared_ptr<PipelineEdge<Out>> output = std::make_shared<ResequencingEdge<Out, SeqOf>>(window, std::move(seqOf));
+        return addBatchTransform<In, Out>(name, input, std::move(fn), batch, workers, output);
+    }
+
+    // 终点：void fn(In&&)
+    template <typename In, typename Fn>
+    void addSink(const QString &name, const PipelinePort<In> &input, Fn fn, int workers = 1)
+    {
+        m_stages.push_back(std::make_unique<SinkStage<In, Fn>>(this, name, workers, std::move(fn), input.m_edge));
+    }
+
+    // 攒批的终点：void fn(std::vector<In>& batch)
+    template <typename In, typename Fn>
+    void addBatchSink(const QString &name, const PipelinePort<In> &input, Fn fn, const PipelineBatch &batch, int workers = 1)
+    {
+        m_stages.push_back(std::make_unique<BatchSinkStage<In, Fn>>(this, name, workers, std::move(fn), batch, input.m_edge));
+    }
+
+    void start()
+    {
+        std::lock_guard<std::mutex> locker(m_threadsMutex);
+        m_startTime = std::chrono::steady_clock::now();
+        // 先把所有阶段的存活计数设好，避免先启动的线程退出时误判自己是最后一个
+        for (auto &stage : m_stages) {
+            stage->liveWorkers.store(stage->initialWorkers, std::memory_order_relaxed);
+            stage->targetWorkers.store(stage->initialWorkers, std::memory_order_relaxed);
+        }
+        for (auto &stage : m_stages) {
+            for (int i = 0; i < stage->initialWorkers; ++i) {
+                spawnWorker(stage.get());
+            }
+        }
+    }
+
+    int stageCount() const { return static_cast<int>(m_stages.size()); }
+
+    QStringList stageNames() const
+    {
+        QStringList names;
+        for (const auto &stage : m_stages) {
+            names << stage->name;
+        }
+        return names;
+    }
+
+    // 逐项追踪区间写到 buffer 里（必须在 start() 之前设置；为空则只统计直方图）
+    void setTraceBuffer(std::shared_ptr<PipelineTraceBuffer> buffer) { m_trace = std::move(buffer); }
+    std::shared_ptr<PipelineTraceBuffer> traceBuffer() const { return m_trace; }
+
+    // 每个阶段的排队/服务时间分布；reset 为 true 时读完清零，便于按统计周期显示
+    QVector<PipelineStageLatency> latencies(bool reset = false)
+    {
+        QVector<PipelineStageLatency> result;
+        for (auto &stage : m_stages) {
+            PipelineStageLatency latency;
+            latency.name = stage->name;
+            latency.queue = stage->queueHistogram.snapshot();
+            latency.service = stage->serviceHistogram.snapshot();
+            latency.sinceBorn = stage->sinceBornHistogram.snapshot();
+            if (reset) {
+                stage->queueHistogram.reset();
+                stage->serviceHistogram.reset();
+                stage->sinceBornHistogram.reset();
+            }
+            result.push_back(latency);
+        }
+        return result;
+    }
+
+    // 运行中调整第 stage 个阶段（按添加顺序）的工作线程数，返回实际设定的目标值；
+    // 阶段已经结束或正在停止时不再增加线程
+    int setWorkers(int stage, int workers)
+    {
+        if (stage < 0 || stage >= stageCount()) {
+            return 0;
+        }
+        StageBase *target = m_stages[static_cast<std::size_t>(stage)].get();
+        workers = qMax(1, workers);
+        std::lock_guard<std::mutex> locker(m_threadsMutex);
+        target->targetWorkers.store(workers, std::memory_order_relaxed);
+        int live = target->liveWorkers.load(std::memory_order_relaxed);
+        // 只有阶段还活着（live > 0）才能加线程，否则会在已关闭的边上重新开工
+        while (live > 0 && live < workers && !isStopping()) {
+            if (target->liveWorkers.compare_exchange_weak(live, live + 1, std::memory_order_relaxed)) {
+                spawnWorker(target);
+                ++live;
+            }
+        }
+        return workers;
+    }
+
+    // 优雅停止：数据源不再产出，下游处理完已有数据后依次退出
+    void stop() { m_stopping.store(true, std::memory_order_relaxed); }
+
+    // 取消：立即关闭所有队列，丢弃尚未处理的数据
+    void cancel()
+    {
+        m_stopping.store(true, std::memory_order_relaxed);
+        m_cancelled.store(true, std::memory_order_relaxed);
+        for (auto &stage : m_stages) {
+            stage->closeQueues();
+        }
+    }
+
+    bool isStopping() const { return m_stopping.load(std::memory_order_relaxed); }
+    bool isCancelled() const { return m_cancelled.load(std::memory_order_relaxed); }
+
+    // 所有阶段的工作线程都已退出
+    bool isFinished() const
+    {
+        for (const auto &stage : m_stages) {
+            if (stage->liveWorkers.load(std::memory_order_acquire) > 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // 等待所有工作线程退出（会阻塞，UI 线程应先用 isFinished() 判断）
+    void wait()
+    {
+        std::vector<std::thread> threads;
+        {
+            std::lock_guard<std::mutex> locker(m_threadsMutex);
+            threads.swap(m_threads);
+        }
+        for (auto &thread : threads) {
+            if (thread.joinable()) {
+                thread.join();
+            }
+        }
+    }
+
+    QVector<PipelineStageStats> stats() const
+    {
+        QVector<PipelineStageStats> result;
+        for (const auto &stage : m_stages) {
+            PipelineStageStats s;
+            s.name = stage->name;
+            s.workers = stage->liveWorkers.load(std::memory_order_relaxed);
+            s.targetWorkers = stage->targetWorkers.load(std::memory_order_relaxed);
+            s.processed = stage->processed.load(std::memory_order_relaxed);
+            s.batches = stage->batches.load(std::memory_order_relaxed);
+            s.busyNs = stage->busyNs.load(std::memory_order_relaxed);
+            s.inputDepth = stage->inputDepth();
+            s.inputCapacity = stage->inputCapacity();
+            s.finished = s.workers == 0;
+            stage->fillInputStats(s);
+            result.push_back(s);
+        }
+        return result;
+    }
+
+    // 自 start() 起经过的纳秒数
+    quint64 elapsedNs() const { return nsSince(m_startTime); }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    static quint64 nsSince(Clock::time_point begin)
+    {
+        return static_cast<quint64>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - begin).count());
+    }
+
+    struct StageBase
+    {
+        StageBase(PipelineEngine *owner, const QString &stageName, int workers)
+            : engine(owner)
+            , name(stageName)
+            , index(static_cast<quint16>(owner->m_stages.size()))
+            , initialWorkers(qMax(1, workers))
+        {
+        }
+        virtual ~StageBase() = default;
+
+        virtual void runWorker() = 0;
+        virtual void closeQueues() = 0;
+        virtual void closeOutput() = 0;
+        virtual std::size_t inputDepth() const = 0;
+        virtual std::size_t inputCapacity() const = 0;
+        virtual void fillInputStats(PipelineStageStats &stats) const { Q_UNUSED(stats); }
+
+        // 工作线程退出：最后一个负责关闭输出，把“没有更多数据”传给下游
+        void workerExited()
+        {
+            if (liveWorkers.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                closeOutput();
+            }
+        }
+
+        // 存活线程多于目标数时，当前线程退出（返回 true）；目标至少为 1，退出的不会是最后一个
+        bool retireIfSurplus()
+        {
+            int live = liveWorkers.load(std::memory_order_relaxed);
+            while (live > targetWorkers.load(std::memory_order_relaxed)) {
+                if (liveWorkers.compare_exchange_weak(live, live - 1, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // 执行一次阶段函数并累计忙碌时长
+        template <typename F>
+        decltype(auto) timed(F &&f)
+        {
+            struct Busy
+            {
+                std::atomic<quint64> &total;
+                Clock::time_point begin = Clock::now();
+                ~Busy() { total.fetch_add(nsSince(begin), std::memory_order_relaxed); }
+            } busy{busyNs};
+            return f();
+        }
+
+        // 阶段函数可能把输入 move 走，先把这一批的追踪戳抄下来（stamps 由工作线程复用）
+        template <typename T>
+        static void collectStamps(const std::vector<T> &items, std::vector<PipelineTraceStamp> &stamps)
+        {
+            stamps.clear();
+            if constexpr (IsPipelineTraceable<T>::value) {
+                for (const T &item : items) {
+                    stamps.push_back(item.trace);
+                }
+            }
+        }
+
+        // ---- 追踪：只对带 trace 成员的数据类型生效，其他类型 if constexpr 全部去掉 ----
+
+        template <typename T>
+        static quint64 traceClock()
+        {
+            if constexpr (IsPipelineTraceable<T>::value) {
+                return pipelineNowNs();
+            } else {
+                return 0;
+            }
+        }
+
+        template <typename T>
+        static PipelineTraceStamp stampOf(const T &item)
+        {
+            if constexpr (IsPipelineTraceable<T>::value) {
+                return item.trace;
+            } else {
+                Q_UNUSED(item);
+                return PipelineTraceStamp();
+            }
+        }
+
+        // 一项在本阶段走完一跳：入队 -> 出队是排队时间，出队 -> 完成是服务时间
+        void recordHop(const PipelineTraceStamp &stamp, quint64 dequeuedNs, quint64 doneNs)
+        {
+            const quint64 queued = dequeuedNs > stamp.enqueuedNs ? dequeuedNs - stamp.enqueuedNs : 0;
+            queueHistogram.record(queued);
+            if (PipelineTraceBuffer *trace = engine->m_trace.get()) {
+                trace->record({stamp.id, stamp.enqueuedNs, queued, PipelineTraceBuffer::currentThread(), index,
+                               PipelineTraceSpan::Queue});
+            }
+            recordService(stamp, dequeuedNs, doneNs);
+        }
+
+        void recordService(const PipelineTraceStamp &stamp, quint64 beginNs, quint64 doneNs)
+        {
+            serviceHistogram.record(doneNs - beginNs);
+            sinceBornHistogram.record(doneNs > stamp.bornNs ? doneNs - stamp.bornNs : 0);
+            if (PipelineTraceBuffer *trace = engine->m_trace.get()) {
+                trace->record({stamp.id, beginNs, doneNs - beginNs, PipelineTraceBuffer::currentThread(), index,
+                               PipelineTraceSpan::Service});
+            }
+        }
+
+        // 输出项沿用输入项的追踪戳（已经带着编号的保留自己的；新产生且无从对应的分配新编号），
+        // 并记下进入输出队列的时刻
+        template <typename T>
+        void traceForward(T &result, const PipelineTraceStamp &from, quint64 doneNs)
+        {
+            if constexpr (IsPipelineTraceable<T>::value) {
+                if (result.trace.id == 0) {
+                    result.trace = from;
+                }
+                if (result.trace.id == 0) {
+                    result.trace.id = engine->m_nextTraceId.fetch_add(1, std::memory_order_relaxed);
+                    result.trace.bornNs = doneNs;
+                }
+                result.trace.enqueuedNs = doneNs;
+            } else {
+                Q_UNUSED(result);
+                Q_UNUSED(from);
+                Q_UNUSED(doneNs);
+            }
+        }
+
+        PipelineEngine *engine;
+        QString name;
+        quint16 index; // 在流水线中的位置，追踪区间里用它标识阶段
+        int initialWorkers;
+        int spawnedWorkers = 0; // 只在 m_threadsMutex 内访问，用于给追踪线程起名
+        std::atomic<int> liveWorkers{0};
+        std::atomic<int> targetWorkers{0};
+        std::atomic<quint64> processed{0};
+        std::atomic<quint64> batches{0};
+        std::atomic<quint64> busyNs{0};
+        LatencyHistogram queueHistogram;
+        LatencyHistogram serviceHistogram;
+        LatencyHistogram sinceBornHistogram;
+    };
+
+    template <typename Out, typename Produce>
+    struct SourceStage : StageBase
+    {
+        SourceStage(PipelineEngine *owner, const QString &stageName, int workers, Produce fn,
+                    std::shared_ptr<PipelineEdge<Out>> out)
+            : StageBase(owner, stageName, workers), produce(std::move(fn)), output(std::move(out))
+        {
+        }
+
+        void runWorker() override
+        {
+            while (!engine->isStopping()) {
+                Out item{};
+                const quint64 begin = traceClock<Out>();
+                if (!timed([&] { return produce(item); })) {
+                    break;
+                }
+                if constexpr (IsPipelineTraceable<Out>::value) {
+                    // 数据源的服务时间包含 produce 里的一切等待（限速、借缓冲区等）
+                    const quint64 done = pipelineNowNs();
+                    traceForward(item, PipelineTraceStamp(), done);
+                    recordService(item.trace, begin, done);
+                }
+                if (!output->push(std::move(item))) {
+                    break;
+                }
+                processed.fetch_add(1, std::memory_order_relaxed);
+                batches.fetch_add(1, std::memory_order_relaxed);
+                if (retireIfSurplus()) {
+                    return;
+                }
+            }
+            workerExited();
+        }
+
+        void closeQueues() override { output->close(); }
+        void closeOutput() override { output->close(); }
+        std::size_t inputDepth() const override { return 0; }
+        std::size_t inputCapacity() const override { return 0; }
+
+        Produce produce;
+        std::shared_ptr<PipelineEdge<Out>> output;
+    };
+
+    template <typename In, typename Out, typename Fn>
+    struct TransformStage : StageBase
+    {
+        TransformStage(PipelineEngine *owner, const QString &stageName, int workers, Fn f,
+                       std::shared_ptr<PipelineEdge<In>> in, std::shared_ptr<PipelineEdge<Out>> out)
+            : StageBase(owner, stageName, workers), fn(std::move(f)), input(std::move(in)), output(std::move(out))
+        {
+        }
+
+        void runWorker() override
+        {
+            In item;
+            while (input->pop(item)) {
+                if (engine->isCancelled()) {
+                    break;
+                }
+                const quint64 dequeued = traceClock<In>();
+                const PipelineTraceStamp stamp = stampOf(item);
+                Out result = timed([&] { return fn(std::move(item)); });
+                if constexpr (IsPipelineTraceable<In>::value || IsPipelineTraceable<Out>::value) {
+                    const quint64 done = pipelineNowNs();
+                    if constexpr (IsPipelineTraceable<In>::value) {
+                        recordHop(stamp, dequeued, done);
+                    }
+                    traceForward(result, stamp, done);
+                }
+                if (!output->push(std::move(result))) {
+                    break;
+                }
+                processed.fetch_add(1, std::memory_order_relaxed);
+                batches.fetch_add(1, std::memory_order_relaxed);
+                if (retireIfSurplus()) {
+                    return;
+                }
+            }
+            workerExited();
+        }
+
+        void closeQueues() override
+        {
+            input->close();
+            output->close();
+        }
+        void closeOutput() override { output->close(); }
+        std::size_t inputDepth() const override { return input->size(); }
+        std::size_t inputCapacity() const override { return input->capacity(); }
+        void fillInputStats(PipelineStageStats &stats) const override { input->fillStats(stats); }
+
+        Fn fn;
+        std::shared_ptr<PipelineEdge<In>> input;
+        std::shared_ptr<PipelineEdge<Out>> output;
+    };
+
+    template <typename In, typename Fn>
+    struct SinkStage : StageBase
+    {
+        SinkStage(PipelineEngine *owner, const QString &stageName, int workers, Fn f, std::shared_ptr<PipelineEdge<In>> in)
+            : StageBase(owner, stageName, workers), fn(std::move(f)), input(std::move(in))
+        {
+        }
+
+        void runWorker() override
+        {
+            In item;
+            while (input->pop(item)) {
+                if (engine->isCancelled()) {
+                    break;
+                }
+                const quint64 dequeued = traceClock<In>();
+                const PipelineTraceStamp stamp = stampOf(item);
+                timed([&] { fn(std::move(item)); });
+                if constexpr (IsPipelineTraceable<In>::value) {
+                    recordHop(stamp, dequeued, pipelineNowNs());
+                }
+                processed.fetch_add(1, std::memory_order_relaxed);
+                batches.fetch_add(1, std::memory_order_relaxed);
+                if (retireIfSurplus()) {
+                    return;
+                }
+            }
+            workerExited();
+        }
+
+        void closeQueues() override { input->close(); }
+        void closeOutput() override {}
+        std::size_t inputDepth() const override { return input->size(); }
+        std::size_t inputCapacity() const override { return input->capacity(); }
+        void fillInputStats(PipelineStageStats &stats) const override { input->fillStats(stats); }
+
+        Fn fn;
+        std::shared_ptr<PipelineEdge<In>> input;
+    };
+
+    template <typename In, typename Out, typename Fn>
+    struct BatchTransformStage : StageBase
+    {
+        BatchTransformStage(PipelineEngine *owner, const QString &stageName, int workers, Fn f, const PipelineBatch &b,
+                            std::shared_ptr<PipelineEdge<In>> in, std::shared_ptr<PipelineEdge<Out>> out)
+            : StageBase(owner, stageName, workers), fn(std::move(f)), batch{qMax<std::size_t>(1, b.maxItems), qMax(0, b.lingerUs)}, input(std::move(in)), output(std::move(out))
+        {
+        }
+
+        void runWorker() override
+        {
+            std::vector<In> items;
+            std::vector<Out> results;
+            std::vector<PipelineTraceStamp> stamps;
+            items.reserve(batch.maxItems);
+            results.reserve(batch.maxItems);
+            while (input->popBatch(items, batch) > 0) {
+                if (engine->isCancelled()) {
+                    break;
+                }
+                const std::size_t n = items.size();
+                const quint64 dequeued = traceClock<In>();
+                collectStamps(items, stamps);
+                timed([&] { fn(items, results); });
+                if constexpr (IsPipelineTraceable<In>::value || IsPipelineTraceable<Out>::value) {
+                    const quint64 done = pipelineNowNs();
+                    if constexpr (IsPipelineTraceable<In>::value) {
+                        for (const PipelineTraceStamp &stamp : stamps) {
+                            recordHop(stamp, dequeued, done);
+                        }
+                    }
+                    // 输出与输入按下标对应（一进一出的常见情况）；输出更多时多出来的项分配新编号
+                    for (std::size_t i = 0; i < results.size(); ++i) {
+                        traceForward(results[i], i < stamps.size() ? stamps[i] : PipelineTraceStamp(), done);
+                    }
+                }
+                items.clear();
+                const bool delivered = output->pushBatch(results) == results.size();
+                results.clear();
+                if (!delivered) {
+                    break;
+                }
+                processed.fetch_add(n, std::memory_order_relaxed);
+                batches.fetch_add(1, std::memory_order_relaxed);
+                if (retireIfSurplus()) {
+                    return;
+                }
+            }
+            workerExited();
+        }
+
+        void closeQueues() override
+        {
+            input->close();
+            output->close();
+        }
+        void closeOutput() override { output->close(); }
+        std::size_t inputDepth() const override { return input->size(); }
+        std::size_t inputCapacity() const override { return input->capacity(); }
+        void fillInputStats(PipelineStageStats &stats) const override { input->fillStats(stats); }
+
+        Fn fn;
+        const PipelineBatch batch;
+        std::shared_ptr<PipelineEdge<In>> input;
+        std::shared_ptr<PipelineEdge<Out>> output;
+    };
+
+    template <typename In, typename Fn>
+    struct BatchSinkStage : StageBase
+    {
+        BatchSinkStage(PipelineEngine *owner, const QString &stageName, int workers, Fn f, const PipelineBatch &b,
+                       std::shared_ptr<PipelineEdge<In>> in)
+            : StageBase(owner, stageName, workers), fn(std::move(f)), batch{qMax<std::size_t>(1, b.maxItems), qMax(0, b.lingerUs)}, input(std::move(in))
+        {
+        }
+
+        void runWorker() override
+        {
+            std::vector<In> items;
+            std::vector<PipelineTraceStamp> stamps;
+            items.reserve(batch.maxItems);
+            while (input->popBatch(items, batch) > 0) {
+                if (engine->isCancelled()) {
+                    break;
+                }
+                const std::size_t n = items.size();
+                const quint64 dequeued = traceClock<In>();
+                collectStamps(items, stamps);
+                timed([&] { fn(items); });
+                if constexpr (IsPipelineTraceable<In>::value) {
+                    const quint64 done = pipelineNowNs();
+                    for (const PipelineTraceStamp &stamp : stamps) {
+                        recordHop(stamp, dequeued, done);
+                    }
+                }
+                items.clear();
+                processed.fetch_add(n, std::memory_order_relaxed);
+                batches.fetch_add(1, std::memory_order_relaxed);
+                if (retireIfSurplus()) {
+                    return;
+                }
+            }
+            workerExited();
+        }
+
+        void closeQueues() override { input->close(); }
+        void closeOutput() override {}
+        std::size_t inputDepth() const override { return input->size(); }
+        std::size_t inputCapacity() const override { return input->capacity(); }
+        void fillInputStats(PipelineStageStats &stats) const override { input->fillStats(stats); }
+
+        Fn fn;
+        const PipelineBatch batch;
+        std::shared_ptr<PipelineEdge<In>> input;
+    };
+
+    // 调用方持有 m_threadsMutex，并已经把该线程计入 liveWorkers
+    void spawnWorker(StageBase *stage)
+    {
+        const int number = ++stage->spawnedWorkers;
+        m_threads.emplace_back([stage, number, trace = m_trace] {
+            if (trace) {
+                trace->nameThread(PipelineTraceBuffer::currentThread(), QString("%1 #%2").arg(stage->name).arg(number));
+            }
+            stage->runWorker();
+        });
+    }
+
+    template <typename In, typename Out, typename Fn>
+    PipelinePort<Out> addTransform(const QString &name, const PipelinePort<In> &input, Fn fn, int workers,
+                                   std::shared_ptr<PipelineEdge<Out>> output)
+    {
+        m_stages.push_back(std::make_unique<TransformStage<In, Out, Fn>>(this, name, workers, std::move(fn), input.m_edge, output));
+        return PipelinePort<Out>(output);
+    }
+
+    template <typename In, typename Out, typename Fn>
+    PipelinePort<Out> addBatchTransform(const QString &name, const PipelinePort<In> &input, Fn fn, const PipelineBatch &batch,
+                                        int workers, std::shared_ptr<PipelineEdge<Out>> output)
+    {
+        m_stages.push_back(std::make_unique<BatchTransformStage<In, Out, Fn>>(this, name, workers, std::move(fn), batch,
+                                                                              input.m_edge, output));
+        return PipelinePort<Out>(output);
+    }
+
+    template <typename T>
+    std::shared_ptr<PipelineEdge<T>> makeQueue(std::size_t capacity) const
+    {
+        return std::make_shared<QueueEdge<T>>(capacity > 0 ? capacity : m_edgeCapacity);
+    }
+
+    const std::size_t m_edgeCapacity;
+    std::vector<std::unique_ptr<StageBase>> m_stages;
+    std::atomic<bool> m_stopping{false};
+    std::atomic<bool> m_cancelled{false};
+    Clock::time_point m_startTime = Clock::now();
+
+    std::shared_ptr<PipelineTraceBuffer> m_trace;
+    std::atomic<quint64> m_nextTraceId{1};
+
+    std::mutex m_threadsMutex;
+    std::vector<std::thread> m_threads;
+};
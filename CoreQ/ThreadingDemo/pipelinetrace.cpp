@@ -0,0 +1,71 @@
+#include "pipelinetrace.h"
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+/*
+ * Chrome trace-event 格式：
+ * - 每个工作线程一条 "thread_name" 元数据事件；
+ * - 服务区间 -> "X"（完整事件），画在处理它的工作线程上；
+ * - 排队区间 -> "b"/"e"（异步事件），以数据项编号配对，同一项在不同阶段的排队用名字区分；
+ * 时间戳单位为微秒，以缓冲区里最早的一段为 0。
+ */
+QByteArray PipelineTraceBuffer::toChromeTraceJson(const QStringList &stageNames) const
+{
+    const std::vector<PipelineTraceSpan> spans = snapshot();
+    const quint64 origin = spans.empty() ? 0 : spans.front().startNs;
+    auto micros = [origin](quint64 ns) { return double(ns - origin) / 1000.0; };
+    auto stageName = [&stageNames](quint16 stage) {
+        return stage < stageNames.size() ? stageNames.at(stage) : QString("stage %1").arg(stage);
+    };
+
+    QJsonArray events;
+    const QMap<quint32, QString> names = threadNames();
+    for (auto it = names.constBegin(); it != names.constEnd(); ++it) {
+        QJsonObject meta;
+        meta["name"] = "thread_name";
+        meta["ph"] = "M";
+        meta["pid"] = 1;
+        meta["tid"] = static_cast<qint64>(it.key());
+        meta["args"] = QJsonObject{{"name", it.value()}};
+        events.append(meta);
+    }
+
+    for (const PipelineTraceSpan &span : spans) {
+        const QJsonObject args{{"item", static_cast<qint64>(span.item)}};
+        if (span.kind == PipelineTraceSpan::Service) {
+            QJsonObject event;
+            event["name"] = stageName(span.stage);
+            event["cat"] = "service";
+            event["ph"] = "X";
+            event["ts"] = micros(span.startNs);
+            event["dur"] = double(span.durationNs) / 1000.0;
+            event["pid"] = 1;
+            event["tid"] = static_cast<qint64>(span.thread);
+            event["args"] = args;
+            events.append(event);
+        } else {
+            QJsonObject begin;
+            begin["name"] = QString("排队 -> %1").arg(stageName(span.stage));
+            begin["cat"] = "queue";
+            begin["id"] = static_cast<qint64>(span.item);
+            begin["pid"] = 1;
+            begin["tid"] = static_cast<qint64>(span.thread);
+            begin["args"] = args;
+            QJsonObject end = begin;
+            begin["ph"] = "b";
+            begin["ts"] = micros(span.startNs);
+            end["ph"] = "e";
+            end["ts"] = micros(span.startNs + span.durationNs);
+            events.append(begin);
+            events.append(end);
+        }
+    }
+
+    QJsonObject root;
+    root["traceEvents"] = events;
+    root["displayTimeUnit"] = "ms";
+    root["otherData"] = QJsonObject{{"recorded", static_cast<qint64>(recorded())},
+                                    {"overwritten", static_cast<qint64>(overwritten())}};
+    return QJsonDocument(root).toJson(QJsonDocument::Compact);
+}
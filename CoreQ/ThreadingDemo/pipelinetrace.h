@@ -0,0 +1,168 @@
+#pragma once
+
+#include <QByteArray>
+#include <QMap>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QString>
+#include <QStringList>
+#include <QtGlobal>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+// 单调时钟的纳秒数，流水线里所有追踪时间戳都用它
+inline quint64 pipelineNowNs()
+{
+    return static_cast<quint64>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+/*
+ * 随数据一起流动的追踪戳：数据类型里放一个名为 trace 的 PipelineTraceStamp 成员即可被 PipelineEngine 追踪
+ * - id：数据源产出时分配，整条流水线上不变；
+ * - bornNs：进入流水线（数据源产出完成）的时刻；
+ * - enqueuedNs：最近一次进入阶段间队列的时刻，下游出队时据此算出排队时间。
+ */
+struct PipelineTraceStamp {
+    quint64 id = 0;
+    quint64 bornNs = 0;
+    quint64 enqueuedNs = 0;
+};
+
+template <typename T, typename = void>
+struct IsPipelineTraceable : std::false_type {
+};
+
+template <typename T>
+struct IsPipelineTraceable<T, std::void_t<decltype(std::declval<T &>().trace)>>
+    : std::is_same<std::decay_t<decltype(std::declval<T &>().trace)>, PipelineTraceStamp> {
+};
+
+// 一段追踪区间：某一项在某个阶段的排队（入队 -> 出队）或服务（出队 -> 完成）
+struct PipelineTraceSpan {
+    enum Kind : quint8 { Queue, Service };
+
+    quint64 item = 0;
+    quint64 startNs = 0;
+    quint64 durationNs = 0;
+    quint32 thread = 0;
+    quint16 stage = 0;
+    Kind kind = Service;
+};
+
+/*
+ * PipelineTraceBuffer：有界的追踪缓冲区，只保留最近 capacity 段区间
+ *
+ * - record() 无锁：fetch_add 取得一个全局序号，写进 序号 % capacity 的槽位，旧数据被覆盖；
+ * - 每个槽位是一个小顺序锁：写前把版本置为奇数，写完置为 2×(序号+1)，
+ *   snapshot() 读到奇数或前后版本不一致（正在被覆盖）的槽位直接跳过，不会读到半条记录；
+ * - 工作线程编号按线程首次记录的顺序分配，nameThread() 给它起名，导出时作为 Chrome 里的线程名。
+ */
+class PipelineTraceBuffer
+{
+public:
+    explicit PipelineTraceBuffer(std::size_t capacity = 1 << 16)
+        : m_capacity(capacity > 0 ? capacity : 1), m_slots(new Slot[m_capacity])
+    {
+    }
+
+    PipelineTraceBuffer(const PipelineTraceBuffer &) = delete;
+    PipelineTraceBuffer &operator=(const PipelineTraceBuffer &) = delete;
+
+    void record(const PipelineTraceSpan &span)
+    {
+        const quint64 index = m_next.fetch_add(1, std::memory_order_relaxed);
+        Slot &slot = m_slots[index % m_capacity];
+        slot.version.store(2 * index + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.item.store(span.item, std::memory_order_relaxed);
+        slot.startNs.store(span.startNs, std::memory_order_relaxed);
+        slot.durationNs.store(span.durationNs, std::memory_order_relaxed);
+        slot.packed.store(quint64(span.thread) << 32 | quint64(span.stage) << 8 | span.kind, std::memory_order_relaxed);
+        slot.version.store(2 * index + 2, std::memory_order_release);
+    }
+
+    // 当前缓冲区里完整的区间，按开始时间排序
+    std::vector<PipelineTraceSpan> snapshot() const
+    {
+        std::vector<PipelineTraceSpan> spans;
+        spans.reserve(qMin<quint64>(m_capacity, m_next.load(std::memory_order_relaxed)));
+        for (std::size_t i = 0; i < m_capacity; ++i) {
+            const Slot &slot = m_slots[i];
+            const quint64 before = slot.version.load(std::memory_order_acquire);
+            if (before == 0 || (before & 1) != 0) {
+                continue;
+            }
+            PipelineTraceSpan span;
+            span.item = slot.item.load(std::memory_order_relaxed);
+            span.startNs = slot.startNs.load(std::memory_order_relaxed);
+            span.durationNs = slot.durationNs.load(std::memory_order_relaxed);
+            const quint64 packed = slot.packed.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.version.load(std::memory_order_relaxed) != before) {
+                continue;
+            }
+            span.thread = static_cast<quint32>(packed >> 32);
+            span.stage = static_cast<quint16>(packed >> 8);
+            span.kind = static_cast<PipelineTraceSpan::Kind>(packed & 0xff);
+            spans.push_back(span);
+        }
+        std::sort(spans.begin(), spans.end(),
+                  [](const PipelineTraceSpan &a, const PipelineTraceSpan &b) { return a.startNs < b.startNs; });
+        return spans;
+    }
+
+    std::size_t capacity() const { return m_capacity; }
+    quint64 recorded() const { return m_next.load(std::memory_order_relaxed); }
+    // 被新数据覆盖掉的区间数
+    quint64 overwritten() const
+    {
+        const quint64 n = recorded();
+        return n > m_capacity ? n - m_capacity : 0;
+    }
+
+    // 当前线程的追踪编号（进程内从 1 开始递增）
+    static quint32 currentThread()
+    {
+        static std::atomic<quint32> next{1};
+        thread_local const quint32 id = next.fetch_add(1, std::memory_order_relaxed);
+        return id;
+    }
+
+    void nameThread(quint32 thread, const QString &name)
+    {
+        QMutexLocker locker(&m_namesMutex);
+        m_threadNames.insert(thread, name);
+    }
+
+    QMap<quint32, QString> threadNames() const
+    {
+        QMutexLocker locker(&m_namesMutex);
+        return m_threadNames;
+    }
+
+    // 导出为 Chrome trace-event JSON（chrome://tracing 或 Perfetto 可直接打开）；
+    // 服务区间是工作线程上的完整事件，排队区间是按数据项编号配对的异步事件
+    QByteArray toChromeTraceJson(const QStringList &stageNames) const;
+
+private:
+    struct Slot {
+        std::atomic<quint64> version{0};
+        std::atomic<quint64> item{0};
+        std::atomic<quint64> startNs{0};
+        std::atomic<quint64> durationNs{0};
+        std::atomic<quint64> packed{0};
+    };
+
+    const std::size_t m_capacity;
+    std::unique_ptr<Slot[]> m_slots;
+    alignas(64) std::atomic<quint64> m_next{0};
+
+    mutable QMutex m_namesMutex;
+    QMap<quint32, QString> m_threadNames;
+};
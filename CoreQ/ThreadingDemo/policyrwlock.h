@@ -0,0 +1,216 @@
+#pragma once
+
+#include <QMutex>
+#include <QMutexLocker>
+#include <QWaitCondition>
+#include <QtGlobal>
+#include <atomic>
+
+/*
+ * PolicyRwLock：一个 64 位原子状态字实现的读写锁，支持三种准入策略
+ *
+ * 状态字：[0,20) 活跃读者数 | 第 20 位 写者持有 | [21,41) 等待的写者数 | [41,61) 等待的读者数
+ *
+ * - 快速路径：读者一次 CAS 给读者数加 1；写者在状态字为 0 时一次 CAS 置写者位；
+ *   解锁时若没有等待者也只是一次 CAS。只有策略要求排队时才进入互斥锁 + 条件变量的慢速路径；
+ * - 慢速路径直接移交所有权：最后一个读者离开时替等待的写者置好写者位，写者解锁时替等待的读者
+ *   把读者数加好，被唤醒的线程醒来即持有锁，不会和新来的线程抢；
+ * - 策略：
+ *   ReaderPreference 读者只在写者持有时等待，写者解锁优先放行读者（写者可能饥饿）；
+ *   WriterPreference 有写者等待时新读者也要等，写者解锁优先交给下一个写者（读者可能饥饿）；
+ *   Fair 有写者等待时新读者排队，写者解锁时把此前排队的读者整批放行，读写两阶段交替（phase-fair）。
+ */
+class PolicyRwLock
+{
+public:
+    enum class Policy { ReaderPreference, WriterPreference, Fair };
+
+    explicit PolicyRwLock(Policy policy = Policy::Fair) : m_policy(policy) {}
+
+    PolicyRwLock(const PolicyRwLock &) = delete;
+    PolicyRwLock &operator=(const PolicyRwLock &) = delete;
+
+    // 切换策略（只应在锁空闲时调用）
+    void setPolicy(Policy policy) { m_policy.store(policy, std::memory_order_relaxed); }
+    Policy policy() const { return m_policy.load(std::memory_order_relaxed); }
+
+    void lockShared()
+    {
+        quint64 s = m_state.load(std::memory_order_relaxed);
+        while (readerMayEnter(s)) {
+            if (m_state.compare_exchange_weak(s, s + kReaderUnit, std::memory_order_acquire, std::memory_order_relaxed)) {
+                return;
+            }
+        }
+        lockSharedSlow();
+    }
+
+    void unlockShared()
+    {
+        quint64 s = m_state.load(std::memory_order_relaxed);
+        while (!(readers(s) == 1 && waitingWriters(s) > 0)) {
+            if (m_state.compare_exchange_weak(s, s - kReaderUnit, std::memory_order_release, std::memory_order_relaxed)) {
+                return;
+            }
+        }
+        unlockSharedSlow();
+    }
+
+    void lock()
+    {
+        quint64 s = 0;
+        if (m_state.compare_exchange_strong(s, kWriter, std::memory_order_acquire, std::memory_order_relaxed)) {
+            return;
+        }
+        lockSlow();
+    }
+
+    void unlock()
+    {
+        quint64 s = kWriter;
+        if (m_state.compare_exchange_strong(s, 0, std::memory_order_release, std::memory_order_relaxed)) {
+            return;
+        }
+        unlockSlow();
+    }
+
+    // 进入慢速路径（需要排队或移交）的累计次数
+    quint64 slowPaths() const { return m_slowPaths.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr quint64 kCountMask = (quint64(1) << 20) - 1;
+    static constexpr quint64 kReaderUnit = 1;
+    static constexpr quint64 kWriter = quint64(1) << 20;
+    static constexpr int kWaitingWriterShift = 21;
+    static constexpr quint64 kWaitingWriterUnit = quint64(1) << kWaitingWriterShift;
+    static constexpr int kWaitingReaderShift = 41;
+    static constexpr quint64 kWaitingReaderUnit = quint64(1) << kWaitingReaderShift;
+
+    static quint64 readers(quint64 s) { return s & kCountMask; }
+    static bool writerHeld(quint64 s) { return (s & kWriter) != 0; }
+    static quint64 waitingWriters(quint64 s) { return (s >> kWaitingWriterShift) & kCountMask; }
+    static quint64 waitingReaders(quint64 s) { return (s >> kWaitingReaderShift) & kCountMask; }
+
+    bool readerMayEnter(quint64 s) const
+    {
+        if (writerHeld(s)) {
+            return false;
+        }
+        return policy() == Policy::ReaderPreference || waitingWriters(s) == 0;
+    }
+
+    // ---- 慢速路径：都在 m_mutex 内修改状态字，保证登记等待和移交所有权之间不会丢唤醒 ----
+
+    void lockSharedSlow()
+    {
+        QMutexLocker locker(&m_mutex);
+        m_slowPaths.fetch_add(1, std::memory_order_relaxed);
+        quint64 s = m_state.load(std::memory_order_relaxed);
+        for (;;) {
+            if (readerMayEnter(s)) {
+                if (m_state.compare_exchange_weak(s, s + kReaderUnit, std::memory_order_acquire, std::memory_order_relaxed)) {
+                    return;
+                }
+            } else if (m_state.compare_exchange_weak(s, s + kWaitingReaderUnit, std::memory_order_relaxed)) {
+                break;
+            }
+        }
+        // 写者解锁时会替我们把读者数加好并发放等量的通行证
+        while (m_readerGrants == 0) {
+            m_readersCv.wait(&m_mutex);
+        }
+        --m_readerGrants;
+    }
+
+    void unlockSharedSlow()
+    {
+        QMutexLocker locker(&m_mutex);
+        m_slowPaths.fetch_add(1, std::memory_order_relaxed);
+        quint64 s = m_state.load(std::memory_order_relaxed);
+        for (;;) {
+            if (readers(s) == 1 && waitingWriters(s) > 0) {
+                // 最后一个读者离开：直接把锁移交给一个等待的写者
+                const quint64 next = s - kReaderUnit - kWaitingWriterUnit + kWriter;
+                if (m_state.compare_exchange_weak(s, next, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+                    ++m_writerGrants;
+                    m_writersCv.wakeOne();
+                    return;
+                }
+            } else if (m_state.compare_exchange_weak(s, s - kReaderUnit, std::memory_order_release, std::memory_order_relaxed)) {
+                return;
+            }
+        }
+    }
+
+    void lockSlow()
+    {
+        QMutexLocker locker(&m_mutex);
+        m_slowPaths.fetch_add(1, std::memory_order_relaxed);
+        quint64 s = m_state.load(std::memory_order_relaxed);
+        for (;;) {
+            if (readers(s) == 0 && !writerHeld(s) && waitingWriters(s) == 0) {
+                if (m_state.compare_exchange_weak(s, s | kWriter, std::memory_order_acquire, std::memory_order_relaxed)) {
+                    return;
+                }
+            } else if (m_state.compare_exchange_weak(s, s + kWaitingWriterUnit, std::memory_order_relaxed)) {
+                break;
+            }
+        }
+        // 移交方已经替我们置好写者位
+        while (m_writerGrants == 0) {
+            m_writersCv.wait(&m_mutex);
+        }
+        --m_writerGrants;
+    }
+
+    void unlockSlow()
+    {
+        QMutexLocker locker(&m_mutex);
+        m_slowPaths.fetch_add(1, std::memory_order_relaxed);
+        quint64 s = m_state.load(std::memory_order_relaxed);
+        for (;;) {
+            const quint64 queuedReaders = waitingReaders(s);
+            const quint64 queuedWriters = waitingWriters(s);
+            bool releaseReaders = false;
+            switch (policy()) {
+            case Policy::ReaderPreference:
+            case Policy::Fair:
+                releaseReaders = queuedReaders > 0;
+                break;
+            case Policy::WriterPreference:
+                releaseReaders = queuedReaders > 0 && queuedWriters == 0;
+                break;
+            }
+
+            if (releaseReaders) {
+                // 整批放行排队的读者：清写者位，等待读者数转为活跃读者数
+                const quint64 next = s - kWriter - queuedReaders * kWaitingReaderUnit + queuedReaders * kReaderUnit;
+                if (m_state.compare_exchange_weak(s, next, std::memory_order_release, std::memory_order_relaxed)) {
+                    m_readerGrants += queuedReaders;
+                    m_readersCv.wakeAll();
+                    return;
+                }
+            } else if (queuedWriters > 0) {
+                // 写者位保持不变，直接交给下一个写者
+                if (m_state.compare_exchange_weak(s, s - kWaitingWriterUnit, std::memory_order_release, std::memory_order_relaxed)) {
+                    ++m_writerGrants;
+                    m_writersCv.wakeOne();
+                    return;
+                }
+            } else if (m_state.compare_exchange_weak(s, s - kWriter, std::memory_order_release, std::memory_order_relaxed)) {
+                return;
+            }
+        }
+    }
+
+    alignas(64) std::atomic<quint64> m_state{0};
+    std::atomic<Policy> m_policy;
+    std::atomic<quint64> m_slowPaths{0};
+
+    // 以下只在 m_mutex 内访问
+    QMutex m_mutex;
+    QWaitCondition m_readersCv;
+    QWaitCondition m_writersCv;
+    quint64 m_readerGrants = 0;
+    quint64 m_writerGrants = 0;
+};
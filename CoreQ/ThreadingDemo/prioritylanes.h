@@ -0,0 +1,337 @@
+#pragma once
+
+#include <QMutex>
+#include <QMutexLocker>
+#include <QWaitCondition>
+#include <QtGlobal>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+/*
+ * PriorityLanes：K 条优先级通道组成的有界阻塞队列（通道 0 优先级最高）
+ *
+ * - 每条通道是独立容量的环形槽位，满时只阻塞往这条通道生产的线程：
+ *   大批量数据塞满低优先级通道，不会挡住紧急消息入队；
+ * - 用一个位图记录非空通道，出队时 qCountTrailingZeroBits 一条指令找到最高优先级的非空通道，O(1)；
+ * - 防饿死：加权轮询。每一轮里通道 k 最多连续被服务 weight[k] 次（默认 2^(K-1-k)），
+ *   额度用完的通道在本轮让位给低优先级通道；所有有数据的通道都用完额度后开启新一轮。
+ *   额度在通道首次被选中时惰性重置，换轮只改一个位图，不需要遍历通道。
+ * - 唤醒按等待者计数：只有确有线程等待时才 wakeOne，生产者按通道分别等待。
+ */
+template <typename T>
+class PriorityLanes
+{
+public:
+    static constexpr int kMaxLanes = 32;
+
+    PriorityLanes(std::size_t laneCapacity, int lanes)
+        : m_laneCapacity(laneCapacity > 0 ? laneCapacity : 1)
+        , m_laneCount(qBound(1, lanes, kMaxLanes))
+        , m_lanes(new Lane[static_cast<std::size_t>(m_laneCount)])
+    {
+        m_laneMask = m_laneCount == 32 ? ~quint32(0) : (quint32(1) << m_laneCount) - 1;
+        m_hasCredit = m_laneMask;
+        for (int i = 0; i < m_laneCount; ++i) {
+            Lane &lane = m_lanes[static_cast<std::size_t>(i)];
+            lane.slots.reset(new Slot[m_laneCapacity]);
+            lane.weight = 1 << qMin(m_laneCount - 1 - i, 16);
+        }
+    }
+
+    ~PriorityLanes()
+    {
+        for (int i = 0; i < m_laneCount; ++i) {
+            Lane &lane = m_lanes[static_cast<std::size_t>(i)];
+            while (lane.count > 0) {
+                lane.at(lane.head)->~T();
+                lane.head = (lane.head + 1) % m_laneCapacity;
+                --lane.count;
+            }
+        }
+    }
+
+    PriorityLanes(const PriorityLanes &) = delete;
+    PriorityLanes &operator=(const PriorityLanes &) = delete;
+
+    int laneCount() const { return m_laneCount; }
+    std::size_t laneCapacity() const { return m_laneCapacity; }
+
+    // 修改通道权重（需在开始生产前调用），weight >= 1
+    void setWeight(int lane, int weight)
+    {
+        QMutexLocker locker(&m_mutex);
+        laneAt(lane).weight = qMax(1, weight);
+    }
+
+    // 阻塞入队：该通道满时等待，关闭后返回 false
+    bool push(T &&item, int lane)
+    {
+        QMutexLocker locker(&m_mutex);
+        Lane &l = laneAt(lane);
+        while (l.count == m_laneCapacity && !m_closed) {
+            waitNotFull(l, ULONG_MAX);
+        }
+        if (m_closed) {
+            return false;
+        }
+        constructBack(l, lane, std::move(item));
+        return true;
+    }
+
+    // 非阻塞入队：通道满或已关闭时返回 false，item 不会被移动
+    bool tryPush(T &&item, int lane)
+    {
+        QMutexLocker locker(&m_mutex);
+        Lane &l = laneAt(lane);
+        if (m_closed || l.count == m_laneCapacity) {
+            return false;
+        }
+        constructBack(l, lane, std::move(item));
+        return true;
+    }
+
+    // 限时入队：超时或已关闭返回 false，item 不会被移动
+    bool pushFor(T &&item, int lane, int timeoutMs)
+    {
+        QMutexLocker locker(&m_mutex);
+        Lane &l = laneAt(lane);
+        if (l.count == m_laneCapacity && !m_closed) {
+            const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+            while (l.count == m_laneCapacity && !m_closed) {
+                const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    deadline - std::chrono::steady_clock::now()).count();
+                if (left <= 0) {
+                    return false;
+                }
+                waitNotFull(l, static_cast<unsigned long>(left));
+            }
+        }
+        if (m_closed) {
+            return false;
+        }
+        constructBack(l, lane, std::move(item));
+        return true;
+    }
+
+    // 覆盖入队：通道满时丢弃该通道最旧的一项；返回被覆盖的项数（0 或 1），已关闭返回 -1
+    int pushOverwrite(T &&item, int lane)
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_closed) {
+            return -1;
+        }
+        Lane &l = laneAt(lane);
+        int evicted = 0;
+        if (l.count == m_laneCapacity) {
+            l.at(l.head)->~T();
+            l.head = (l.head + 1) % m_laneCapacity;
+            --l.count;
+            evicted = 1;
+        }
+        constructBack(l, lane, std::move(item));
+        return evicted;
+    }
+
+    // 阻塞出队：取当前轮次中优先级最高且仍有额度的通道；已关闭且取空后返回 false
+    bool pop(T &out, int *lane = nullptr)
+    {
+        QMutexLocker locker(&m_mutex);
+        while (m_nonEmpty == 0 && !m_closed) {
+            waitNotEmpty();
+        }
+        if (m_nonEmpty == 0) {
+            return false;
+        }
+        const int index = takeNext(out);
+        if (lane) {
+            *lane = index;
+        }
+        return true;
+    }
+
+    bool tryPop(T &out, int *lane = nullptr)
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_nonEmpty == 0) {
+            return false;
+        }
+        const int index = takeNext(out);
+        if (lane) {
+            *lane = index;
+        }
+        return true;
+    }
+
+    // 批量出队：至少等到一项，然后按调度顺序一次取走最多 maxItems 项
+    std::size_t popBatch(std::vector<T> &out, std::size_t maxItems)
+    {
+        QMutexLocker locker(&m_mutex);
+        while (m_nonEmpty == 0 && !m_closed) {
+            waitNotEmpty();
+        }
+        std::size_t n = 0;
+        T item;
+        while (n < maxItems && m_nonEmpty != 0) {
+            takeNext(item);
+            out.push_back(std::move(item));
+            ++n;
+        }
+        return n;
+    }
+
+    void close()
+    {
+        QMutexLocker locker(&m_mutex);
+        m_closed = true;
+        m_notEmpty.wakeAll();
+        for (int i = 0; i < m_laneCount; ++i) {
+            m_lanes[static_cast<std::size_t>(i)].notFull.wakeAll();
+        }
+    }
+
+    std::size_t laneSize(int lane) const
+    {
+        QMutexLocker locker(&m_mutex);
+        return m_lanes[static_cast<std::size_t>(qBound(0, lane, m_laneCount - 1))].count;
+    }
+
+    std::size_t size() const
+    {
+        QMutexLocker locker(&m_mutex);
+        std::size_t total = 0;
+        for (int i = 0; i < m_laneCount; ++i) {
+            total += m_lanes[static_cast<std::size_t>(i)].count;
+        }
+        return total;
+    }
+
+    quint64 fullWaits() const { return m_fullWaits.load(std::memory_order_relaxed); }
+    quint64 emptyWaits() const { return m_emptyWaits.load(std::memory_order_relaxed); }
+    quint64 fullWaitNs() const { return m_fullWaitNs.load(std::memory_order_relaxed); }
+    quint64 wakeups() const { return m_wakeups.load(std::memory_order_relaxed); }
+    quint64 wastedWakeups() const { return m_wastedWakeups.load(std::memory_order_relaxed); }
+
+private:
+    struct Slot
+    {
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+
+    struct Lane
+    {
+        std::unique_ptr<Slot[]> slots;
+        std::size_t head = 0;
+        std::size_t count = 0;
+        int weight = 1;
+        int credit = 0;
+        quint64 round = 0;        // credit 属于哪一轮，不是当前轮则视为已重置
+        std::size_t waitingProducers = 0;
+        QWaitCondition notFull;
+
+        T *at(std::size_t index) { return std::launder(reinterpret_cast<T *>(slots[index].storage)); }
+    };
+
+    Lane &laneAt(int lane) { return m_lanes[static_cast<std::size_t>(qBound(0, lane, m_laneCount - 1))]; }
+
+    // ---- 以下均要求调用方持有 m_mutex ----
+
+    void constructBack(Lane &l, int lane, T &&item)
+    {
+        new (l.slots[(l.head + l.count) % m_laneCapacity].storage) T(std::move(item));
+        ++l.count;
+        m_nonEmpty |= quint32(1) << qBound(0, lane, m_laneCount - 1);
+        if (m_waitingConsumers > 0) {
+            m_notEmpty.wakeOne();
+        }
+    }
+
+    // 按加权轮询选出下一条通道并取出队头；要求 m_nonEmpty != 0
+    int takeNext(T &out)
+    {
+        quint32 eligible = m_nonEmpty & m_hasCredit;
+        if (eligible == 0) {
+            // 所有非空通道的额度都用完了：开启新一轮
+            ++m_round;
+            m_hasCredit = m_laneMask;
+            eligible = m_nonEmpty;
+        }
+        const int index = static_cast<int>(qCountTrailingZeroBits(eligible));
+        Lane &l = m_lanes[static_cast<std::size_t>(index)];
+        if (l.round != m_round) {
+            l.round = m_round;
+            l.credit = l.weight;
+        }
+        if (--l.credit <= 0) {
+            m_hasCredit &= ~(quint32(1) << index);
+        }
+
+        T *item = l.at(l.head);
+        out = std::move(*item);
+        item->~T();
+        l.head = (l.head + 1) % m_laneCapacity;
+        if (--l.count == 0) {
+            m_nonEmpty &= ~(quint32(1) << index);
+        }
+        if (l.waitingProducers > 0) {
+            l.notFull.wakeOne();
+        }
+        return index;
+    }
+
+    void waitNotFull(Lane &l, unsigned long timeoutMs)
+    {
+        m_fullWaits.fetch_add(1, std::memory_order_relaxed);
+        ++l.waitingProducers;
+        const auto begin = std::chrono::steady_clock::now();
+        const bool woken = l.notFull.wait(&m_mutex, timeoutMs);
+        const auto waited = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - begin).count();
+        --l.waitingProducers;
+        m_fullWaitNs.fetch_add(static_cast<quint64>(waited), std::memory_order_relaxed);
+        countWakeup(woken, l.count == m_laneCapacity && !m_closed);
+    }
+
+    void waitNotEmpty()
+    {
+        m_emptyWaits.fetch_add(1, std::memory_order_relaxed);
+        ++m_waitingConsumers;
+        const bool woken = m_notEmpty.wait(&m_mutex);
+        --m_waitingConsumers;
+        countWakeup(woken, m_nonEmpty == 0 && !m_closed);
+    }
+
+    void countWakeup(bool woken, bool stillBlocked)
+    {
+        if (!woken) {
+            return;
+        }
+        m_wakeups.fetch_add(1, std::memory_order_relaxed);
+        if (stillBlocked) {
+            m_wastedWakeups.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    const std::size_t m_laneCapacity;
+    const int m_laneCount;
+    std::unique_ptr<Lane[]> m_lanes;
+    quint32 m_laneMask = 0;
+    quint32 m_nonEmpty = 0;  // 第 k 位：通道 k 非空
+    quint32 m_hasCredit = 0; // 第 k 位：通道 k 在本轮还有额度
+    quint64 m_round = 1;      // 通道的 round 初始为 0，保证首次被选中时按权重发放额度
+    bool m_closed = false;
+    std::size_t m_waitingConsumers = 0;
+    std::atomic<quint64> m_fullWaits{0};
+    std::atomic<quint64> m_emptyWaits{0};
+    std::atomic<quint64> m_fullWaitNs{0};
+    std::atomic<quint64> m_wakeups{0};
+    std::atomic<quint64> m_wastedWakeups{0};
+
+    mutable QMutex m_mutex;
+    QWaitCondition m_notEmpty;
+};
@@ -9,9 +9,11 @@ QPromise::QPromise(QWidget *parent)
     , syncButton(new QPushButton(u8"同步获取结果", this))
     , progressBar(new QProgressBar(this))
     , resultLabel(new QLabel("waiting calculate...", this))
+    , kernelCombo(new QComboBox(this))
     , mainLayout(new QVBoxLayout(this))
     , progressTimer(new QTimer(this))
     , isComputing(false)
+    , computeNs(0)
 {
     setupUI();
     initConnections();
@@ -29,8 +31,18 @@ void QPromise::setupUI()
     progressBar->setRange(0, 100);
     progressBar->setValue(0);
     resultLabel->setAlignment(Qt::AlignCenter);
+    for (SimdLevel level : simdAvailableLevels()) {
+        kernelCombo->addItem(simdLevelName(level), static_cast<int>(level));
+    }
+    kernelCombo->setCurrentIndex(kernelCombo->count() - 1);
+
+    auto *kernelLayout = new QHBoxLayout();
+    kernelLayout->addWidget(new QLabel(u8"计算内核:", this));
+    kernelLayout->addWidget(kernelCombo);
+    kernelLayout->addStretch();
 
     mainLayout->addWidget(new QLabel(u8"std::promise 示例", this));
+    mainLayout->addLayout(kernelLayout);
     mainLayout->addWidget(startButton);
     mainLayout->addWidget(syncButton);
     mainLayout->addWidget(progressBar);
@@ -52,30 +64,29 @@ void QPromise::initConnections()
  * @brief 后台计算函数（在独立线程运行）
  *
  * 说明：
- * - 使用随机数进行CPU密集型迭代，并周期性通过 progressUpdated(int) 发出进度信号；
+ * - 使用随机数进行CPU密集型迭代（按块交给标量或 SIMD 内核），并周期性通过 progressUpdated(int) 发出进度信号；
  * - 迭代结束后调用 promise.set_value(result) 设置最终结果；
  * - 该函数始终在 computeThread 所代表的后台线程内运行，不触及主线程事件循环。
  */
-void QPromise::compute(std::promise<int>&& p)
+void QPromise::compute(std::promise<int>&& p, SimdLevel level)
 {
-    //使用std库创建随机数
+    //使用std库生成种子；第 i 个随机数由 (种子, i) 直接算出，可以按块批量生成
     std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_real_distribution<> dis(0.0, 1.0);
+    const quint32 seed = rd();
 
     long long sum = 0;
     const int iterations = 10000000;
-
-    //进行迭代运算
-    for (int i = 0; i < iterations; ++i) {
-        double randomNumber = dis(gen);
-        sum += static_cast<long long>(randomNumber * randomNumber * 1000);
-
-        if (i % (iterations / 100) == 0) {
-            int progress = (i * 100) / iterations;
-            emit progressUpdated(progress);
-        }
+    const int chunk = iterations / 100;
+
+    //进行迭代运算：每块 1% 交给选定的内核，块之间发送进度
+    const auto begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i += chunk) {
+        int progress = (i * 100) / iterations;
+        emit progressUpdated(progress);
+        sum += simdSquareSum(level, seed, static_cast<quint32>(i), static_cast<std::size_t>(chunk));
     }
+    computeNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - begin).count();
 
     std::this_thread::sleep_for(std::chrono::seconds(2));
 
@@ -99,13 +110,15 @@ void QPromise::startComputation()
 
     isComputing = true;
     startButton->setEnabled(false);
+    kernelCombo->setEnabled(false);
     progressBar->setValue(0);
     resultLabel->setText(u8"正在计算...");
 
     promisePtr = std::make_unique<std::promise<int>>();
     futurePtr = std::make_unique<std::future<int>>(promisePtr->get_future());
 
-    computeThread = std::make_unique<std::thread>(&QPromise::compute, this, std::move(*promisePtr));           //启动线程
+    const auto level = static_cast<SimdLevel>(kernelCombo->currentData().toInt());
+    computeThread = std::make_unique<std::thread>(&QPromise::compute, this, std::move(*promisePtr), level);           //启动线程
 
     QTimer::singleShot(50, this, &QPromise::checkResult);
 }
@@ -130,9 +143,12 @@ void QPromise::checkResult()
     std::future_status status = futurePtr->wait_for(std::chrono::milliseconds(50));
     if (status == std::future_status::ready) {
         int result = futurePtr->get();
-        resultLabel->setText(QString(u8"计算结果: %1").arg(result));
+        resultLabel->setText(QString(u8"计算结果: %1（%2 内核计算耗时 %3 ms，不含 2 秒演示等待）")
+                             .arg(result).arg(kernelCombo->currentText())
+                             .arg(computeNs.load() / 1e6, 0, 'f', 1));
         progressBar->setValue(100);
         startButton->setEnabled(true);
+        kernelCombo->setEnabled(true);
         isComputing = false;
 
         if (computeThread && computeThread->joinable()) {
@@ -170,7 +186,8 @@ void QPromise::startComputationSync()
     // 建立 promise/future 并启动后台线程
     promisePtr = std::make_unique<std::promise<int>>();
     futurePtr = std::make_unique<std::future<int>>(promisePtr->get_future());
-    computeThread = std::make_unique<std::thread>(&QPromise::compute, this, std::move(*promisePtr));
+    const auto level = static_cast<SimdLevel>(kernelCombo->currentData().toInt());
+    computeThread = std::make_unique<std::thread>(&QPromise::compute, this, std::move(*promisePtr), level);
 
     // 同步阻塞：直接在主线程等待结果
     int result = futurePtr->get();
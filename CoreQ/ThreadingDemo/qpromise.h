@@ -2,8 +2,10 @@
 #define QPROMISE_H
 
 #include <QtWidgets>
+#include <atomic>
 #include <future>
 #include <thread>
+#include "simdkernels.h"
 
 /**
  * @brief QPromise类 - C++11 std::promise/std::future 异步编程演示
@@ -86,19 +88,21 @@ private:
     /**
      * @brief 后台计算函数
      * @param p promise对象的右值引用，用于设置计算结果
+     * @param level 计算内核（标量或 SIMD）
      * 
      * 在独立线程中执行：
-     * 1. 生成随机数并进行复杂计算
+     * 1. 按块批量生成随机数并用选定的内核计算平方和
      * 2. 定期发送进度更新信号
      * 3. 计算完成后通过promise设置结果
      */
-    void compute(std::promise<int>&& p);
+    void compute(std::promise<int>&& p, SimdLevel level);
 
     // UI控件
     QPushButton *startButton;    ///< 开始计算按钮
     QPushButton *syncButton;     ///< 同步演示按钮（阻塞式获取结果）
     QProgressBar *progressBar;   ///< 进度条，显示计算进度
     QLabel *resultLabel;         ///< 结果标签，显示计算结果或状态
+    QComboBox *kernelCombo;      ///< 计算内核选择（标量/SSE2/AVX2）
     QVBoxLayout *mainLayout;     ///< 主布局管理器
 
     // 异步编程核心对象
@@ -108,6 +112,7 @@ private:
     
     QTimer *progressTimer;       ///< 定时器，用于定期检查计算状态（当前未使用）
     bool isComputing;           ///< 计算状态标志，防止重复启动计算
+    std::atomic<qint64> computeNs; ///< 最近一次计算的耗时（纳秒，不含演示用的等待）
 };
 
 #endif // QPROMISE_H
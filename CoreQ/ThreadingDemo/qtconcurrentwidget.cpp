@@ -1,6 +1,7 @@
 #include "qtconcurrentwidget.h"
 #include <QDateTime>
 #include <QThread>
+#include <QThreadPool>
 
 // 辅助耗时函数：无返回值
 void simpleFunction(int seconds) {
@@ -19,10 +20,37 @@ int mappedFunction(const int &item) {
     return item * 2;
 }
 
+// SIMD × 多线程对比的输入：每块交给线程池里的一个线程，块内由内核批量计算
+// 随机数由 (种子, 下标) 直接算出，所以分块方式不影响结果
+struct SimdChunk {
+    SimdLevel level;
+    quint32 seed;
+    quint32 begin;
+    quint32 count;
+};
+
+static const quint32 kSimdSeed = 12345;
+static const quint32 kSimdChunkItems = 1u << 18;
+
+double sinCosChunk(const SimdChunk &chunk) {
+    return simdSinCosSum(chunk.level, chunk.seed, chunk.begin, chunk.count);
+}
+
+void addPartialSum(double &total, const double &partial) {
+    total += partial;
+}
+
 QtConcurrentWidget::QtConcurrentWidget(QWidget *parent)
     : QWidget(parent)
+    , m_simdLevel(SimdLevel::Scalar)
+    , m_simdItems(0)
+    , m_simdStep(-1)
+    , m_simdBaselineNs(0)
+    , m_simdCancel(false)
     , m_voidWatcher(new QFutureWatcher<void>(this))
     , m_intWatcher(new QFutureWatcher<int>(this))
+    , m_benchWatcher(new QFutureWatcher<QVector<ExecutorBenchResult>>(this))
+    , m_simdWatcher(new QFutureWatcher<double>(this))
 {
     QVBoxLayout *mainLayout = new QVBoxLayout(this);
 
@@ -41,6 +69,72 @@ QtConcurrentWidget::QtConcurrentWidget(QWidget *parent)
     btnLayout->addWidget(m_btnProgressRun);
     btnLayout->addWidget(m_btnCancel);
 
+    // 执行器对比：递归拆分出大量很小的任务，QThreadPool 的单一共享队列在这里成为瓶颈
+    QGroupBox *grpBench = new QGroupBox("执行器对比：细粒度递归任务 (QThreadPool vs 工作窃取池)", this);
+    QHBoxLayout *benchLayout = new QHBoxLayout(grpBench);
+    m_comboWorkload = new QComboBox(this);
+    m_comboWorkload->addItem("并行 fib");
+    m_comboWorkload->addItem("并行快速排序");
+    benchLayout->addWidget(m_comboWorkload);
+    benchLayout->addWidget(new QLabel("规模:", this));
+    m_spinBenchSize = new QSpinBox(this);
+    m_spinBenchSize->setRange(10, 40);
+    m_spinBenchSize->setValue(30);
+    benchLayout->addWidget(m_spinBenchSize);
+    benchLayout->addWidget(new QLabel("串行阈值:", this));
+    m_spinBenchCutoff = new QSpinBox(this);
+    m_spinBenchCutoff->setRange(1, 1000000);
+    m_spinBenchCutoff->setValue(12);
+    m_spinBenchCutoff->setToolTip("低于它就不再拆分；越小任务越多、越细");
+    benchLayout->addWidget(m_spinBenchCutoff);
+    benchLayout->addWidget(new QLabel("线程数:", this));
+    m_spinBenchThreads = new QSpinBox(this);
+    m_spinBenchThreads->setRange(1, 256);
+    m_spinBenchThreads->setValue(qMax(1, QThread::idealThreadCount()));
+    benchLayout->addWidget(m_spinBenchThreads);
+    m_btnBenchRun = new QPushButton("运行对比", this);
+    benchLayout->addWidget(m_btnBenchRun);
+    // 两种任务的规模和阈值含义不同，切换时换成各自合适的默认值
+    connect(m_comboWorkload, QOverload<int>::of(&QComboBox::currentIndexChanged), this, [this](int index) {
+        if (index == 0) {
+            m_spinBenchSize->setRange(10, 40);
+            m_spinBenchSize->setValue(30);
+            m_spinBenchSize->setSuffix("");
+            m_spinBenchCutoff->setValue(12);
+        } else {
+            m_spinBenchSize->setRange(10, 100000);
+            m_spinBenchSize->setValue(4000);
+            m_spinBenchSize->setSuffix(" 千项");
+            m_spinBenchCutoff->setValue(2048);
+        }
+    });
+
+    // SIMD × 多线程：内核的向量化加速和线程池的并行加速相乘，四种组合放在一起比较
+    QGroupBox *grpSimd = new QGroupBox("SIMD × 多线程：Σ sin(u1)·cos(u2) (标量/SIMD × 单线程/mappedReduced)", this);
+    QHBoxLayout *simdLayout = new QHBoxLayout(grpSimd);
+    simdLayout->addWidget(new QLabel("数据量:", this));
+    m_spinSimdMillions = new QSpinBox(this);
+    m_spinSimdMillions->setRange(1, 4000);
+    m_spinSimdMillions->setValue(32);
+    m_spinSimdMillions->setSuffix(" 百万项");
+    simdLayout->addWidget(m_spinSimdMillions);
+    simdLayout->addWidget(new QLabel("SIMD 内核:", this));
+    m_comboSimdKernel = new QComboBox(this);
+    for (SimdLevel level : simdAvailableLevels()) {
+        if (level != SimdLevel::Scalar) {
+            m_comboSimdKernel->addItem(simdLevelName(level), static_cast<int>(level));
+        }
+    }
+    m_comboSimdKernel->setCurrentIndex(m_comboSimdKernel->count() - 1);
+    simdLayout->addWidget(m_comboSimdKernel);
+    m_btnSimdRun = new QPushButton("运行对比", this);
+    if (m_comboSimdKernel->count() == 0) {
+        m_btnSimdRun->setEnabled(false);
+        m_btnSimdRun->setToolTip("本机没有可用的 SIMD 内核");
+    }
+    simdLayout->addWidget(m_btnSimdRun);
+    simdLayout->addStretch();
+
     // 状态显示
     m_progressBar = new QProgressBar(this);
     m_progressBar->setRange(0, 100);
@@ -54,6 +148,8 @@ QtConcurrentWidget::QtConcurrentWidget(QWidget *parent)
     QPushButton *btnClear = new QPushButton("清空日志", this);
 
     mainLayout->addWidget(grpControls);
+    mainLayout->addWidget(grpBench);
+    mainLayout->addWidget(grpSimd);
     mainLayout->addWidget(new QLabel("任务进度:", this));
     mainLayout->addWidget(m_progressBar);
     mainLayout->addWidget(m_statusLabel);
@@ -67,6 +163,13 @@ QtConcurrentWidget::QtConcurrentWidget(QWidget *parent)
     connect(m_btnProgressRun, &QPushButton::clicked, this, &QtConcurrentWidget::runTaskWithProgress);
     connect(m_btnCancel, &QPushButton::clicked, this, &QtConcurrentWidget::cancelTask);
     connect(btnClear, &QPushButton::clicked, this, &QtConcurrentWidget::clearLog);
+    connect(m_btnBenchRun, &QPushButton::clicked, this, &QtConcurrentWidget::runExecutorComparison);
+    connect(m_benchWatcher, &QFutureWatcher<QVector<ExecutorBenchResult>>::finished,
+            this, &QtConcurrentWidget::onExecutorComparisonFinished);
+    connect(m_btnSimdRun, &QPushButton::clicked, this, &QtConcurrentWidget::runSimdComparison);
+    connect(m_simdWatcher, &QFutureWatcher<double>::finished, this, &QtConcurrentWidget::onSimdStepFinished);
+    connect(m_simdWatcher, &QFutureWatcher<double>::progressRangeChanged, m_progressBar, &QProgressBar::setRange);
+    connect(m_simdWatcher, &QFutureWatcher<double>::progressValueChanged, m_progressBar, &QProgressBar::setValue);
 
     // 连接 Watcher 信号
     connect(m_voidWatcher, &QFutureWatcher<void>::finished, this, &QtConcurrentWidget::onTaskFinished);
@@ -92,6 +195,13 @@ QtConcurrentWidget::~QtConcurrentWidget()
         m_intWatcher->cancel();
         m_intWatcher->waitForFinished();
     }
+    // 对比不可取消，等它跑完（它用的线程池在函数内部创建和销毁）
+    m_benchWatcher->waitForFinished();
+    // 单线程的两步是 run()，靠 m_simdCancel 在块之间退出；mappedReduced 的两步取消后尽快结束
+    m_simdStep = -1;
+    m_simdCancel.store(true, std::memory_order_relaxed);
+    m_simdWatcher->cancel();
+    m_simdWatcher->waitForFinished();
 }
 
 void QtConcurrentWidget::runSimpleTask()
@@ -152,6 +262,115 @@ void QtConcurrentWidget::runTaskWithProgress()
     m_intWatcher->setFuture(future);
 }
 
+/*
+ * 执行器对比：在后台线程里依次跑 串行 / QThreadPool / 工作窃取池，每种取 3 次中最快的一次
+ * 两个线程池都是新建的、线程数相同；QThreadPool 的等待方用 tryTake() 收回未开始的子任务自己做
+ */
+void QtConcurrentWidget::runExecutorComparison()
+{
+    ExecutorBenchConfig config;
+    config.workload = m_comboWorkload->currentIndex() == 0 ? ExecutorWorkload::Fibonacci : ExecutorWorkload::QuickSort;
+    config.size = m_spinBenchSize->value();
+    config.cutoff = m_spinBenchCutoff->value();
+    config.threads = m_spinBenchThreads->value();
+    logMessage(QString("执行器对比：%1，规模 %2，串行阈值 %3，%4 线程...")
+               .arg(m_comboWorkload->currentText()).arg(config.size).arg(config.cutoff).arg(config.threads));
+    m_btnBenchRun->setEnabled(false);
+    m_statusLabel->setText("正在运行执行器对比...");
+    m_benchWatcher->setFuture(QtConcurrent::run(runExecutorBenchmark, config));
+}
+
+void QtConcurrentWidget::onExecutorComparisonFinished()
+{
+    const QVector<ExecutorBenchResult> results = m_benchWatcher->result();
+    const quint64 serialNs = results.isEmpty() ? 0 : results.first().bestNs;
+    for (const ExecutorBenchResult &r : results) {
+        const double speedup = r.bestNs > 0 ? double(serialNs) / r.bestNs : 0.0;
+        logMessage(QString("  %1 (%2 线程)：%3 ms，加速比 %4×，%5 个子任务，平均每个占用线程 %6 ns%7%8")
+                   .arg(r.executor).arg(r.threads).arg(r.bestNs / 1e6, 0, 'f', 2).arg(speedup, 0, 'f', 2)
+                   .arg(r.forks).arg(r.forks > 0 ? double(r.bestNs) * r.threads / r.forks : 0.0, 0, 'f', 0)
+                   .arg(r.correct ? QString() : QString("，结果错误！"))
+                   .arg(r.detail.isEmpty() ? QString() : QString("；") + r.detail));
+    }
+    m_btnBenchRun->setEnabled(true);
+    m_statusLabel->setText("就绪");
+}
+
+/*
+ * SIMD × 多线程：同一批输入依次跑 标量×1、SIMD×1、标量×N、SIMD×N
+ * ×1 用 QtConcurrent::run 在一个线程里按块依次算完整个范围（块之间检查取消标志，关闭窗口时不必等它跑完）；
+ * ×N 把范围切成同样的块交给 QtConcurrent::mappedReduced，
+ * 用全局线程池的全部线程并行计算，按块顺序归约（结果可复现）。一步完成后再启动下一步，互不抢占 CPU。
+ */
+void QtConcurrentWidget::runSimdComparison()
+{
+    m_simdLevel = static_cast<SimdLevel>(m_comboSimdKernel->currentData().toInt());
+    m_simdItems = static_cast<quint32>(m_spinSimdMillions->value()) * 1000000u;
+    m_simdStep = 0;
+    m_simdBaselineNs = 0;
+    m_simdCancel.store(false, std::memory_order_relaxed);
+    logMessage(QString("SIMD × 多线程：%1 百万项，SIMD 内核 %2，线程池 %3 线程，每块 %4 项...")
+               .arg(m_spinSimdMillions->value()).arg(simdLevelName(m_simdLevel))
+               .arg(QThreadPool::globalInstance()->maxThreadCount()).arg(kSimdChunkItems));
+    m_btnSimdRun->setEnabled(false);
+    m_statusLabel->setText("正在运行 SIMD × 多线程对比...");
+    startSimdStep();
+}
+
+void QtConcurrentWidget::startSimdStep()
+{
+    const SimdLevel level = m_simdStep % 2 == 0 ? SimdLevel::Scalar : m_simdLevel;
+    const quint32 items = m_simdItems;
+    m_simdTimer.start();
+    if (m_simdStep < 2) {
+        m_progressBar->setRange(0, 0);
+        std::atomic<bool> *cancel = &m_simdCancel; // 析构函数会等这一步结束，指针在此期间有效
+        m_simdWatcher->setFuture(QtConcurrent::run([level, items, cancel] {
+            double sum = 0.0;
+            for (quint32 begin = 0; begin < items && !cancel->load(std::memory_order_relaxed);
+                 begin += qMin(kSimdChunkItems, items - begin)) {
+                sum += simdSinCosSum(level, kSimdSeed, begin, qMin(kSimdChunkItems, items - begin));
+            }
+            return sum;
+        }));
+        return;
+    }
+
+    QVector<SimdChunk> chunks;
+    for (quint32 begin = 0; begin < items; begin += qMin(kSimdChunkItems, items - begin)) {
+        chunks.append({level, kSimdSeed, begin, qMin(kSimdChunkItems, items - begin)});
+    }
+    m_simdWatcher->setFuture(QtConcurrent::mappedReduced(chunks, sinCosChunk, addPartialSum,
+                                                         QtConcurrent::OrderedReduce | QtConcurrent::SequentialReduce));
+}
+
+void QtConcurrentWidget::onSimdStepFinished()
+{
+    if (m_simdStep < 0 || m_simdWatcher->isCanceled()) {
+        return;
+    }
+    const qint64 ns = m_simdTimer.nsecsElapsed();
+    if (m_simdStep == 0) {
+        m_simdBaselineNs = ns;
+    }
+    const SimdLevel level = m_simdStep % 2 == 0 ? SimdLevel::Scalar : m_simdLevel;
+    const int threads = m_simdStep < 2 ? 1 : QThreadPool::globalInstance()->maxThreadCount();
+    logMessage(QString("  %1 × %2 线程：%3 ms，加速比 %4×，结果 %5")
+               .arg(simdLevelName(level)).arg(threads).arg(ns / 1e6, 0, 'f', 2)
+               .arg(ns > 0 ? double(m_simdBaselineNs) / ns : 0.0, 0, 'f', 2)
+               .arg(m_simdWatcher->result(), 0, 'f', 4));
+
+    if (++m_simdStep < 4) {
+        startSimdStep();
+        return;
+    }
+    m_simdStep = -1;
+    m_progressBar->setRange(0, 100);
+    m_progressBar->setValue(0);
+    m_btnSimdRun->setEnabled(true);
+    m_statusLabel->setText("就绪");
+}
+
 void QtConcurrentWidget::onTaskFinished()
 {
     // 判断是哪个 Watcher 触发的
@@ -11,6 +11,12 @@
 #include <QTextEdit>
 #include <QVBoxLayout>
 #include <QGroupBox>
+#include <QComboBox>
+#include <QSpinBox>
+#include <QElapsedTimer>
+#include <atomic>
+#include "executorbenchmark.h"
+#include "simdkernels.h"
 
 // ==========================================
 // QtConcurrent 演示窗口
@@ -26,6 +32,10 @@ private slots:
     void runSimpleTask();
     void runTaskWithResult();
     void runTaskWithProgress();
+    void runExecutorComparison();
+    void onExecutorComparisonFinished();
+    void runSimdComparison();
+    void onSimdStepFinished();
     
     // FutureWatcher 槽函数
     void onTaskFinished();
@@ -38,6 +48,7 @@ private slots:
 
 private:
     void logMessage(const QString &msg);
+    void startSimdStep();
 
 private:
     // UI Controls
@@ -49,10 +60,30 @@ private:
     QTextEdit *m_logDisplay;
     QLabel *m_statusLabel;
 
+    // 执行器对比：同一个细粒度递归任务分别交给 QThreadPool 和工作窃取池
+    QComboBox *m_comboWorkload;
+    QSpinBox *m_spinBenchSize;
+    QSpinBox *m_spinBenchCutoff;
+    QSpinBox *m_spinBenchThreads;
+    QPushButton *m_btnBenchRun;
+
+    // SIMD × 多线程：同一个数值 map 依次用 标量/SIMD 内核 × 单线程/QtConcurrent::mappedReduced 跑四遍
+    QSpinBox *m_spinSimdMillions;
+    QComboBox *m_comboSimdKernel;
+    QPushButton *m_btnSimdRun;
+    QElapsedTimer m_simdTimer;
+    SimdLevel m_simdLevel;
+    quint32 m_simdItems;
+    int m_simdStep;          // 0..3 为正在跑的配置，-1 表示空闲
+    qint64 m_simdBaselineNs; // 标量 × 1 线程的耗时，作为加速比的基准
+    std::atomic<bool> m_simdCancel; // ×1 的两步是 run()，不能靠 QFuture 取消，由这个标志在块之间检查
+
     // Watcher 用于监控异步任务
     // 注意：这里使用void类型作为通用演示，实际使用时应根据run的返回值指定类型
     QFutureWatcher<void> *m_voidWatcher;
     QFutureWatcher<int> *m_intWatcher; // 用于有返回值的任务
+    QFutureWatcher<QVector<ExecutorBenchResult>> *m_benchWatcher;
+    QFutureWatcher<double> *m_simdWatcher;
 };
 
 #endif // QTCONCURRENTWIDGET_H
@@ -1,6 +1,25 @@
 #include "qtparallelmapwidget.h"
 #include <QDateTime>
 #include <QGroupBox>
+#include <QThread>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+// 每项的计算：对 x + 1 做 iterations 次牛顿迭代求平方根，纯 CPU、结果确定，单线程和并行的输出逐位相同
+float mapElement(float x, int iterations)
+{
+    const float a = x + 1.0f;
+    float v = a;
+    for (int i = 0; i < iterations; ++i) {
+        v = 0.5f * (v + a / v);
+    }
+    return v;
+}
+
+} // namespace
 
 QtParallelMapWidget::QtParallelMapWidget(QWidget *parent)
     : QWidget(parent)
@@ -8,6 +27,12 @@ QtParallelMapWidget::QtParallelMapWidget(QWidget *parent)
     setupUi();
 }
 
+QtParallelMapWidget::~QtParallelMapWidget()
+{
+    // ParallelMapJob 析构时取消并等待工作线程
+    m_job.reset();
+}
+
 void QtParallelMapWidget::setupUi()
 {
     QVBoxLayout *mainLayout = new QVBoxLayout(this);
@@ -25,10 +50,67 @@ void QtParallelMapWidget::setupUi()
     topLayout->addWidget(m_btnCancel);
     mainLayout->addLayout(topLayout);
 
-    // 2. 进度条
+    // 参数
+    QHBoxLayout *dataLayout = new QHBoxLayout();
+    dataLayout->addWidget(new QLabel("数据量 (百万项):", this));
+    m_spinMillions = new QSpinBox(this);
+    m_spinMillions->setRange(1, 50);
+    m_spinMillions->setValue(10);
+    dataLayout->addWidget(m_spinMillions);
+    dataLayout->addWidget(new QLabel("每项迭代次数:", this));
+    m_spinIterations = new QSpinBox(this);
+    m_spinIterations->setRange(1, 200);
+    m_spinIterations->setValue(16);
+    m_spinIterations->setToolTip("每项的计算量；很小时调度开销占比高，块太小会明显拖慢");
+    dataLayout->addWidget(m_spinIterations);
+    m_chkUneven = new QCheckBox("负载不均匀（末尾 1/8 代价 ×8）", this);
+    m_chkUneven->setToolTip("固定大块时最后几块落在少数线程上，其他线程空等；自适应分块在末尾自动变小");
+    dataLayout->addWidget(m_chkUneven);
+    dataLayout->addStretch();
+    mainLayout->addLayout(dataLayout);
+
+    QHBoxLayout *chunkLayout = new QHBoxLayout();
+    chunkLayout->addWidget(new QLabel("线程数:", this));
+    m_spinThreads = new QSpinBox(this);
+    m_spinThreads->setRange(1, 256);
+    m_spinThreads->setValue(qMax(1, QThread::idealThreadCount()));
+    chunkLayout->addWidget(m_spinThreads);
+    chunkLayout->addWidget(new QLabel("分块:", this));
+    m_comboChunk = new QComboBox(this);
+    m_comboChunk->addItem("自适应（每块约 200 µs）");
+    m_comboChunk->addItem("固定大小");
+    chunkLayout->addWidget(m_comboChunk);
+    m_spinChunk = new QSpinBox(this);
+    m_spinChunk->setRange(1, 50000000);
+    m_spinChunk->setValue(4096);
+    m_spinChunk->setSuffix(" 项/块");
+    m_spinChunk->setEnabled(false);
+    chunkLayout->addWidget(m_spinChunk);
+    connect(m_comboChunk, QOverload<int>::of(&QComboBox::currentIndexChanged), this, [this](int index) {
+        m_spinChunk->setEnabled(index == 1);
+    });
+    m_chkBaseline = new QCheckBox("先跑单线程基线", this);
+    m_chkBaseline->setChecked(true);
+    m_chkBaseline->setToolTip("同一份数据和计算量只测一次；加速比 = 单线程耗时 / 并行耗时");
+    chunkLayout->addWidget(m_chkBaseline);
+    chunkLayout->addWidget(new QLabel("执行器:", this));
+    m_comboExecutor = new QComboBox(this);
+    m_comboExecutor->addItem("独立线程");
+    m_comboExecutor->addItem("QThreadPool 全局线程池");
+    m_comboExecutor->addItem("工作窃取池");
+    m_comboExecutor->setToolTip("取块循环跑在哪里；线程池的线程数是 idealThreadCount()，线程数设得更大时多出来的循环排队");
+    chunkLayout->addWidget(m_comboExecutor);
+    chunkLayout->addStretch();
+    mainLayout->addLayout(chunkLayout);
+
+    // 2. 进度条：定时读取作业的原子计数，不按项发信号
     m_progressBar = new QProgressBar(this);
+    m_progressBar->setRange(0, 1000);
     m_progressBar->setValue(0);
+    m_progressBar->setFormat("%p%");
     mainLayout->addWidget(m_progressBar);
+    m_lblRate = new QLabel(this);
+    mainLayout->addWidget(m_lblRate);
 
     // 3. 结果显示
     QGroupBox *grpResults = new QGroupBox("处理结果", this);
@@ -43,35 +125,214 @@ void QtParallelMapWidget::setupUi()
     m_logViewer->setReadOnly(true);
     mainLayout->addWidget(m_logViewer);
 
+    m_progressTimer = new QTimer(this);
+    m_progressTimer->setInterval(100);
+
     connect(m_btnLoadData, &QPushButton::clicked, this, &QtParallelMapWidget::onLoadData);
     connect(m_btnProcess, &QPushButton::clicked, this, &QtParallelMapWidget::onProcessClicked);
     connect(m_btnCancel, &QPushButton::clicked, this, &QtParallelMapWidget::onCancelClicked);
+    connect(m_progressTimer, &QTimer::timeout, this, &QtParallelMapWidget::updateProgress);
+}
+
+void QtParallelMapWidget::setConfigEnabled(bool enabled)
+{
+    m_btnLoadData->setEnabled(enabled);
+    m_btnProcess->setEnabled(enabled && m_input);
+    m_spinMillions->setEnabled(enabled);
+    m_spinIterations->setEnabled(enabled);
+    m_chkUneven->setEnabled(enabled);
+    m_spinThreads->setEnabled(enabled);
+    m_comboChunk->setEnabled(enabled);
+    m_spinChunk->setEnabled(enabled && m_comboChunk->currentIndex() == 1);
+    m_chkBaseline->setEnabled(enabled);
+    m_comboExecutor->setEnabled(enabled);
+}
+
+TaskExecutor *QtParallelMapWidget::selectedExecutor()
+{
+    switch (m_comboExecutor->currentIndex()) {
+    case 1:
+        if (!m_qtExecutor) {
+            m_qtExecutor.reset(new QThreadPoolExecutor());
+        }
+        return m_qtExecutor.get();
+    case 2:
+        if (!m_stealingPool) {
+            m_stealingPool.reset(new WorkStealingPool());
+        }
+        return m_stealingPool.get();
+    default:
+        return nullptr;
+    }
 }
 
 void QtParallelMapWidget::onLoadData()
 {
     m_listResults->clear();
-    logMessage("生成了 100 个待处理项...");
-    // TODO: 填充一个 QList<int> 或 QList<Image> 数据
+    const std::size_t count = static_cast<std::size_t>(m_spinMillions->value()) * 1000000;
+    auto input = std::make_shared<std::vector<float>>(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        (*input)[i] = static_cast<float>(i % 10007) * 0.5f;
+    }
+    m_input = input;
+    m_output = std::make_shared<std::vector<float>>(count);
+    m_baseline = Baseline();
+    logMessage(QString("生成了 %1 个待处理项（%2 MB）").arg(count).arg(count * sizeof(float) * 2 / (1024 * 1024)));
     m_btnProcess->setEnabled(true);
 }
 
 void QtParallelMapWidget::onProcessClicked()
 {
-    logMessage("开始并行处理...");
-    m_btnProcess->setEnabled(false);
+    if (!m_input) {
+        return;
+    }
     m_btnCancel->setEnabled(true);
-    m_btnLoadData->setEnabled(false);
+    setConfigEnabled(false);
+    const bool needBaseline = m_chkBaseline->isChecked()
+        && !(m_baseline.valid && m_baseline.iterations == m_spinIterations->value()
+             && m_baseline.uneven == m_chkUneven->isChecked());
+    startJob(needBaseline ? Phase::Baseline : Phase::Parallel);
+}
+
+/*
+ * 按当前参数启动一轮：基线固定 1 个线程、自适应分块（块足够大，调度开销可以忽略），
+ * 并行轮按界面上的线程数和分块方式
+ */
+void QtParallelMapWidget::startJob(Phase phase)
+{
+    const int iterations = m_spinIterations->value();
+    const bool uneven = m_chkUneven->isChecked();
+    ParallelMapOptions options;
+    if (phase == Phase::Baseline) {
+        options.threads = 1;
+    } else {
+        options.threads = m_spinThreads->value();
+        options.adaptive = m_comboChunk->currentIndex() == 0;
+        options.fixedChunk = static_cast<std::size_t>(m_spinChunk->value());
+        options.executor = selectedExecutor();
+    }
+
+    const std::size_t count = m_input->size();
+    const std::size_t heavyBegin = count - count / 8;
+    // 基线写自己的输出；并行轮写之前先填 NaN，漏写的项核对时一定不相等，不会沿用上一轮的值
+    std::shared_ptr<std::vector<float>> output;
+    if (phase == Phase::Baseline) {
+        m_baseline.output = std::make_shared<std::vector<float>>(count);
+        output = m_baseline.output;
+    } else {
+        std::fill(m_output->begin(), m_output->end(), std::numeric_limits<float>::quiet_NaN());
+        output = m_output;
+    }
+    auto kernel = [input = m_input, output, iterations, uneven, heavyBegin](std::size_t begin, std::size_t end) {
+        const float *in = input->data();
+        float *out = output->data();
+        for (std::size_t i = begin; i < end; ++i) {
+            out[i] = mapElement(in[i], uneven && i >= heavyBegin ? iterations * 8 : iterations);
+        }
+    };
+
+    m_phase = phase;
+    m_job.reset(new ParallelMapJob(count, kernel, options));
+    logMessage(phase == Phase::Baseline
+               ? QString("单线程基线：%1 项...").arg(count)
+               : QString("开始并行处理：%1 项，%2 个线程，%3，%4...").arg(count).arg(m_job->threads())
+                     .arg(options.adaptive ? QString("自适应分块") : QString("固定 %1 项/块").arg(options.fixedChunk))
+                     .arg(m_comboExecutor->currentText()));
     m_progressBar->setValue(0);
-    
-    // TODO: 使用 QtConcurrent::map 或 mapped
-    // TODO: 使用 QFutureWatcher 监控进度 (progressValueChanged) 和完成状态 (finished)
+    m_job->start();
+    m_progressTimer->start();
 }
 
 void QtParallelMapWidget::onCancelClicked()
 {
-    logMessage("尝试取消任务...");
-    // TODO: 调用 watcher.cancel() 或 future.cancel()
+    if (!m_job) {
+        return;
+    }
+    logMessage("尝试取消任务：正在执行的块做完后各线程退出...");
+    m_btnCancel->setEnabled(false);
+    m_job->cancel();
+}
+
+void QtParallelMapWidget::updateProgress()
+{
+    if (!m_job) {
+        return;
+    }
+    const quint64 processed = m_job->processed();
+    const double seconds = qMax(1e-9, m_job->elapsedNs() / 1e9);
+    m_progressBar->setValue(static_cast<int>(processed * 1000 / qMax<std::size_t>(1, m_job->count())));
+    m_lblRate->setText(QString("%1：已处理 %2 / %3 项，%4 M项/秒，已分 %5 块")
+                       .arg(m_phase == Phase::Baseline ? "单线程基线" : "并行")
+                       .arg(processed).arg(m_job->count()).arg(processed / seconds / 1e6, 0, 'f', 1)
+                       .arg(m_job->chunks()));
+    if (m_job->isFinished()) {
+        finishJob();
+    }
+}
+
+// 一轮结束：记录耗时和吞吐；基线跑完接着跑并行轮，并行轮结束后对比加速比并核对结果
+void QtParallelMapWidget::finishJob()
+{
+    m_progressTimer->stop();
+    m_job->wait();
+    const quint64 elapsedNs = m_job->elapsedNs();
+    const quint64 processed = m_job->processed();
+    const bool cancelled = m_job->isCancelled();
+    const double itemsPerSec = processed / qMax(1e-9, elapsedNs / 1e9);
+    const double averageChunk = m_job->chunks() > 0 ? double(processed) / m_job->chunks() : 0.0;
+    const QString summary = QString("%1 ms，%2 M项/秒，%3 块（平均 %4 项，最大 %5 项）")
+        .arg(elapsedNs / 1e6, 0, 'f', 1).arg(itemsPerSec / 1e6, 0, 'f', 1).arg(m_job->chunks())
+        .arg(averageChunk, 0, 'f', 0).arg(m_job->largestChunk());
+    const int threads = m_job->threads();
+    const bool adaptive = m_comboChunk->currentIndex() == 0;
+    m_job.reset();
+
+    if (cancelled) {
+        m_listResults->addItem(QString("%1（已取消，完成 %2 项）：%3")
+                               .arg(m_phase == Phase::Baseline ? "单线程基线" : "并行").arg(processed).arg(summary));
+        logMessage("任务已取消");
+    } else if (m_phase == Phase::Baseline) {
+        m_baseline.valid = true;
+        m_baseline.iterations = m_spinIterations->value();
+        m_baseline.uneven = m_chkUneven->isChecked();
+        m_baseline.elapsedNs = elapsedNs;
+        m_listResults->addItem(QString("单线程基线：%1").arg(summary));
+        startJob(Phase::Parallel);
+        return;
+    } else {
+        QString speedup;
+        if (m_baseline.valid && m_baseline.iterations == m_spinIterations->value()
+            && m_baseline.uneven == m_chkUneven->isChecked()) {
+            const double ratio = double(m_baseline.elapsedNs) / qMax<quint64>(1, elapsedNs);
+            const std::size_t mismatches = countMismatches();
+            speedup = QString("，加速比 %1×（并行效率 %2%），结果%3")
+                .arg(ratio, 0, 'f', 2).arg(100.0 * ratio / threads, 0, 'f', 0)
+                .arg(mismatches == 0 ? QString("与基线逐项一致")
+                                     : QString("有 %1 项与基线不一致！").arg(mismatches));
+        }
+        m_listResults->addItem(QString("并行 %1 线程（%2），%3：%4%5")
+                               .arg(threads).arg(m_comboExecutor->currentText())
+                               .arg(adaptive ? QString("自适应分块") : QString("固定 %1 项/块").arg(m_spinChunk->value()))
+                               .arg(summary, speedup));
+        logMessage("并行处理完成");
+    }
+    m_listResults->scrollToBottom();
+    m_btnCancel->setEnabled(false);
+    setConfigEnabled(true);
+}
+
+// 并行输出与单线程基线逐项比较（计算是确定的，结果应当按位相同）；漏写的项仍是 NaN，也计为不一致
+std::size_t QtParallelMapWidget::countMismatches() const
+{
+    const std::vector<float> &expected = *m_baseline.output;
+    const std::vector<float> &actual = *m_output;
+    std::size_t mismatches = 0;
+    for (std::size_t i = 0; i < actual.size(); ++i) {
+        if (!(actual[i] == expected[i])) {
+            ++mismatches;
+        }
+    }
+    return mismatches;
 }
 
 void QtParallelMapWidget::logMessage(const QString &msg)
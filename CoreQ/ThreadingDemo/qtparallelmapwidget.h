@@ -7,26 +7,75 @@
 #include <QTextEdit>
 #include <QVBoxLayout>
 #include <QHBoxLayout>
+#include <QSpinBox>
+#include <QCheckBox>
+#include <QComboBox>
+#include <QLabel>
+#include <QTimer>
+#include <memory>
+#include <vector>
+#include "parallelmap.h"
+#include "taskexecutor.h"
+#include "workstealingpool.h"
 
 class QtParallelMapWidget : public QWidget
 {
     Q_OBJECT
 public:
     explicit QtParallelMapWidget(QWidget *parent = nullptr);
+    ~QtParallelMapWidget() override;
 
 private slots:
     void onLoadData();
     void onProcessClicked();
     void onCancelClicked();
+    void updateProgress();
 
 private:
+    enum class Phase { Baseline, Parallel };
+
     void setupUi();
     void logMessage(const QString &msg);
+    void startJob(Phase phase);
+    void finishJob();
+    void setConfigEnabled(bool enabled);
+    std::size_t countMismatches() const;
+    TaskExecutor *selectedExecutor();
 
     QPushButton *m_btnLoadData;
     QPushButton *m_btnProcess;
     QPushButton *m_btnCancel;
     QProgressBar *m_progressBar;
+    QLabel *m_lblRate;
     QListWidget *m_listResults;
     QTextEdit *m_logViewer;
+
+    // 参数
+    QSpinBox *m_spinMillions;   // 数据量（百万项）
+    QSpinBox *m_spinIterations; // 每项的计算量（迭代次数）
+    QCheckBox *m_chkUneven;     // 末尾 1/8 的元素代价 ×8，演示分块对尾部均衡的影响
+    QSpinBox *m_spinThreads;
+    QComboBox *m_comboChunk;    // 自适应 / 固定大小
+    QSpinBox *m_spinChunk;      // 固定块大小
+    QCheckBox *m_chkBaseline;   // 并行之前先用单线程跑一遍作为加速比的基准
+    QComboBox *m_comboExecutor; // 独立线程 / QThreadPool 全局线程池 / 工作窃取池
+
+    QTimer *m_progressTimer;
+    // 执行器按需创建，必须比作业活得久（声明在 m_job 之前，析构在它之后）
+    std::unique_ptr<QThreadPoolExecutor> m_qtExecutor;
+    std::unique_ptr<WorkStealingPool> m_stealingPool;
+    std::unique_ptr<ParallelMapJob> m_job;
+    Phase m_phase = Phase::Parallel;
+    // 输入输出由工作线程共享，作业持有引用计数，析构顺序不影响正在跑的块
+    std::shared_ptr<std::vector<float>> m_input;
+    std::shared_ptr<std::vector<float>> m_output;
+
+    // 单线程基线：只对同一份数据、同样的计算量有效
+    struct Baseline {
+        bool valid = false;
+        int iterations = 0;
+        bool uneven = false;
+        quint64 elapsedNs = 0;
+        std::shared_ptr<std::vector<float>> output; // 基线单独写一份输出，并行轮逐项和它核对
+    } m_baseline;
 };
@@ -1,5 +1,41 @@
 #include "qtpipelinewidget.h"
 #include <QDateTime>
+#include <QColor>
+#include <QFile>
+#include <QFileDialog>
+#include <QHeaderView>
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+namespace {
+
+constexpr int kSamplesPerItem = 256;
+
+// 模拟 CPU 密集的工作：忙等 us 微秒（不 sleep，占满一个核）
+void burnCpu(int us)
+{
+    if (us <= 0) {
+        return;
+    }
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(us);
+    while (std::chrono::steady_clock::now() < deadline) {
+    }
+}
+
+QString formatUs(quint64 ns)
+{
+    return QString::number(ns / 1000.0, 'f', 1);
+}
+
+// 忙碌比例 -> 背景色：空闲为绿色，接近 100% 为红色（瓶颈）
+QString busyStyle(double ratio)
+{
+    const int hue = static_cast<int>(120 * (1.0 - qBound(0.0, ratio, 1.0)));
+    return QString("background-color: %1;").arg(QColor::fromHsv(hue, 90, 235).name());
+}
+
+} // namespace
 
 QtPipelineWidget::QtPipelineWidget(QWidget *parent)
     : QWidget(parent)
@@ -7,6 +43,15 @@ QtPipelineWidget::QtPipelineWidget(QWidget *parent)
     setupUi();
 }
 
+QtPipelineWidget::~QtPipelineWidget()
+{
+    // 先关闭缓冲池，阻塞在 acquire() 上的采集线程才能退出；PipelineEngine 析构时会取消并等待所有工作线程
+    if (m_pool) {
+        m_pool->close();
+    }
+    m_engine.reset();
+}
+
 void QtPipelineWidget::setupUi()
 {
     QVBoxLayout *mainLayout = new QVBoxLayout(this);
@@ -14,20 +59,134 @@ void QtPipelineWidget::setupUi()
     QHBoxLayout *btnLayout = new QHBoxLayout();
     m_btnStart = new QPushButton("启动流水线", this);
     m_btnStop = new QPushButton("停止流水线", this);
+    m_btnStop->setToolTip("数据源停止产出，队列中已有的数据处理完后退出");
+    m_btnCancel = new QPushButton("取消", this);
+    m_btnCancel->setToolTip("立即关闭所有队列，丢弃未处理的数据");
     m_btnStop->setEnabled(false);
+    m_btnCancel->setEnabled(false);
     btnLayout->addWidget(m_btnStart);
     btnLayout->addWidget(m_btnStop);
+    btnLayout->addWidget(m_btnCancel);
+    btnLayout->addSpacing(20);
+    m_chkTrace = new QCheckBox("记录逐项追踪", this);
+    m_chkTrace->setToolTip("把每一项在每个阶段的排队和服务区间记进有界缓冲区（只保留最近的），可导出到 chrome://tracing / Perfetto");
+    btnLayout->addWidget(m_chkTrace);
+    m_btnExportTrace = new QPushButton("导出追踪", this);
+    m_btnExportTrace->setEnabled(false);
+    btnLayout->addWidget(m_btnExportTrace);
     mainLayout->addLayout(btnLayout);
 
+    // 参数
+    QHBoxLayout *cfgLayout = new QHBoxLayout();
+    auto addSpin = [this, cfgLayout](const QString &label, int min, int max, int value, const QString &tip) {
+        cfgLayout->addWidget(new QLabel(label, this));
+        QSpinBox *spin = new QSpinBox(this);
+        spin->setRange(min, max);
+        spin->setValue(value);
+        spin->setToolTip(tip);
+        cfgLayout->addWidget(spin);
+        return spin;
+    };
+    m_spinRate = addSpin("采集速率(项/秒):", 0, 1000000, 2000, "0 表示不限速，由下游背压决定");
+    m_spinProcessUs = addSpin("处理每项(µs):", 0, 100000, 100, "处理阶段每项的 CPU 时间");
+    m_spinCallUs = addSpin("处理每次调用(µs):", 0, 100000, 400, "处理阶段每次调用的固定开销，与批里有几项无关");
+    m_spinStoreUs = addSpin("存储耗时(µs):", 0, 100000, 100, "存储阶段每项的 CPU 时间");
+    m_spinCapacity = addSpin("队列容量:", 1, 100000, 64, "阶段之间每条队列的容量");
+    cfgLayout->addStretch();
+    mainLayout->addLayout(cfgLayout);
+
+    // 每条边的攒批参数：下游一次最多取 B 项，凑不满时最多等 T 微秒
+    QHBoxLayout *batchLayout = new QHBoxLayout();
+    const char *edgeNames[] = {"采集→处理", "处理→存储"};
+    for (int i = 0; i < 2; ++i) {
+        batchLayout->addWidget(new QLabel(QString("%1 批大小:").arg(edgeNames[i]), this));
+        m_spinBatchItems[i] = new QSpinBox(this);
+        m_spinBatchItems[i]->setRange(1, 4096);
+        m_spinBatchItems[i]->setValue(1);
+        m_spinBatchItems[i]->setToolTip("1 表示逐项处理");
+        batchLayout->addWidget(m_spinBatchItems[i]);
+        batchLayout->addWidget(new QLabel("等待(µs):", this));
+        m_spinBatchLingerUs[i] = new QSpinBox(this);
+        m_spinBatchLingerUs[i]->setRange(0, 1000000);
+        m_spinBatchLingerUs[i]->setValue(0);
+        m_spinBatchLingerUs[i]->setToolTip("拿到第一项后最多再等多久凑批；0 表示只取已经到达的");
+        batchLayout->addWidget(m_spinBatchLingerUs[i]);
+        batchLayout->addSpacing(20);
+    }
+    batchLayout->addStretch();
+    mainLayout->addLayout(batchLayout);
+
+    // 每个阶段的工作线程数，以及处理阶段输出是否保序
+    QHBoxLayout *workerLayout = new QHBoxLayout();
+    const char *stageNames[] = {"采集线程:", "处理线程:", "存储线程:"};
+    const int defaultWorkers[] = {1, 4, 1};
+    for (int i = 0; i < 3; ++i) {
+        workerLayout->addWidget(new QLabel(stageNames[i], this));
+        m_spinWorkers[i] = new QSpinBox(this);
+        m_spinWorkers[i]->setRange(1, 64);
+        m_spinWorkers[i]->setValue(defaultWorkers[i]);
+        workerLayout->addWidget(m_spinWorkers[i]);
+    }
+    m_spinWorkers[0]->setToolTip("多个采集线程共用一个序号计数器；保序时固定为 1，保证序号按顺序进入处理阶段");
+    m_spinWorkers[2]->setToolTip("存储线程多于 1 个时，存储本身就是并行的，不再检查顺序");
+    m_chkOrdered = new QCheckBox("存储按原始顺序接收", this);
+    m_chkOrdered->setChecked(true);
+    m_chkOrdered->setToolTip("处理阶段多线程时完成顺序会被打乱，在处理 -> 存储之间放一个有界重排序缓冲区");
+    workerLayout->addWidget(m_chkOrdered);
+    workerLayout->addWidget(new QLabel("重排序窗口:", this));
+    m_spinReorderWindow = new QSpinBox(this);
+    m_spinReorderWindow->setRange(1, 100000);
+    m_spinReorderWindow->setValue(64);
+    m_spinReorderWindow->setToolTip("最多暂存的项数；后面的项序号超出窗口时处理线程等待");
+    workerLayout->addWidget(m_spinReorderWindow);
+    workerLayout->addStretch();
+    mainLayout->addLayout(workerLayout);
+    connect(m_chkOrdered, &QCheckBox::toggled, this, [this](bool ordered) {
+        m_spinReorderWindow->setEnabled(ordered);
+        m_spinWorkers[0]->setEnabled(!ordered);
+    });
+    m_spinWorkers[0]->setEnabled(!m_chkOrdered->isChecked());
+
+    // 自动伸缩：统计定时器每次刷新时采样一次
+    QHBoxLayout *scaleLayout = new QHBoxLayout();
+    m_chkAutoscale = new QCheckBox("自动伸缩", this);
+    m_chkAutoscale->setToolTip("输入队列积压且线程忙碌时加线程，空闲时减线程；上面的线程数作为初始值");
+    scaleLayout->addWidget(m_chkAutoscale);
+    const char *maxNames[] = {"处理上限:", "存储上限:"};
+    const int defaultMax[] = {8, 4};
+    for (int i = 0; i < 2; ++i) {
+        scaleLayout->addWidget(new QLabel(maxNames[i], this));
+        m_spinMaxWorkers[i] = new QSpinBox(this);
+        m_spinMaxWorkers[i]->setRange(1, 64);
+        m_spinMaxWorkers[i]->setValue(defaultMax[i]);
+        m_spinMaxWorkers[i]->setEnabled(false);
+        scaleLayout->addWidget(m_spinMaxWorkers[i]);
+        connect(m_chkAutoscale, &QCheckBox::toggled, m_spinMaxWorkers[i], &QSpinBox::setEnabled);
+    }
+    scaleLayout->addSpacing(20);
+    m_chkPool = new QCheckBox("使用缓冲池", this);
+    m_chkPool->setChecked(true);
+    m_chkPool->setToolTip("样本缓冲区预先分配，阶段之间只传句柄，存储阶段用完后归还；关闭后每项单独分配");
+    scaleLayout->addWidget(m_chkPool);
+    scaleLayout->addWidget(new QLabel("缓冲区个数:", this));
+    m_spinPoolSize = new QSpinBox(this);
+    m_spinPoolSize->setRange(1, 100000);
+    m_spinPoolSize->setValue(256);
+    m_spinPoolSize->setToolTip("也是流水线中在途数据量的上限：借空时采集阶段等待");
+    scaleLayout->addWidget(m_spinPoolSize);
+    connect(m_chkPool, &QCheckBox::toggled, m_spinPoolSize, &QSpinBox::setEnabled);
+    scaleLayout->addStretch();
+    mainLayout->addLayout(scaleLayout);
+
     // 流水线可视化
     QGroupBox *grpPipeline = new QGroupBox("流水线状态 (Stage A -> Stage B -> Stage C)", this);
     QHBoxLayout *pipeLayout = new QHBoxLayout(grpPipeline);
-    
+
     auto createStageLabel = [this](const QString &text) {
         QLabel *lbl = new QLabel(text, this);
         lbl->setFrameStyle(QFrame::Panel | QFrame::Sunken);
         lbl->setAlignment(Qt::AlignCenter);
-        lbl->setFixedSize(100, 60);
+        lbl->setFixedSize(140, 90);
         lbl->setStyleSheet("background-color: lightgray;");
         return lbl;
     };
@@ -35,13 +194,17 @@ void QtPipelineWidget::setupUi()
     m_lblStage1 = createStageLabel("Stage 1\n(采集)");
     m_lblStage2 = createStageLabel("Stage 2\n(处理)");
     m_lblStage3 = createStageLabel("Stage 3\n(存储)");
+    m_lblQueue12 = new QLabel("-->", this);
+    m_lblQueue23 = new QLabel("-->", this);
+    m_lblQueue12->setAlignment(Qt::AlignCenter);
+    m_lblQueue23->setAlignment(Qt::AlignCenter);
 
     pipeLayout->addWidget(m_lblStage1);
-    pipeLayout->addWidget(new QLabel("-->"));
+    pipeLayout->addWidget(m_lblQueue12);
     pipeLayout->addWidget(m_lblStage2);
-    pipeLayout->addWidget(new QLabel("-->"));
+    pipeLayout->addWidget(m_lblQueue23);
     pipeLayout->addWidget(m_lblStage3);
-    
+
     mainLayout->addWidget(grpPipeline);
 
     // 统计
@@ -49,30 +212,416 @@ void QtPipelineWidget::setupUi()
     statLayout->addWidget(new QLabel("已完成任务数:"));
     m_lblCount = new QLabel("0", this);
     statLayout->addWidget(m_lblCount);
+    statLayout->addSpacing(20);
+    m_lblReorder = new QLabel(this);
+    statLayout->addWidget(m_lblReorder);
+    statLayout->addSpacing(20);
+    m_lblPool = new QLabel(this);
+    statLayout->addWidget(m_lblPool);
     statLayout->addStretch();
     mainLayout->addLayout(statLayout);
 
+    QHBoxLayout *batchStatLayout = new QHBoxLayout();
+    m_lblBatch = new QLabel(this);
+    batchStatLayout->addWidget(m_lblBatch);
+    batchStatLayout->addSpacing(20);
+    m_lblTrace = new QLabel(this);
+    batchStatLayout->addWidget(m_lblTrace);
+    batchStatLayout->addStretch();
+    mainLayout->addLayout(batchStatLayout);
+
+    // 每阶段的排队 vs 服务时间（本统计周期），排队占比最高的阶段前面就是瓶颈
+    m_latencyTable = new QTableWidget(0, 6, this);
+    m_latencyTable->setHorizontalHeaderLabels({"阶段", "排队 p50 (µs)", "排队 p99 (µs)", "服务 p50 (µs)",
+                                               "服务 p99 (µs)", "排队占比"});
+    m_latencyTable->setToolTip("排队：上游完成 -> 本阶段取出；服务：取出 -> 完成（攒批时整批耗时计到每一项上）。\n"
+                               "采集阶段没有输入队列，服务时间包含限速等待和借缓冲区的等待");
+    m_latencyTable->verticalHeader()->setVisible(false);
+    m_latencyTable->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+    m_latencyTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_latencyTable->setMaximumHeight(130);
+    mainLayout->addWidget(m_latencyTable);
+
     m_logViewer = new QTextEdit(this);
     m_logViewer->setReadOnly(true);
     mainLayout->addWidget(m_logViewer);
 
+    m_statsTimer = new QTimer(this);
+    m_statsTimer->setInterval(500);
+
     connect(m_btnStart, &QPushButton::clicked, this, &QtPipelineWidget::onStartClicked);
     connect(m_btnStop, &QPushButton::clicked, this, &QtPipelineWidget::onStopClicked);
+    connect(m_btnCancel, &QPushButton::clicked, this, &QtPipelineWidget::onCancelClicked);
+    connect(m_btnExportTrace, &QPushButton::clicked, this, &QtPipelineWidget::onExportTraceClicked);
+    connect(m_statsTimer, &QTimer::timeout, this, &QtPipelineWidget::updateStats);
 }
 
+void QtPipelineWidget::setConfigEnabled(bool enabled)
+{
+    m_spinRate->setEnabled(enabled);
+    m_spinProcessUs->setEnabled(enabled);
+    m_spinStoreUs->setEnabled(enabled);
+    m_spinCapacity->setEnabled(enabled);
+    m_spinCallUs->setEnabled(enabled);
+    for (int i = 0; i < 2; ++i) {
+        m_spinBatchItems[i]->setEnabled(enabled);
+        m_spinBatchLingerUs[i]->setEnabled(enabled);
+    }
+    m_spinWorkers[0]->setEnabled(enabled && !m_chkOrdered->isChecked());
+    m_spinWorkers[1]->setEnabled(enabled);
+    m_spinWorkers[2]->setEnabled(enabled);
+    m_chkOrdered->setEnabled(enabled);
+    m_spinReorderWindow->setEnabled(enabled && m_chkOrdered->isChecked());
+    m_chkAutoscale->setEnabled(enabled);
+    for (QSpinBox *spin : m_spinMaxWorkers) {
+        spin->setEnabled(enabled && m_chkAutoscale->isChecked());
+    }
+    m_chkPool->setEnabled(enabled);
+    m_spinPoolSize->setEnabled(enabled && m_chkPool->isChecked());
+    m_chkTrace->setEnabled(enabled);
+    m_btnExportTrace->setEnabled(enabled && m_trace != nullptr);
+}
+
+/*
+ * 搭建 采集 -> 处理 -> 存储 三阶段流水线并启动
+ * 阶段函数只捕获参数的副本，不访问任何控件
+ */
 void QtPipelineWidget::onStartClicked()
 {
     logMessage("启动流水线...");
     m_btnStart->setEnabled(false);
     m_btnStop->setEnabled(true);
-    // TODO: 启动3个线程，通过信号槽或线程安全队列传递数据
+    m_btnCancel->setEnabled(true);
+    setConfigEnabled(false);
+
+    const int rate = m_spinRate->value();
+    const int processUs = m_spinProcessUs->value();
+    const int storeUs = m_spinStoreUs->value();
+    const int callUs = m_spinCallUs->value();
+    PipelineBatch batches[2];
+    for (int i = 0; i < 2; ++i) {
+        batches[i].maxItems = static_cast<std::size_t>(m_spinBatchItems[i]->value());
+        batches[i].lingerUs = m_spinBatchLingerUs[i]->value();
+    }
+    const bool ordered = m_chkOrdered->isChecked();
+    // 保序要求序号按顺序进入处理阶段，所以只用一个采集线程
+    const int workers[] = {ordered ? 1 : m_spinWorkers[0]->value(), m_spinWorkers[1]->value(), m_spinWorkers[2]->value()};
+    const bool autoscale = m_chkAutoscale->isChecked();
+    // 初始值超过上限时把上限抬到初始值
+    const int maxWorkers[] = {qMax(workers[1], m_spinMaxWorkers[0]->value()), qMax(workers[2], m_spinMaxWorkers[1]->value())};
+
+    m_engine.reset(new PipelineEngine(static_cast<std::size_t>(m_spinCapacity->value())));
+
+    m_pool = m_chkPool->isChecked()
+        ? BufferPool<float>::create(static_cast<std::size_t>(m_spinPoolSize->value()), kSamplesPerItem)
+        : nullptr;
+    m_itemAllocations = std::make_shared<std::atomic<quint64>>(0);
+    // 上一次运行的追踪到这里才丢弃
+    m_trace = m_chkTrace->isChecked() ? std::make_shared<PipelineTraceBuffer>(1 << 17) : nullptr;
+    m_engine->setTraceBuffer(m_trace);
+
+    // Stage 1 采集：按设定速率产生带序号的样本块（序号从 0 开始连续，保序边依赖这一点）
+    auto seq = std::make_shared<std::atomic<quint64>>(0);
+    const auto begin = std::chrono::steady_clock::now();
+    auto acquired = m_engine->addSource<PipelineItem>("采集", [seq, rate, begin, pool = m_pool,
+                                                             itemAllocations = m_itemAllocations](PipelineItem &item) {
+        // 先拿缓冲区再取序号：池被借空时等待不会占着一个序号
+        // 两条路径用同一种方式计数：样本 vector 的容量变了就是这一项做了一次分配（池自己的分配由池计数）
+        const std::size_t capacityBefore = item.heapSamples.capacity();
+        if (pool) {
+            item.pooled = pool->acquire();
+            if (!item.pooled) {
+                return false; // 池已关闭（取消）
+            }
+        } else {
+            item.heapSamples.resize(kSamplesPerItem);
+        }
+        if (item.heapSamples.capacity() != capacityBefore) {
+            itemAllocations->fetch_add(1, std::memory_order_relaxed);
+        }
+        item.seq = seq->fetch_add(1, std::memory_order_relaxed);
+        if (rate > 0) {
+            std::this_thread::sleep_until(begin + std::chrono::microseconds(item.seq * 1000000 / rate));
+        }
+        float *samples = item.samples();
+        for (int i = 0; i < kSamplesPerItem; ++i) {
+            samples[i] = std::sin(0.01f * static_cast<float>(item.seq + i));
+        }
+        return true;
+    }, workers[0]);
+
+    // Stage 2 处理：每次调用先付一次固定开销，再逐项计算均方根并模拟额外的 CPU 开销；
+    // 每项耗时不同，多线程时完成顺序会乱
+    auto process = [processUs, callUs](std::vector<PipelineItem> &batch, std::vector<PipelineItem> &results) {
+        burnCpu(callUs);
+        for (PipelineItem &item : batch) {
+            const float *samples = item.samples();
+            const std::size_t count = item.sampleCount();
+            double sum = 0.0;
+            for (std::size_t i = 0; i < count; ++i) {
+                sum += double(samples[i]) * samples[i];
+            }
+            item.value = std::sqrt(sum / count);
+            burnCpu(processUs + static_cast<int>(item.seq % 4) * processUs / 4);
+            results.push_back(std::move(item));
+        }
+    };
+    auto processed = ordered
+        ? m_engine->addOrderedBatchStage<PipelineItem>("处理", acquired, process,
+                                                       [](const PipelineItem &item) { return item.seq; }, batches[0],
+                                                       workers[1], static_cast<std::size_t>(m_spinReorderWindow->value()))
+        : m_engine->addBatchStage<PipelineItem>("处理", acquired, process, batches[0], workers[1]);
+
+    // Stage 3 存储：模拟落盘耗时；始终单线程时顺便检查序号是否递增
+    auto inversions = std::make_shared<std::atomic<quint64>>(0);
+    auto lastSeq = std::make_shared<qint64>(-1);
+    const bool checkOrder = workers[2] == 1 && (!autoscale || maxWorkers[1] == 1);
+    m_engine->addBatchSink("存储", processed, [storeUs, inversions, lastSeq, checkOrder](std::vector<PipelineItem> &batch) {
+        for (PipelineItem &item : batch) {
+            if (checkOrder) {
+                if (static_cast<qint64>(item.seq) < *lastSeq) {
+                    inversions->fetch_add(1, std::memory_order_relaxed);
+                }
+                *lastSeq = static_cast<qint64>(item.seq);
+            }
+            burnCpu(storeUs);
+            // 用完立即归还缓冲区，不必等整批处理完
+            item.pooled.reset();
+            item.heapSamples = std::vector<float>();
+        }
+    }, batches[1], workers[2]);
+    m_sinkInversions = checkOrder ? inversions : nullptr;
+
+    if (autoscale) {
+        m_autoscaler.reset(new PipelineAutoscaler({{workers[0], workers[0]}, {1, maxWorkers[0]}, {1, maxWorkers[1]}}));
+    }
+
+    m_lastStats.clear();
+    m_lastStatsNs = 0;
+    m_latencyTable->setRowCount(0);
+    m_traceStageNames = m_engine->stageNames();
+    updateTraceLabel();
+    m_engine->start();
+    m_statsTimer->start();
 }
 
 void QtPipelineWidget::onStopClicked()
 {
-    logMessage("停止流水线...");
+    if (!m_engine) {
+        return;
+    }
+    logMessage("停止流水线：等待队列中的数据处理完...");
+    m_btnStop->setEnabled(false);
+    m_engine->stop();
+}
+
+void QtPipelineWidget::onCancelClicked()
+{
+    if (!m_engine) {
+        return;
+    }
+    logMessage("取消流水线：丢弃未处理的数据");
+    m_btnStop->setEnabled(false);
+    m_btnCancel->setEnabled(false);
+    m_engine->cancel();
+    if (m_pool) {
+        m_pool->close();
+    }
+}
+
+/*
+ * 定时刷新：吞吐与忙碌比例按两次快照的差值计算，忙碌比例 = 忙碌时长 / (间隔 × 工作线程数)
+ */
+void QtPipelineWidget::updateStats()
+{
+    if (!m_engine) {
+        return;
+    }
+    if (m_autoscaler) {
+        for (const PipelineScaleDecision &d : m_autoscaler->sample(*m_engine)) {
+            logMessage(QString("自动伸缩：%1 %2 -> %3 线程（忙碌 %4%，输入队列 %5%）")
+                       .arg(d.name).arg(d.from).arg(d.to)
+                       .arg(qMin(100.0, d.utilization * 100), 0, 'f', 0).arg(d.queueFill * 100, 0, 'f', 0));
+        }
+    }
+    const QVector<PipelineStageStats> now = m_engine->stats();
+    const quint64 nowNs = m_engine->elapsedNs();
+    const double seconds = qMax(1e-9, (nowNs - m_lastStatsNs) / 1e9);
+
+    QLabel *stageLabels[] = {m_lblStage1, m_lblStage2, m_lblStage3};
+    const char *titles[] = {"Stage 1\n(采集)", "Stage 2\n(处理)", "Stage 3\n(存储)"};
+    for (int i = 0; i < now.size() && i < 3; ++i) {
+        const PipelineStageStats &s = now[i];
+        const PipelineStageStats prev = i < m_lastStats.size() ? m_lastStats[i] : PipelineStageStats();
+        const double rate = (s.processed - prev.processed) / seconds;
+        const double busy = s.workers > 0 ? (s.busyNs - prev.busyNs) / (seconds * 1e9 * s.workers) : 0.0;
+        const QString workers = s.workers == s.targetWorkers || s.finished
+            ? QString::number(s.workers) : QString("%1→%2").arg(s.workers).arg(s.targetWorkers);
+        stageLabels[i]->setText(QString("%1 ×%2\n%3 项/秒\n忙碌 %4%")
+                                .arg(titles[i]).arg(workers).arg(rate, 0, 'f', 0)
+                                .arg(qMin(100.0, busy * 100), 0, 'f', 0));
+        stageLabels[i]->setStyleSheet(s.finished ? QString("background-color: lightgray;") : busyStyle(busy));
+    }
+    if (now.size() >= 3) {
+        m_lblQueue12->setText(QString("--> %1/%2 -->").arg(now[1].inputDepth).arg(now[1].inputCapacity));
+        m_lblQueue23->setText(QString("--> %1/%2 -->").arg(now[2].inputDepth).arg(now[2].inputCapacity));
+        m_lblCount->setText(QString::number(now[2].processed));
+
+        const PipelineStageStats &sink = now[2];
+        const QString inversions = m_sinkInversions
+            ? QString("存储收到的序号倒退 %1 次").arg(m_sinkInversions->load(std::memory_order_relaxed))
+            : QString("存储多线程，不检查顺序");
+        if (sink.orderedInput) {
+            const double oooPercent = sink.processed > 0 ? 100.0 * sink.reorderOutOfOrder / sink.processed : 0.0;
+            m_lblReorder->setText(QString("重排序：暂存 %1/%2，峰值 %3，乱序到达 %4 项 (%5%)，窗口满等待 %6 次；%7")
+                                  .arg(sink.inputDepth).arg(sink.inputCapacity).arg(sink.reorderMaxHeld)
+                                  .arg(sink.reorderOutOfOrder).arg(oooPercent, 0, 'f', 1)
+                                  .arg(sink.reorderWindowWaits).arg(inversions));
+        } else {
+            m_lblReorder->setText(QString("未启用重排序；%1").arg(inversions));
+        }
+    }
+    updatePoolLabel();
+    const QVector<PipelineStageLatency> latencies = m_engine->latencies(true);
+    updateBatchLabel(now, latencies);
+    updateLatencyTable(latencies);
+    updateTraceLabel();
+    m_lastStats = now;
+    m_lastStatsNs = nowNs;
+
+    if (m_engine->isFinished()) {
+        finishRun();
+    }
+}
+
+// 所有工作线程都已退出：回收线程、恢复按钮
+void QtPipelineWidget::finishRun()
+{
+    m_statsTimer->stop();
+    m_engine->wait();
+    const QVector<PipelineStageStats> last = m_engine->stats();
+    logMessage(QString("流水线已停止：采集 %1 项，存储 %2 项%3")
+               .arg(last.value(0).processed).arg(last.value(2).processed)
+               .arg(m_engine->isCancelled() ? "（已取消，剩余数据被丢弃）" : ""));
+    updatePoolLabel();
+    updateTraceLabel();
+    m_engine.reset();
+    m_autoscaler.reset();
+    m_pool.reset();
     m_btnStart->setEnabled(true);
     m_btnStop->setEnabled(false);
+    m_btnCancel->setEnabled(false);
+    setConfigEnabled(true);
+}
+
+/*
+ * 攒批的效果：平均批大小按两次快照的项数差 / 调用次数差计算，延迟是本周期内完成的项的端到端延迟
+ * （采集完成 -> 存储完成，即存储阶段的 sinceBorn）；批越大、等待越久，吞吐越高、延迟越大
+ */
+void QtPipelineWidget::updateBatchLabel(const QVector<PipelineStageStats> &now,
+                                        const QVector<PipelineStageLatency> &latencies)
+{
+    if (now.size() < 3 || latencies.size() < 3) {
+        return;
+    }
+    auto averageBatch = [this, &now](int i) {
+        const PipelineStageStats prev = i < m_lastStats.size() ? m_lastStats[i] : PipelineStageStats();
+        const quint64 calls = now[i].batches - prev.batches;
+        return calls > 0 ? double(now[i].processed - prev.processed) / calls : 0.0;
+    };
+    const HistogramSnapshot &latency = latencies[2].sinceBorn;
+    m_lblBatch->setText(QString("平均批大小：处理 %1，存储 %2；端到端延迟 p50 %3 ms，p99 %4 ms，最大 %5 ms")
+                        .arg(averageBatch(1), 0, 'f', 1).arg(averageBatch(2), 0, 'f', 1)
+                        .arg(latency.percentile(0.5) / 1e6, 0, 'f', 2).arg(latency.percentile(0.99) / 1e6, 0, 'f', 2)
+                        .arg(latency.max / 1e6, 0, 'f', 2));
+}
+
+/*
+ * 每阶段本周期的排队/服务时间分位数；排队占比 = 排队总时长 / (排队 + 服务)
+ * 平均排队时间最长的一行标红：它的输入队列积压最多，通常是（或紧跟在）瓶颈阶段
+ */
+void QtPipelineWidget::updateLatencyTable(const QVector<PipelineStageLatency> &latencies)
+{
+    m_latencyTable->setRowCount(latencies.size());
+    int worst = -1;
+    double worstMean = 0.0;
+    for (int row = 0; row < latencies.size(); ++row) {
+        const PipelineStageLatency &l = latencies[row];
+        const double queueMean = l.queue.count > 0 ? double(l.queue.sum) / l.queue.count : 0.0;
+        if (queueMean > worstMean) {
+            worstMean = queueMean;
+            worst = row;
+        }
+        const quint64 total = l.queue.sum + l.service.sum;
+        const QString share = total > 0 ? QString("%1%").arg(100.0 * l.queue.sum / total, 0, 'f', 0) : QString("-");
+        // 采集阶段没有输入队列
+        const bool hasQueue = l.queue.count > 0;
+        const QStringList cells = {
+            l.name,
+            hasQueue ? formatUs(l.queue.percentile(0.5)) : QString("-"),
+            hasQueue ? formatUs(l.queue.percentile(0.99)) : QString("-"),
+            l.service.count > 0 ? formatUs(l.service.percentile(0.5)) : QString("-"),
+            l.service.count > 0 ? formatUs(l.service.percentile(0.99)) : QString("-"),
+            share};
+        for (int col = 0; col < cells.size(); ++col) {
+            m_latencyTable->setItem(row, col, new QTableWidgetItem(cells[col]));
+        }
+    }
+    for (int row = 0; row < latencies.size(); ++row) {
+        const QColor color = row == worst ? QColor::fromHsv(0, 90, 235) : QColor(Qt::white);
+        for (int col = 0; col < m_latencyTable->columnCount(); ++col) {
+            m_latencyTable->item(row, col)->setBackground(color);
+        }
+    }
+}
+
+void QtPipelineWidget::updateTraceLabel()
+{
+    if (!m_trace) {
+        m_lblTrace->setText(m_chkTrace->isChecked() ? QString() : QString("未记录逐项追踪"));
+        return;
+    }
+    m_lblTrace->setText(QString("追踪：已记录 %1 段，被覆盖 %2 段（缓冲区 %3 段）")
+                        .arg(m_trace->recorded()).arg(m_trace->overwritten()).arg(m_trace->capacity()));
+}
+
+// 导出最近一次运行的追踪，可在 chrome://tracing 或 ui.perfetto.dev 中打开
+void QtPipelineWidget::onExportTraceClicked()
+{
+    if (!m_trace) {
+        return;
+    }
+    const QString path = QFileDialog::getSaveFileName(this, "导出追踪", "pipeline_trace.json", "JSON (*.json)");
+    if (path.isEmpty()) {
+        return;
+    }
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        logMessage(QString("导出追踪失败：%1").arg(file.errorString()));
+        return;
+    }
+    const QByteArray json = m_trace->toChromeTraceJson(m_traceStageNames);
+    file.write(json);
+    logMessage(QString("已导出追踪：%1（%2 段，%3 KB）")
+               .arg(path).arg(m_trace->snapshot().size()).arg(json.size() / 1024));
+}
+
+// 缓冲池占用和缓冲区分配次数：池在分配处计数，逐项分配在采集阶段按容量变化计数；
+// 使用缓冲池时只有开始时池的几次分配、逐项为 0，不使用时随每一项增长
+void QtPipelineWidget::updatePoolLabel()
+{
+    if (!m_itemAllocations) {
+        return;
+    }
+    const quint64 perItem = m_itemAllocations->load(std::memory_order_relaxed);
+    if (m_pool) {
+        m_lblPool->setText(QString("缓冲池：使用中 %1/%2，峰值 %3，借空等待 %4 次；缓冲区分配 %5 次（池 %6，逐项 %7）")
+                           .arg(m_pool->inUse()).arg(m_pool->bufferCount()).arg(m_pool->peakInUse())
+                           .arg(m_pool->exhaustedWaits()).arg(m_pool->allocations() + perItem)
+                           .arg(m_pool->allocations()).arg(perItem));
+    } else {
+        m_lblPool->setText(QString("未使用缓冲池；缓冲区分配 %1 次（逐项）").arg(perItem));
+    }
 }
 
 void QtPipelineWidget::logMessage(const QString &msg)
@@ -7,29 +7,104 @@
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QGroupBox>
+#include <QSpinBox>
+#include <QCheckBox>
+#include <QTimer>
+#include <QTableWidget>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include "bufferpool.h"
+#include "pipelineautoscaler.h"
+#include "pipelineengine.h"
+#include "pipelinetrace.h"
+
+// 流水线中流动的一项数据：采集阶段填充样本，处理阶段计算结果，存储阶段落盘（模拟）
+// 样本放在从缓冲池借来的缓冲区里，阶段之间只移动句柄；关闭缓冲池时退回每项单独分配作对照
+// trace 由 PipelineEngine 维护，记录每个阶段的排队和服务时间
+struct PipelineItem
+{
+    quint64 seq = 0;
+    PipelineTraceStamp trace;
+    PooledBuffer<float> pooled;     // 使用缓冲池
+    std::vector<float> heapSamples; // 不使用缓冲池
+    double value = 0.0;
+
+    float *samples() { return pooled ? pooled.data() : heapSamples.data(); }
+    std::size_t sampleCount() const { return pooled ? pooled.size() : heapSamples.size(); }
+};
 
 class QtPipelineWidget : public QWidget
 {
     Q_OBJECT
 public:
     explicit QtPipelineWidget(QWidget *parent = nullptr);
+    ~QtPipelineWidget() override;
 
 private slots:
     void onStartClicked();
     void onStopClicked();
+    void onCancelClicked();
+    void onExportTraceClicked();
+    void updateStats();
 
 private:
     void setupUi();
     void logMessage(const QString &msg);
+    void setConfigEnabled(bool enabled);
+    void finishRun();
+    void updatePoolLabel();
+    void updateBatchLabel(const QVector<PipelineStageStats> &now, const QVector<PipelineStageLatency> &latencies);
+    void updateLatencyTable(const QVector<PipelineStageLatency> &latencies);
+    void updateTraceLabel();
 
     QPushButton *m_btnStart;
     QPushButton *m_btnStop;
-    
-    // 模拟三个阶段的状态显示
+    QPushButton *m_btnCancel;
+    QPushButton *m_btnExportTrace;
+
+    // 参数
+    QSpinBox *m_spinRate;      // 采集速率（项/秒，0 表示不限速）
+    QSpinBox *m_spinProcessUs; // 处理阶段每项耗时（µs）
+    QSpinBox *m_spinStoreUs;   // 存储阶段每项耗时（µs）
+    QSpinBox *m_spinCapacity;  // 阶段间队列容量
+    QSpinBox *m_spinCallUs;    // 处理阶段每次调用的固定开销（µs），攒批后按批摊薄
+    QSpinBox *m_spinBatchItems[2];   // 每条边的批大小 B：采集 -> 处理，处理 -> 存储
+    QSpinBox *m_spinBatchLingerUs[2]; // 每条边凑批的最长等待 T（µs）
+    QSpinBox *m_spinWorkers[3]; // 每个阶段的工作线程数
+    QCheckBox *m_chkOrdered;    // 处理阶段的输出按序号交给存储阶段
+    QSpinBox *m_spinReorderWindow; // 重排序缓冲区槽位数
+    QCheckBox *m_chkAutoscale;     // 按队列深度和忙碌比例自动伸缩处理/存储阶段
+    QSpinBox *m_spinMaxWorkers[2]; // 处理、存储阶段的伸缩上限（下限为 1，线程数设置作为初始值）
+    QCheckBox *m_chkPool;          // 样本缓冲区从固定大小的池中借用
+    QSpinBox *m_spinPoolSize;      // 池中缓冲区个数
+    QCheckBox *m_chkTrace;         // 逐项记录排队/服务区间，供导出
+
+    // 三个阶段的状态显示：吞吐与忙碌比例
     QLabel *m_lblStage1; // 采集
     QLabel *m_lblStage2; // 处理
     QLabel *m_lblStage3; // 显示/存储
-    
+    // 阶段间队列深度
+    QLabel *m_lblQueue12;
+    QLabel *m_lblQueue23;
+
     QLabel *m_lblCount; // 总处理数
+    QLabel *m_lblReorder; // 重排序缓冲的开销与存储阶段观察到的乱序
+    QLabel *m_lblPool;    // 缓冲池占用与分配次数
+    QLabel *m_lblBatch;   // 平均批大小与端到端延迟
+    QLabel *m_lblTrace;   // 追踪缓冲区记录/覆盖的区间数
+    QTableWidget *m_latencyTable; // 每阶段排队 vs 服务时间分位数
     QTextEdit *m_logViewer;
+
+    std::unique_ptr<PipelineEngine> m_engine;
+    std::unique_ptr<PipelineAutoscaler> m_autoscaler; // 未启用自动伸缩时为空
+    QTimer *m_statsTimer;
+    QVector<PipelineStageStats> m_lastStats;
+    quint64 m_lastStatsNs = 0;
+    // 存储阶段（单线程时）发现的序号倒退次数，用来验证保序
+    std::shared_ptr<std::atomic<quint64>> m_sinkInversions;
+    std::shared_ptr<BufferPool<float>> m_pool;             // 未使用缓冲池时为空
+    std::shared_ptr<std::atomic<quint64>> m_itemAllocations; // 采集阶段逐项的缓冲区分配（两种路径同样计数）
+    std::shared_ptr<PipelineTraceBuffer> m_trace; // 未启用追踪时为空；运行结束后保留到下次启动，供导出
+    QStringList m_traceStageNames;
 };
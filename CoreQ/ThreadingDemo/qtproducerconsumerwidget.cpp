@@ -1,91 +1,913 @@
 #include "qtproducerconsumerwidget.h"
 #include <QDateTime>
+#include <QFile>
+#include <QFileDialog>
+#include <QHeaderView>
 #include <QRandomGenerator>
+#include <QTextStream>
+#include <QVarLengthArray>
+#include <QtConcurrent>
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <thread>
+#ifdef Q_OS_UNIX
+#include <sys/resource.h>
+#endif
 
-void BufferController::produce(int data)
+namespace {
+
+// 本进程累计的上下文切换次数（自愿 + 非自愿），不支持的平台返回 -1
+qint64 processContextSwitches()
 {
-    QMutexLocker locker(&m_mutex);
+#ifdef Q_OS_UNIX
+    rusage usage{};
+    if(getrusage(RUSAGE_SELF,&usage)==0)
+    {
+        return static_cast<qint64>(usage.ru_nvcsw+usage.ru_nivcsw);
+    }
+#endif
+    return -1;
+}
+
+// 单次 1:1 交接测试结果
+struct HandoffResult {
+    double opsPerSec = 0.0;
+    qint64 p50Ns = 0;
+    qint64 p99Ns = 0;
+};
+
+qint64 steadyNowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// 生产者把当前时间戳作为数据放入队列，消费者取出时计算交接延迟
+template <typename PushFn, typename PopFn>
+HandoffResult runHandoff(int count, PushFn push, PopFn pop)
+{
+    std::vector<qint64> latencies(static_cast<std::size_t>(count));
+    const qint64 begin=steadyNowNs();
+    std::thread consumer([&] {
+        for(int i=0;i<count;++i)
+        {
+            const qint64 stamp=pop();
+            latencies[static_cast<std::size_t>(i)]=steadyNowNs()-stamp;
+        }
+    });
+    for(int i=0;i<count;++i)
+    {
+        push(steadyNowNs());
+    }
+    consumer.join();
+    const qint64 elapsed=steadyNowNs()-begin;
+
+    HandoffResult result;
+    result.opsPerSec=elapsed>0 ? count*1e9/elapsed : 0.0;
+    std::sort(latencies.begin(),latencies.end());
+    result.p50Ns=latencies[latencies.size()/2];
+    result.p99Ns=latencies[latencies.size()*99/100];
+    return result;
+}
+
+QString runSpscBenchmark(int capacity, int count)
+{
+    SpscRingBuffer<qint64> spsc(static_cast<std::size_t>(capacity));
+    // 无锁一侧满/空时让出时间片而不是死等，单核机器上也能推进
+    const HandoffResult lockFree=runHandoff(count,
+        [&](qint64 stamp) { while (!spsc.tryPush(stamp)) std::this_thread::yield(); },
+        [&]() { qint64 stamp=0; while (!spsc.tryPop(stamp)) std::this_thread::yield(); return stamp; });
+
+    BoundedQueue<qint64> queue(static_cast<std::size_t>(capacity));
+    const HandoffResult locked=runHandoff(count,
+        [&](qint64 stamp) { queue.push(stamp); },
+        [&]() { qint64 stamp=0; queue.pop(stamp); return stamp; });
+
+    auto format=[](const char *name, const HandoffResult &r) {
+        return QString("%1: %2 ops/s, p50 %3 ns, p99 %4 ns")
+            .arg(name).arg(r.opsPerSec,0,'f',0).arg(r.p50Ns).arg(r.p99Ns);
+    };
+    return QString("基准测试 (%1 项, 容量 %2)\n  %3\n  %4\n  SPSC 吞吐为互斥锁的 %5 倍")
+        .arg(count).arg(capacity)
+        .arg(format("SPSC 无锁环", lockFree), format("互斥锁队列", locked))
+        .arg(locked.opsPerSec>0 ? lockFree.opsPerSec/locked.opsPerSec : 0.0,0,'f',1);
+}
+
+// 扩展性扫描的公共参数
+struct ScalingConfig {
+    int capacity = 0;
+    BufferMode requested = BufferMode::Auto;
+    WakeStrategy wake = WakeStrategy::Counted;
+    int batchSize = 1;
+    int durationMs = 0;
+};
+
+// 扫描中的一格：p 个生产者、c 个消费者不限速地跑固定时长，返回消费吞吐（项/秒）
+double runScalingCell(const ScalingConfig &cfg, int producers, int consumers)
+{
+    const BufferMode mode=BufferController::resolveMode(cfg.requested,producers,consumers);
+    BufferController controller(cfg.capacity,mode,cfg.wake);
+    std::atomic<bool> running{true};
+    std::vector<std::thread> threads;
+    for(int p=0;p<producers;++p)
+    {
+        threads.emplace_back([&] {
+            std::vector<Frame> frames(static_cast<std::size_t>(qMax(1,cfg.batchSize)));
+            int value=0;
+            while (running.load(std::memory_order_relaxed))
+            {
+                for(Frame &frame:frames)
+                {
+                    frame.value=100+(value++)%900;
+                }
+                if(frames.size()==1)
+                {
+                    if(controller.produce(std::move(frames.front()))==ProduceStatus::Stopped)
+                    {
+                        break;
+                    }
+                }
+                else if(controller.produceBatch(frames.data(),static_cast<int>(frames.size()))==0)
+                {
+                    break;
+                }
+            }
+        });
+    }
+    for(int c=0;c<consumers;++c)
+    {
+        threads.emplace_back([&] {
+            AdaptiveWaiter waiter;
+            Frame frame;
+            std::vector<Frame> frames;
+            for(;;)
+            {
+                if(cfg.batchSize<=1)
+                {
+                    if(!controller.consume(frame,&waiter))
+                    {
+                        break;
+                    }
+                    continue;
+                }
+                frames.clear();
+                if(controller.consumeBatch(frames,cfg.batchSize,&waiter)==0)
+                {
+                    break;
+                }
+            }
+        });
+    }
+
+    // 先预热 1/10 时长，再在固定窗口内计数
+    std::this_thread::sleep_for(std::chrono::milliseconds(cfg.durationMs/10));
+    const quint64 beginItems=controller.stats().consumedItems;
+    const qint64 beginNs=steadyNowNs();
+    std::this_thread::sleep_for(std::chrono::milliseconds(cfg.durationMs));
+    const quint64 endItems=controller.stats().consumedItems;
+    const qint64 elapsedNs=steadyNowNs()-beginNs;
+
+    running=false;
+    controller.stop();
+    for(std::thread &t:threads)
+    {
+        t.join();
+    }
+    return elapsedNs>0 ? (endItems-beginItems)*1e9/elapsedNs : 0.0;
+}
+
+} // namespace
+
+ProduceStatus BufferController::produce(Frame &&frame)
+{
+    if(m_lanes)
+    {
+        if(m_stop)
+        {
+            return ProduceStatus::Stopped;
+        }
+        const ProduceStatus status=producePriority(frame);
+        if(status==ProduceStatus::Ok || status==ProduceStatus::Overwrote)
+        {
+            m_produceCalls.fetch_add(1,std::memory_order_relaxed);
+        }
+        return status;
+    }
+    if(m_policy==BackpressurePolicy::Block)
+    {
+        return produceBatch(&frame,1)==1 ? ProduceStatus::Ok : ProduceStatus::Stopped;
+    }
     if(m_stop)
+    {
+        return ProduceStatus::Stopped;
+    }
+    const ProduceStatus status=produceWithPolicy(frame);
+    if(status==ProduceStatus::Ok || status==ProduceStatus::Overwrote)
+    {
+        m_produceCalls.fetch_add(1,std::memory_order_relaxed);
+    }
+    return status;
+}
+
+ProduceStatus BufferController::producePriority(Frame &frame)
+{
+    const int value=frame.value;
+    const int lane=frame.lane;
+    frame.enqueueNs=steadyNowNs();
+    ProduceStatus status=ProduceStatus::Ok;
+    switch (m_policy)
+    {
+    case BackpressurePolicy::DropOldest:
+    {
+        const int evicted=m_lanes->pushOverwrite(std::move(frame),lane);
+        if(evicted<0)
+        {
+            return ProduceStatus::Stopped;
+        }
+        if(evicted>0)
+        {
+            m_overwrittenItems.fetch_add(1,std::memory_order_relaxed);
+            status=ProduceStatus::Overwrote;
+        }
+        break;
+    }
+    case BackpressurePolicy::DropNewest:
+    case BackpressurePolicy::Reject:
+        if(!m_lanes->tryPush(std::move(frame),lane))
+        {
+            if(m_stop)
+            {
+                return ProduceStatus::Stopped;
+            }
+            if(m_policy==BackpressurePolicy::Reject)
+            {
+                m_rejectedItems.fetch_add(1,std::memory_order_relaxed);
+                return ProduceStatus::Rejected;
+            }
+            m_droppedItems.fetch_add(1,std::memory_order_relaxed);
+            return ProduceStatus::Dropped;
+        }
+        break;
+    case BackpressurePolicy::BlockWithTimeout:
+        if(!m_lanes->pushFor(std::move(frame),lane,m_timeoutMs))
+        {
+            if(m_stop)
+            {
+                return ProduceStatus::Stopped;
+            }
+            m_timedOutItems.fetch_add(1,std::memory_order_relaxed);
+            return ProduceStatus::TimedOut;
+        }
+        break;
+    case BackpressurePolicy::Block:
+    default:
+        if(!m_lanes->push(std::move(frame),lane))
+        {
+            return ProduceStatus::Stopped;
+        }
+        break;
+    }
+    recordProduced(value);
+    return status;
+}
+
+void BufferController::recordLaneLatency(const Frame &frame, qint64 nowNs)
+{
+    const int lane=qBound(0,frame.lane,static_cast<int>(m_laneLatency.size())-1);
+    m_laneLatency[static_cast<std::size_t>(lane)]->record(static_cast<quint64>(qMax<qint64>(0,nowNs-frame.enqueueNs)));
+}
+
+void BufferController::setPriorityLanes(int lanes)
+{
+    if(m_mode!=BufferMode::Priority)
     {
         return;
     }
+    m_lanes.reset(new PriorityLanes<Frame>(m_capacity,lanes));
+    m_laneLatency.clear();
+    for(int i=0;i<m_lanes->laneCount();++i)
+    {
+        m_laneLatency.emplace_back(new LatencyHistogram);
+    }
+}
+
+HistogramSnapshot BufferController::laneLatency(int lane) const
+{
+    if(lane<0 || lane>=static_cast<int>(m_laneLatency.size()))
+    {
+        return HistogramSnapshot();
+    }
+    return m_laneLatency[static_cast<std::size_t>(lane)]->snapshot();
+}
+
+ProduceStatus BufferController::produceWithPolicy(Frame &frame)
+{
+    const int value=frame.value;
+    ProduceStatus status=ProduceStatus::Ok;
+    switch (m_policy)
+    {
+    case BackpressurePolicy::DropOldest:
+        if(m_queue)
+        {
+            const int evicted=m_queue->pushOverwrite(std::move(frame));
+            if(evicted<0)
+            {
+                return ProduceStatus::Stopped;
+            }
+            if(evicted>0)
+            {
+                m_overwrittenItems.fetch_add(1,std::memory_order_relaxed);
+                status=ProduceStatus::Overwrote;
+            }
+            break;
+        }
+        if(m_ring)
+        {
+            // 环满时由生产者自己出队最旧的一帧腾出空位；并发消费者也可能先取走它，重试即可
+            while (!m_ring->tryPush(std::move(frame)))
+            {
+                if(m_stop)
+                {
+                    return ProduceStatus::Stopped;
+                }
+                Frame oldest;
+                if(m_ring->tryPop(oldest))
+                {
+                    m_overwrittenItems.fetch_add(1,std::memory_order_relaxed);
+                    status=ProduceStatus::Overwrote;
+                }
+            }
+            break;
+        }
+        // SPSC 环的生产者不能出队（resolveMode 不会选到这里），退化为丢弃最新
+        Q_FALLTHROUGH();
+    case BackpressurePolicy::DropNewest:
+    case BackpressurePolicy::Reject:
+    {
+        const bool pushed=m_queue ? m_queue->tryPush(std::move(frame)) : tryPushRing(frame);
+        if(!pushed)
+        {
+            if(m_stop)
+            {
+                return ProduceStatus::Stopped;
+            }
+            if(m_policy==BackpressurePolicy::Reject)
+            {
+                m_rejectedItems.fetch_add(1,std::memory_order_relaxed);
+                return ProduceStatus::Rejected;
+            }
+            m_droppedItems.fetch_add(1,std::memory_order_relaxed);
+            return ProduceStatus::Dropped;
+        }
+        break;
+    }
+    case BackpressurePolicy::BlockWithTimeout:
+    default:
+    {
+        const bool pushed=m_queue ? m_queue->pushFor(std::move(frame),m_timeoutMs)
+                                  : pushLockFree(frame,m_timeoutMs);
+        if(!pushed)
+        {
+            if(m_stop)
+            {
+                return ProduceStatus::Stopped;
+            }
+            m_timedOutItems.fetch_add(1,std::memory_order_relaxed);
+            return ProduceStatus::TimedOut;
+        }
+        break;
+    }
+    }
+
+    recordProduced(value);
+    if(m_queue==nullptr)
+    {
+        wakeIfWaiting(m_waitingConsumers, m_bufferNotEmpty, false);
+    }
+    return status;
+}
+
+bool BufferController::consume(Frame &out, AdaptiveWaiter *waiter)
+{
+    if(m_lanes)
+    {
+        if(m_stop || !m_lanes->pop(out))
+        {
+            return false;
+        }
+        recordLaneLatency(out,steadyNowNs());
+        m_consumedItems.fetch_add(1,std::memory_order_relaxed);
+        m_consumeCalls.fetch_add(1,std::memory_order_relaxed);
+        return true;
+    }
+    if(m_queue==nullptr)
+    {
+        if(!popLockFree(out,waiter))
+        {
+            return false;
+        }
+        m_consumedItems.fetch_add(1,std::memory_order_relaxed);
+        m_consumeCalls.fetch_add(1,std::memory_order_relaxed);
+        wakeIfWaiting(m_waitingProducers, m_bufferNotFull, false);
+        return true;
+    }
+
+    if(m_stop || !m_queue->pop(out))
+    {
+        return false;
+    }
+    m_consumedItems.fetch_add(1,std::memory_order_relaxed);
+    m_consumeCalls.fetch_add(1,std::memory_order_relaxed);
+    return true;
+}
+
+int BufferController::produceBatch(Frame *frames, int count)
+{
+    if(count<=0 || m_stop)
+    {
+        return 0;
+    }
+    if(m_lanes)
+    {
+        // 各帧可能属于不同通道，逐帧入队
+        int produced=0;
+        for(int i=0;i<count && !m_stop;++i)
+        {
+            const ProduceStatus status=producePriority(frames[i]);
+            if(status==ProduceStatus::Ok || status==ProduceStatus::Overwrote)
+            {
+                ++produced;
+            }
+        }
+        if(produced>0)
+        {
+            m_produceCalls.fetch_add(1,std::memory_order_relaxed);
+        }
+        return produced;
+    }
+    if(m_policy!=BackpressurePolicy::Block)
+    {
+        // 丢弃/覆盖/拒绝/超时都是逐帧的决定，这里不做整批交接
+        int produced=0;
+        for(int i=0;i<count && !m_stop;++i)
+        {
+            const ProduceStatus status=produceWithPolicy(frames[i]);
+            if(status==ProduceStatus::Ok || status==ProduceStatus::Overwrote)
+            {
+                ++produced;
+            }
+        }
+        if(produced>0)
+        {
+            m_produceCalls.fetch_add(1,std::memory_order_relaxed);
+        }
+        return produced;
+    }
+    if(m_queue==nullptr)
+    {
+        return produceBatchLockFree(frames,count);
+    }
+
+    // 先记下显示用的值：入队后帧已被 move 走
+    QVarLengthArray<int,64> values(count);
+    for(int i=0;i<count;++i)
+    {
+        values[i]=frames[i].value;
+    }
+    const int produced=static_cast<int>(m_queue->pushBatch(frames,static_cast<std::size_t>(count)));
+    for(int i=0;i<produced;++i)
+    {
+        recordProduced(values[i]);
+    }
+    if(produced>0)
+    {
+        m_produceCalls.fetch_add(1,std::memory_order_relaxed);
+    }
+    return produced;
+}
+
+int BufferController::consumeBatch(std::vector<Frame> &out, int maxItems, AdaptiveWaiter *waiter)
+{
+    if(maxItems<=0 || m_stop)
+    {
+        return 0;
+    }
+    if(m_lanes)
+    {
+        const std::size_t first=out.size();
+        const int n=static_cast<int>(m_lanes->popBatch(out,static_cast<std::size_t>(maxItems)));
+        const qint64 nowNs=steadyNowNs();
+        for(std::size_t i=first;i<out.size();++i)
+        {
+            recordLaneLatency(out[i],nowNs);
+        }
+        if(n>0)
+        {
+            m_consumedItems.fetch_add(static_cast<quint64>(n),std::memory_order_relaxed);
+            m_consumeCalls.fetch_add(1,std::memory_order_relaxed);
+        }
+        return n;
+    }
+    if(m_queue==nullptr)
+    {
+        return consumeBatchLockFree(out,maxItems,waiter);
+    }
+
+    const int n=static_cast<int>(m_queue->popBatch(out,static_cast<std::size_t>(maxItems)));
+    if(n>0)
+    {
+        m_consumedItems.fetch_add(static_cast<quint64>(n),std::memory_order_relaxed);
+        m_consumeCalls.fetch_add(1,std::memory_order_relaxed);
+    }
+    return n;
+}
+
+BufferStats BufferController::stats() const
+{
+    BufferStats s;
+    s.producedItems=m_producedItems.load(std::memory_order_relaxed);
+    s.consumedItems=m_consumedItems.load(std::memory_order_relaxed);
+    s.produceCalls=m_produceCalls.load(std::memory_order_relaxed);
+    s.consumeCalls=m_consumeCalls.load(std::memory_order_relaxed);
+    s.fullWaits=m_fullWaits.load(std::memory_order_relaxed);
+    s.emptyWaits=m_emptyWaits.load(std::memory_order_relaxed);
+    s.droppedItems=m_droppedItems.load(std::memory_order_relaxed);
+    s.overwrittenItems=m_overwrittenItems.load(std::memory_order_relaxed);
+    s.rejectedItems=m_rejectedItems.load(std::memory_order_relaxed);
+    s.timedOutItems=m_timedOutItems.load(std::memory_order_relaxed);
+    s.blockedNs=m_blockedNs.load(std::memory_order_relaxed);
+    if(m_queue)
+    {
+        s.fullWaits+=m_queue->fullWaits();
+        s.emptyWaits+=m_queue->emptyWaits();
+        s.blockedNs+=m_queue->fullWaitNs();
+        s.wakeups=m_queue->wakeups();
+        s.wastedWakeups=m_queue->wastedWakeups();
+    }
+    else if(m_lanes)
+    {
+        s.fullWaits+=m_lanes->fullWaits();
+        s.emptyWaits+=m_lanes->emptyWaits();
+        s.blockedNs+=m_lanes->fullWaitNs();
+        s.wakeups=m_lanes->wakeups();
+        s.wastedWakeups=m_lanes->wastedWakeups();
+    }
+    else
+    {
+        s.wakeups=m_wakeups.load(std::memory_order_relaxed);
+        s.wastedWakeups=m_wastedWakeups.load(std::memory_order_relaxed);
+    }
+    return s;
+}
+
+BufferController::RecentLookup BufferController::recentValue(quint64 seq, int &value) const
+{
+    const quint64 entry=m_recent[seq&(kRecentCapacity-1)].load(std::memory_order_acquire);
+    const quint32 stamp=static_cast<quint32>(entry>>32);
+    const qint32 age=static_cast<qint32>(stamp-static_cast<quint32>(seq));
+    if(age==0)
+    {
+        value=static_cast<int>(static_cast<quint32>(entry));
+        return RecentLookup::Ready;
+    }
+    // 槽位里是更新的序号：该项已被覆盖；否则是序号已分配但值还没写入
+    return age>0 ? RecentLookup::Lost : RecentLookup::Pending;
+}
+
+BufferMode BufferController::resolveMode(BufferMode requested, int producers, int consumers,
+                                         BackpressurePolicy policy)
+{
+    const bool oneToOne=(producers==1 && consumers==1 && policy!=BackpressurePolicy::DropOldest);
+    switch (requested)
+    {
+    case BufferMode::Auto:
+        return oneToOne ? BufferMode::Spsc : BufferMode::LockFreeRing;
+    case BufferMode::Spsc:
+        // SPSC 只对 1:1 成立，多生产者/消费者时退回 MPMC 环
+        return oneToOne ? BufferMode::Spsc : BufferMode::LockFreeRing;
+    default:
+        return requested;
+    }
+}
+
+bool BufferController::tryPushRing(Frame &frame)
+{
+    return m_spsc ? m_spsc->tryPush(std::move(frame)) : m_ring->tryPush(std::move(frame));
+}
+
+bool BufferController::tryPopRing(Frame &frame)
+{
+    return m_spsc ? m_spsc->tryPop(frame) : m_ring->tryPop(frame);
+}
+
+void BufferController::recordProduced(int value)
+{
+    // 先占序号再写槽位：发布端看到计数后若槽位还是旧序号，会当作“未就绪”下一帧再取
+    const quint64 seq=m_producedItems.fetch_add(1,std::memory_order_relaxed);
+    const quint64 entry=(seq<<32)|static_cast<quint32>(value);
+    m_recent[seq&(kRecentCapacity-1)].store(entry,std::memory_order_release);
+}
+
+int BufferController::produceBatchLockFree(Frame *frames, int count)
+{
+    int produced=0;
+    while (!m_stop)
+    {
+        // 快路径：连续入队直到环满或全部放完，整批只检查/唤醒一次
+        const int begin=produced;
+        while (produced<count)
+        {
+            const int value=frames[produced].value;
+            if(!tryPushRing(std::move(frames[produced])))
+            {
+                break;
+            }
+            recordProduced(value);
+            ++produced;
+        }
+        if(produced>begin)
+        {
+            wakeIfWaiting(m_waitingConsumers, m_bufferNotEmpty, produced-begin>1);
+        }
+        if(produced>=count)
+        {
+            break;
+        }
+        // 环已满：阻塞放入一帧后继续走快路径
+        const int value=frames[produced].value;
+        if(!pushLockFree(frames[produced]))
+        {
+            break;
+        }
+        recordProduced(value);
+        ++produced;
+    }
+    if(produced>0)
+    {
+        // 阻塞放入的最后一帧可能还没唤醒过消费者
+        wakeIfWaiting(m_waitingConsumers, m_bufferNotEmpty, false);
+        m_produceCalls.fetch_add(1,std::memory_order_relaxed);
+    }
+    return produced;
+}
+
+int BufferController::consumeBatchLockFree(std::vector<Frame> &out, int maxItems, AdaptiveWaiter *waiter)
+{
+    Frame frame;
+    // 第一帧允许阻塞，其余只取当前已有的，不为凑满批次而等待
+    if(!popLockFree(frame,waiter))
+    {
+        return 0;
+    }
+    out.push_back(std::move(frame));
+    int n=1;
+    while (n<maxItems && tryPopRing(frame))
+    {
+        out.push_back(std::move(frame));
+        ++n;
+    }
+    wakeIfWaiting(m_waitingProducers, m_bufferNotFull, n>1);
+    m_consumedItems.fetch_add(static_cast<quint64>(n),std::memory_order_relaxed);
+    m_consumeCalls.fetch_add(1,std::memory_order_relaxed);
+    return n;
+}
 
-    while (m_buffer.size() >= m_maxSize)
+bool BufferController::pushLockFree(Frame &frame, int timeoutMs)
+{
+    if(m_stop)
     {
+        return false;
+    }
+    QElapsedTimer deadline;
+    if(timeoutMs>=0)
+    {
+        deadline.start();
+    }
+
+    // 快路径：一次 CAS 抢槽位，不加锁（入队失败时 frame 保持原样）
+    bool woken=false;
+    while (!tryPushRing(std::move(frame)))
+    {
+        if(woken)
+        {
+            m_wastedWakeups.fetch_add(1,std::memory_order_relaxed);
+        }
+        // 慢路径：环已满。先登记为等待者再重试一次，
+        // 与消费者 wakeIfWaiting 中的栅栏配对，保证不会错过唤醒
+        QMutexLocker locker(&m_mutex);
         if(m_stop)
         {
-            return;
+            return false;
+        }
+        m_waitingProducers.fetch_add(1);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if(tryPushRing(std::move(frame)))
+        {
+            m_waitingProducers.fetch_sub(1);
+            break;
         }
-        emit logRequest(QString("BufferController: 缓冲区已满，生产者等待"));
-        m_bufferNotFull.wait(&m_mutex); // 等待缓冲区不满
+        unsigned long waitMs=ULONG_MAX;
+        if(timeoutMs>=0)
+        {
+            const qint64 left=timeoutMs-deadline.elapsed();
+            if(left<=0)
+            {
+                m_waitingProducers.fetch_sub(1);
+                return false;
+            }
+            waitMs=static_cast<unsigned long>(left);
+        }
+        m_fullWaits.fetch_add(1,std::memory_order_relaxed);
+        QElapsedTimer blocked;
+        blocked.start();
+        woken=m_bufferNotFull.wait(&m_mutex,waitMs);
+        if(woken)
+        {
+            m_wakeups.fetch_add(1,std::memory_order_relaxed);
+        }
+        m_blockedNs.fetch_add(static_cast<quint64>(blocked.nsecsElapsed()),std::memory_order_relaxed);
+        m_waitingProducers.fetch_sub(1);
         if(m_stop)
         {
-            return;
+            return false;
         }
     }
-    m_buffer.append(data);
-    emit bufferUpdated(m_buffer);
-    emit logRequest(QString("生产者 + 生产数据: %1 (当前数量: %2)").arg(data).arg(m_buffer.size()));
-    m_bufferNotEmpty.wakeAll(); // 唤醒一个等待的消费者
+    return true;
 }
 
-int BufferController::consume()
+bool BufferController::popLockFree(Frame &frame, AdaptiveWaiter *waiter)
 {
-    QMutexLocker locker(&m_mutex);
     if(m_stop)
     {
-        return 0;
+        return false;
     }
 
-    while (m_buffer.isEmpty())
+    if(waiter!=nullptr)
     {
+        // 先自旋、再让出，仍等不到才登记为等待者休眠；每轮休眠醒来后重新尝试出队
+        bool got=false;
+        waiter->wait([&] {
+            got=tryPopRing(frame);
+            return got || m_stop;
+        }, [this] { parkConsumer(); });
+        return got;
+    }
+
+    bool woken=false;
+    while (!tryPopRing(frame))
+    {
+        if(woken)
+        {
+            m_wastedWakeups.fetch_add(1,std::memory_order_relaxed);
+        }
+        QMutexLocker locker(&m_mutex);
         if(m_stop)
         {
-            return 0;
+            return false;
+        }
+        m_waitingConsumers.fetch_add(1);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if(tryPopRing(frame))
+        {
+            m_waitingConsumers.fetch_sub(1);
+            break;
         }
-        emit logRequest(QString("BufferController: 缓冲区为空，消费者等待"));
-        m_bufferNotEmpty.wait(&m_mutex); // 等待缓冲区不空
+        m_emptyWaits.fetch_add(1,std::memory_order_relaxed);
+        woken=m_bufferNotEmpty.wait(&m_mutex);
+        m_wakeups.fetch_add(1,std::memory_order_relaxed);
+        m_waitingConsumers.fetch_sub(1);
         if(m_stop)
         {
-            return 0;
+            return false;
         }
     }
-    int data = m_buffer.takeFirst();
-    emit bufferUpdated(m_buffer);
-    emit logRequest(QString("消费者 - 消费数据: %1 (当前数量: %2)").arg(data).arg(m_buffer.size()));
-    m_bufferNotFull.wakeAll(); // 唤醒一个等待的生产者
-    return data;
+    return true;
 }
 
-void BufferController::stop()
+void BufferController::parkConsumer()
 {
     QMutexLocker locker(&m_mutex);
-    m_stop = true;
+    if(m_stop)
+    {
+        return;
+    }
+    // 与 popLockFree 的慢路径相同：先登记再检查，和生产者 wakeIfWaiting 中的栅栏配对
+    m_waitingConsumers.fetch_add(1);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if(ringSizeApprox()==0)
+    {
+        m_emptyWaits.fetch_add(1,std::memory_order_relaxed);
+        m_bufferNotEmpty.wait(&m_mutex);
+        m_wakeups.fetch_add(1,std::memory_order_relaxed);
+    }
+    m_waitingConsumers.fetch_sub(1);
+}
+
+std::size_t BufferController::ringSizeApprox() const
+{
+    return m_spsc ? m_spsc->sizeApprox() : m_ring->sizeApprox();
+}
+
+void BufferController::wakeIfWaiting(std::atomic<int> &waiters, QWaitCondition &cond, bool all)
+{
+    // 栅栏保证：要么这里看到等待者，要么等待者的重试能看到本次入队/出队
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if(waiters.load(std::memory_order_relaxed)>0)
+    {
+        // 等待者在持有 m_mutex 时登记并进入 wait，这里加锁后再唤醒就不会落空
+        QMutexLocker locker(&m_mutex);
+        if(all)
+        {
+            cond.wakeAll();
+        }
+        else
+        {
+            cond.wakeOne();
+        }
+    }
+}
+
+void BufferController::stop()
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        m_stop = true;
+        m_bufferNotFull.wakeAll();
+        m_bufferNotEmpty.wakeAll();
+    }
+    if(m_queue)
+    {
+        m_queue->close();
+    }
+    if(m_lanes)
+    {
+        m_lanes->close();
+    }
     emit logRequest(QString("BufferController: 发出停止信号，唤醒所有线程"));
-    m_bufferNotFull.wakeAll();
-    m_bufferNotEmpty.wakeAll();
 }
 
 void ProducerThread::run()
 {
     m_running=true;
+    std::vector<Frame> batch;
     while (m_running&&!isInterruptionRequested())
     {
         msleep(m_interval);
 
-        int data=QRandomGenerator::global()->bounded(100,999);
-        m_controller->produce(data);
+        // 每帧的负载在这里分配一次，之后经缓冲区交给消费者只是转移所有权
+        batch.resize(static_cast<std::size_t>(qMax(1,m_batchSize)));
+        const int lanes=m_controller->laneCount();
+        for(Frame &frame:batch)
+        {
+            frame.value=QRandomGenerator::global()->bounded(100,999);
+            frame.payload.resize(static_cast<std::size_t>(m_payloadSize));
+            frame.lane=0;
+            if(lanes>1 && QRandomGenerator::global()->bounded(100)>=m_urgentPercent)
+            {
+                frame.lane=1+QRandomGenerator::global()->bounded(lanes-1);
+            }
+        }
+
+        // 缓冲区满时的丢弃/覆盖/拒绝/超时由 BufferController 按策略处理并计数，
+        // 被拒绝或超时的帧这里直接丢掉，不再重试（遥测数据宁可丢旧样本也不拖住生产者）
+        if(batch.size()==1)
+        {
+            const ProduceStatus status=m_controller->produce(std::move(batch.front()));
+            if(status==ProduceStatus::Ok || status==ProduceStatus::Overwrote)
+            {
+                m_produced.fetch_add(1,std::memory_order_relaxed);
+            }
+        }
+        else
+        {
+            const int n=m_controller->produceBatch(batch.data(),static_cast<int>(batch.size()));
+            m_produced.fetch_add(static_cast<quint64>(n),std::memory_order_relaxed);
+        }
     }
 }
 
 void ConsumerThread::run()
 {
     m_running=true;
+    Frame frame;
+    std::vector<Frame> frames;
     while (m_running&&!isInterruptionRequested())
     {
         msleep(m_interval);
 
-        int data=m_controller->consume();
+        if(m_batchSize<=1)
+        {
+            if(m_controller->consume(frame,&m_waiter))
+            {
+                m_consumed.fetch_add(1,std::memory_order_relaxed);
+            }
+            continue;
+        }
+
+        frames.clear();
+        const int n=m_controller->consumeBatch(frames,m_batchSize,&m_waiter);
+        m_consumed.fetch_add(static_cast<quint64>(n),std::memory_order_relaxed);
     }
 }
 
@@ -95,6 +917,14 @@ QtProducerConsumerWidget::QtProducerConsumerWidget(QWidget *parent)
     setupUi();
 }
 
+QtProducerConsumerWidget::~QtProducerConsumerWidget()
+{
+    // 基准测试与扫描在线程池中运行，退出前等它们结束（扫描在当前格跑完后即停止）
+    m_sweepCancel=true;
+    m_benchWatcher->waitForFinished();
+    m_sweepWatcher->waitForFinished();
+}
+
 void QtProducerConsumerWidget::setupUi()
 {
     QVBoxLayout *mainLayout = new QVBoxLayout(this);
@@ -103,29 +933,115 @@ void QtProducerConsumerWidget::setupUi()
     QGroupBox *grpControl = new QGroupBox("控制面板", this);
     QHBoxLayout *controlLayout = new QHBoxLayout(grpControl);
 
+    controlLayout->addWidget(new QLabel("存储模式:"));
+    m_comboMode = new QComboBox(this);
+    m_comboMode->addItem("互斥锁 + QVector", static_cast<int>(BufferMode::Mutex));
+    m_comboMode->addItem("无锁环形队列 (MPMC)", static_cast<int>(BufferMode::LockFreeRing));
+    m_comboMode->addItem("单生产单消费 (SPSC)", static_cast<int>(BufferMode::Spsc));
+    m_comboMode->addItem("优先级通道 (加权轮询)", static_cast<int>(BufferMode::Priority));
+    m_comboMode->addItem("自动 (1:1 时用 SPSC)", static_cast<int>(BufferMode::Auto));
+    m_comboMode->setCurrentIndex(m_comboMode->findData(static_cast<int>(BufferMode::Auto)));
+    controlLayout->addWidget(m_comboMode);
+
+    controlLayout->addWidget(new QLabel("满时策略:"));
+    m_comboPolicy = new QComboBox(this);
+    m_comboPolicy->addItem("阻塞", static_cast<int>(BackpressurePolicy::Block));
+    m_comboPolicy->addItem("丢弃最新", static_cast<int>(BackpressurePolicy::DropNewest));
+    m_comboPolicy->addItem("覆盖最旧", static_cast<int>(BackpressurePolicy::DropOldest));
+    m_comboPolicy->addItem("拒绝并返回状态", static_cast<int>(BackpressurePolicy::Reject));
+    m_comboPolicy->addItem("限时阻塞", static_cast<int>(BackpressurePolicy::BlockWithTimeout));
+    m_comboPolicy->setToolTip("缓冲区满时 produce 的处理方式；丢弃/覆盖/拒绝都不会让生产者阻塞");
+    controlLayout->addWidget(m_comboPolicy);
+
+    controlLayout->addWidget(new QLabel("超时(ms):"));
+    m_spinTimeout = new QSpinBox(this);
+    m_spinTimeout->setRange(0, 10000);
+    m_spinTimeout->setValue(100);
+    m_spinTimeout->setEnabled(false);
+    controlLayout->addWidget(m_spinTimeout);
+    connect(m_comboPolicy, QOverload<int>::of(&QComboBox::currentIndexChanged), this, [this] {
+        const auto policy = static_cast<BackpressurePolicy>(m_comboPolicy->currentData().toInt());
+        m_spinTimeout->setEnabled(m_btnStart->isEnabled() && policy == BackpressurePolicy::BlockWithTimeout);
+    });
+
+    controlLayout->addWidget(new QLabel("唤醒策略:"));
+    m_comboWake = new QComboBox(this);
+    m_comboWake->addItem("全部唤醒 (wakeAll)", static_cast<int>(WakeStrategy::WakeAll));
+    m_comboWake->addItem("按等待者计数 (wakeOne)", static_cast<int>(WakeStrategy::Counted));
+    m_comboWake->addItem("信号量 (QSemaphore)", static_cast<int>(WakeStrategy::Semaphore));
+    m_comboWake->setCurrentIndex(m_comboWake->findData(static_cast<int>(WakeStrategy::Counted)));
+    m_comboWake->setToolTip("仅对互斥锁模式有效；无锁环满/空时始终只唤醒确有等待的线程");
+    controlLayout->addWidget(m_comboWake);
+
     controlLayout->addWidget(new QLabel("缓冲区大小:"));
     m_spinBufferSize = new QSpinBox(this);
-    m_spinBufferSize->setRange(1, 100);
+    m_spinBufferSize->setRange(1, BufferController::kMaxBufferSize);
     m_spinBufferSize->setValue(5);
     controlLayout->addWidget(m_spinBufferSize);
 
+    controlLayout->addWidget(new QLabel("生产者:"));
+    m_spinProducers = new QSpinBox(this);
+    m_spinProducers->setRange(1, 64);
+    m_spinProducers->setValue(1);
+    m_spinProducers->setToolTip("生产者线程数；扫描时为最大生产者数");
+    controlLayout->addWidget(m_spinProducers);
+
+    controlLayout->addWidget(new QLabel("消费者:"));
+    m_spinConsumers = new QSpinBox(this);
+    m_spinConsumers->setRange(1, 64);
+    m_spinConsumers->setValue(1);
+    m_spinConsumers->setToolTip("消费者线程数；扫描时为最大消费者数");
+    controlLayout->addWidget(m_spinConsumers);
+
+    controlLayout->addWidget(new QLabel("通道数:"));
+    m_spinLanes = new QSpinBox(this);
+    m_spinLanes->setRange(2, BufferController::kMaxPriorityLanes);
+    m_spinLanes->setValue(BufferController::kDefaultLanes);
+    m_spinLanes->setToolTip("优先级模式的通道数；通道 0 为紧急通道，权重依次为 2^(K-1) … 1");
+    controlLayout->addWidget(m_spinLanes);
+
+    controlLayout->addWidget(new QLabel("紧急占比(%):"));
+    m_spinUrgentPercent = new QSpinBox(this);
+    m_spinUrgentPercent->setRange(0, 100);
+    m_spinUrgentPercent->setValue(10);
+    m_spinUrgentPercent->setToolTip("优先级模式下发往通道 0 的帧比例，其余均匀分到低优先级通道");
+    controlLayout->addWidget(m_spinUrgentPercent);
+
     controlLayout->addWidget(new QLabel("生产延时(ms):"));
     m_spinProduceSpeed = new QSpinBox(this);
-    m_spinProduceSpeed->setRange(10, 2000);
+    m_spinProduceSpeed->setRange(0, 2000); // 0 表示不限速，用于测吞吐
     m_spinProduceSpeed->setValue(500);
     controlLayout->addWidget(m_spinProduceSpeed);
 
     controlLayout->addWidget(new QLabel("消费延时(ms):"));
     m_spinConsumeSpeed = new QSpinBox(this);
-    m_spinConsumeSpeed->setRange(10, 2000);
+    m_spinConsumeSpeed->setRange(0, 2000);
     m_spinConsumeSpeed->setValue(800);
     controlLayout->addWidget(m_spinConsumeSpeed);
 
+    controlLayout->addWidget(new QLabel("批量大小:"));
+    m_spinBatchSize = new QSpinBox(this);
+    m_spinBatchSize->setRange(1, 256);
+    m_spinBatchSize->setValue(1);
+    m_spinBatchSize->setToolTip("每次 produce/consume 交接的数据项数，1 为逐项交接");
+    controlLayout->addWidget(m_spinBatchSize);
+
+    controlLayout->addWidget(new QLabel("帧负载(B):"));
+    m_spinPayloadSize = new QSpinBox(this);
+    m_spinPayloadSize->setRange(0, 1 << 20);
+    m_spinPayloadSize->setSingleStep(1024);
+    m_spinPayloadSize->setValue(4096);
+    m_spinPayloadSize->setToolTip("每帧附带的负载大小，帧在缓冲区中只移动不拷贝");
+    controlLayout->addWidget(m_spinPayloadSize);
+
     m_btnStart = new QPushButton("开始", this);
     m_btnStop = new QPushButton("停止", this);
     m_btnStop->setEnabled(false);
+    m_btnBenchmark = new QPushButton("SPSC 基准测试", this);
+    m_btnBenchmark->setToolTip("1 生产者 + 1 消费者，对比 SPSC 无锁环与互斥锁队列的吞吐和 p99 交接延迟");
     controlLayout->addWidget(m_btnStart);
     controlLayout->addWidget(m_btnStop);
+    controlLayout->addWidget(m_btnBenchmark);
     
     mainLayout->addWidget(grpControl);
 
@@ -137,9 +1053,54 @@ void QtProducerConsumerWidget::setupUi()
     m_listBuffer->setFlow(QListWidget::LeftToRight);
     //m_listBuffer->setFixedHeight(100);
     bufferLayout->addWidget(m_listBuffer);
+    QHBoxLayout *statsLayout = new QHBoxLayout();
+    m_lblThroughput = new QLabel("吞吐: -", this);
+    m_lblBatch = new QLabel("平均批量: -", this);
+    m_lblStatus = new QLabel("占用: -", this);
+    m_lblBackpressure = new QLabel("背压: -", this);
+    m_lblWakeups = new QLabel("唤醒/项: -", this);
+    m_lblWaitPhases = new QLabel("消费者等待: -", this);
+    m_lblWaitPhases->setToolTip("无锁环模式下消费者先自旋、再让出时间片、最后休眠；自旋预算按近期等待时长自动调整");
+    m_lblWakeups->setToolTip("每消费一项对应的唤醒次数、无效唤醒次数，以及本进程的上下文切换次数");
+    statsLayout->addWidget(m_lblThroughput);
+    statsLayout->addWidget(m_lblBatch);
+    statsLayout->addWidget(m_lblStatus);
+    statsLayout->addWidget(m_lblBackpressure);
+    statsLayout->addWidget(m_lblWakeups);
+    statsLayout->addWidget(m_lblWaitPhases);
+    statsLayout->addStretch();
+    bufferLayout->addLayout(statsLayout);
+    m_lblPerThread = new QLabel("每线程 项/秒: -", this);
+    m_lblPerThread->setWordWrap(true);
+    bufferLayout->addWidget(m_lblPerThread);
+    m_lblLaneLatency = new QLabel(this);
+    bufferLayout->addWidget(m_lblLaneLatency);
     mainLayout->addWidget(grpBuffer);
 
-    // 3. 日志区
+    // 3. 扩展性扫描：用当前的存储模式/唤醒策略/批量，遍历 1..N 生产者 × 1..M 消费者
+    QGroupBox *grpSweep = new QGroupBox("扩展性扫描 (项/秒)", this);
+    QVBoxLayout *sweepLayout = new QVBoxLayout(grpSweep);
+    QHBoxLayout *sweepControls = new QHBoxLayout();
+    sweepControls->addWidget(new QLabel("每格时长(ms):"));
+    m_spinSweepMs = new QSpinBox(this);
+    m_spinSweepMs->setRange(50, 10000);
+    m_spinSweepMs->setValue(300);
+    sweepControls->addWidget(m_spinSweepMs);
+    m_btnSweep = new QPushButton("开始扫描", this);
+    m_btnSweep->setToolTip("生产者/消费者不限速运行，行为生产者数、列为消费者数");
+    m_btnExportCsv = new QPushButton("导出 CSV", this);
+    m_btnExportCsv->setEnabled(false);
+    sweepControls->addWidget(m_btnSweep);
+    sweepControls->addWidget(m_btnExportCsv);
+    sweepControls->addStretch();
+    sweepLayout->addLayout(sweepControls);
+    m_tableSweep = new QTableWidget(this);
+    m_tableSweep->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_tableSweep->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+    sweepLayout->addWidget(m_tableSweep);
+    mainLayout->addWidget(grpSweep);
+
+    // 4. 日志区
     QGroupBox *grpLog = new QGroupBox("运行日志", this);
     QVBoxLayout *logLayout = new QVBoxLayout(grpLog);
     m_logViewer = new QTextEdit(this);
@@ -150,10 +1111,43 @@ void QtProducerConsumerWidget::setupUi()
     logLayout->addWidget(m_btnClearLog);
     mainLayout->addWidget(grpLog);
 
-    // 4. 信号槽连接
+    // 5. 信号槽连接
     connect(m_btnStart, &QPushButton::clicked, this, &QtProducerConsumerWidget::onStartClicked);
     connect(m_btnStop, &QPushButton::clicked, this, &QtProducerConsumerWidget::onStopClicked);
     connect(m_btnClearLog, &QPushButton::clicked, this, &QtProducerConsumerWidget::onClearLogClicked);
+    connect(m_btnBenchmark, &QPushButton::clicked, this, &QtProducerConsumerWidget::onBenchmarkClicked);
+    connect(m_btnSweep, &QPushButton::clicked, this, &QtProducerConsumerWidget::onSweepClicked);
+    connect(m_btnExportCsv, &QPushButton::clicked, this, &QtProducerConsumerWidget::onExportCsvClicked);
+
+    m_benchWatcher = new QFutureWatcher<QString>(this);
+    connect(m_benchWatcher, &QFutureWatcher<QString>::finished, this, &QtProducerConsumerWidget::onBenchmarkFinished);
+    m_sweepWatcher = new QFutureWatcher<void>(this);
+    connect(m_sweepWatcher, &QFutureWatcher<void>::finished, this, &QtProducerConsumerWidget::onSweepFinished);
+
+    m_statsTimer = new QTimer(this);
+    m_statsTimer->setInterval(500);
+    connect(m_statsTimer, &QTimer::timeout, this, &QtProducerConsumerWidget::updateStats);
+
+    // 约每个显示帧拉取一次缓冲区快照，事件数与生产/消费速率无关
+    m_publishTimer = new QTimer(this);
+    m_publishTimer->setInterval(16);
+    connect(m_publishTimer, &QTimer::timeout, this, &QtProducerConsumerWidget::publishBufferState);
+}
+
+void QtProducerConsumerWidget::setConfigEnabled(bool enabled)
+{
+    m_spinBufferSize->setEnabled(enabled);
+    m_comboMode->setEnabled(enabled);
+    m_comboPolicy->setEnabled(enabled);
+    m_comboWake->setEnabled(enabled);
+    m_spinTimeout->setEnabled(enabled && static_cast<BackpressurePolicy>(m_comboPolicy->currentData().toInt())
+                                         ==BackpressurePolicy::BlockWithTimeout);
+    m_spinBatchSize->setEnabled(enabled);
+    m_spinPayloadSize->setEnabled(enabled);
+    m_spinProducers->setEnabled(enabled);
+    m_spinConsumers->setEnabled(enabled);
+    m_spinLanes->setEnabled(enabled);
+    m_spinUrgentPercent->setEnabled(enabled);
 }
 
 void QtProducerConsumerWidget::onStartClicked()
@@ -161,40 +1155,71 @@ void QtProducerConsumerWidget::onStartClicked()
     logMessage(">>> 正在启动系统...");
     m_btnStart->setEnabled(false);
     m_btnStop->setEnabled(true);
-    m_spinBufferSize->setEnabled(false);
-    
+    setConfigEnabled(false);
+
+    const int producers=m_spinProducers->value();
+    const int consumers=m_spinConsumers->value();
     if(m_bufferController==nullptr)
     {
-        delete m_bufferController;
-        m_bufferController=new BufferController(m_spinBufferSize->value(),this);
+        const auto requested=static_cast<BufferMode>(m_comboMode->currentData().toInt());
+        const auto policy=static_cast<BackpressurePolicy>(m_comboPolicy->currentData().toInt());
+        const auto mode=BufferController::resolveMode(requested,producers,consumers,policy);
+        const auto wake=static_cast<WakeStrategy>(m_comboWake->currentData().toInt());
+        m_bufferController=new BufferController(m_spinBufferSize->value(),mode,wake,this);
+        m_bufferController->setBackpressure(policy,m_spinTimeout->value());
+        m_bufferController->setPriorityLanes(m_spinLanes->value());
+        logMessage(QString("存储模式: %1 -> %2，满时策略: %3").arg(m_comboMode->currentText(),
+                   m_comboMode->itemText(m_comboMode->findData(static_cast<int>(mode))),
+                   m_comboPolicy->currentText()));
     }
 
     connect(m_bufferController,&BufferController::logRequest,this,&QtProducerConsumerWidget::logMessage);
 
-    if(m_producerThread==nullptr)
+    for(int i=0;i<producers;++i)
     {
-        delete m_producerThread;
-        m_producerThread=new ProducerThread(m_bufferController,m_spinProduceSpeed->value(),this);
-        connect(m_producerThread,&ProducerThread::finished,this,&QtProducerConsumerWidget::onThreadFinished);
+        ProducerThread *producer=new ProducerThread(m_bufferController,m_spinProduceSpeed->value(),this);
+        producer->setBatchSize(m_spinBatchSize->value());
+        producer->setPayloadSize(m_spinPayloadSize->value());
+        producer->setUrgentPercent(m_spinUrgentPercent->value());
+        connect(producer,&ProducerThread::finished,this,&QtProducerConsumerWidget::onThreadFinished);
+        m_producers.append(producer);
     }
-    if(m_consumerThread==nullptr)
+    for(int i=0;i<consumers;++i)
     {
-        delete m_consumerThread;
-        m_consumerThread=new ConsumerThread(m_bufferController,m_spinConsumeSpeed->value(),this);
-        connect(m_consumerThread,&ConsumerThread::finished,this,&QtProducerConsumerWidget::onThreadFinished);
+        ConsumerThread *consumer=new ConsumerThread(m_bufferController,m_spinConsumeSpeed->value(),this);
+        consumer->setBatchSize(m_spinBatchSize->value());
+        connect(consumer,&ConsumerThread::finished,this,&QtProducerConsumerWidget::onThreadFinished);
+        m_consumers.append(consumer);
     }
+    m_runningThreads=producers+consumers;
+    m_lastProduced.fill(0,producers);
+    m_lastConsumed.fill(0,consumers);
 
-    m_producerThread->start();
-    m_consumerThread->start();
-    logMessage("系统启动完成");
+    m_lastStats=m_bufferController->stats();
+    m_lastContextSwitches=processContextSwitches();
+    m_statsClock.start();
+    m_statsTimer->start();
+
+    m_listBuffer->clear();
+    m_listFirstSeq=0;
+    m_listEndSeq=0;
+    m_publishTimer->start();
+
+    for(ProducerThread *producer:qAsConst(m_producers))
+    {
+        producer->start();
+    }
+    for(ConsumerThread *consumer:qAsConst(m_consumers))
+    {
+        consumer->start();
+    }
+    logMessage(QString("系统启动完成：%1 个生产者, %2 个消费者").arg(producers).arg(consumers));
 }
 
 void QtProducerConsumerWidget::onStopClicked()
 {
     logMessage("<<< 正在停止系统...");
-    m_btnStart->setEnabled(true);
     m_btnStop->setEnabled(false);
-    m_spinBufferSize->setEnabled(true);
 
     logMessage("请求停止生产者-消费者模型...");
 
@@ -202,15 +1227,15 @@ void QtProducerConsumerWidget::onStopClicked()
     {
         m_bufferController->stop();
     }
-    if(m_producerThread!=nullptr)
+    for(ProducerThread *producer:qAsConst(m_producers))
     {
-        m_producerThread->stop();
-        m_producerThread->requestInterruption();
+        producer->stop();
+        producer->requestInterruption();
     }
-    if(m_consumerThread!=nullptr)
+    for(ConsumerThread *consumer:qAsConst(m_consumers))
     {
-        m_consumerThread->stop();
-        m_consumerThread->requestInterruption();
+        consumer->stop();
+        consumer->requestInterruption();
     }
 }
 
@@ -231,26 +1256,333 @@ void QtProducerConsumerWidget::onThreadFinished()
     if(!senderThread){
         return; 
     }
-    if(senderThread==m_producerThread)
+    if(ProducerThread *producer=qobject_cast<ProducerThread*>(senderThread))
+    {
+        logMessage(QString("生产者线程 #%1 已完成").arg(m_producers.indexOf(producer)+1));
+    }
+    else if(ConsumerThread *consumer=qobject_cast<ConsumerThread*>(senderThread))
+    {
+        logMessage(QString("消费者线程 #%1 已完成").arg(m_consumers.indexOf(consumer)+1));
+    }
+
+    if(--m_runningThreads>0)
+    {
+        return;
+    }
+
+    m_statsTimer->stop();
+    m_publishTimer->stop();
+    publishBufferState();
+    updateStats();
+    for(ProducerThread *producer:qAsConst(m_producers))
+    {
+        producer->deleteLater();
+    }
+    for(ConsumerThread *consumer:qAsConst(m_consumers))
+    {
+        consumer->deleteLater();
+    }
+    m_producers.clear();
+    m_consumers.clear();
+    if(m_bufferController!=nullptr)
+    {
+        delete m_bufferController;
+        m_bufferController=nullptr;
+    }
+    logMessage("系统已安全停止");
+    m_btnStart->setEnabled(true);
+    setConfigEnabled(true);
+}
+
+void QtProducerConsumerWidget::updateStats()
+{
+    if(m_bufferController==nullptr)
+    {
+        return;
+    }
+
+    const BufferStats now=m_bufferController->stats();
+    const qint64 elapsedMs=m_statsClock.restart();
+    const quint64 items=now.consumedItems-m_lastStats.consumedItems;
+    if(elapsedMs>0)
+    {
+        m_lblThroughput->setText(QString("吞吐: %1 项/秒").arg(items*1000.0/elapsedMs,0,'f',0));
+    }
+    // 唤醒与上下文切换按本采样区间的增量折算到每一项
+    const qint64 contextSwitches=processContextSwitches();
+    if(items>0)
+    {
+        const double wakeups=double(now.wakeups-m_lastStats.wakeups)/items;
+        const double wasted=double(now.wastedWakeups-m_lastStats.wastedWakeups)/items;
+        QString text=QString("唤醒/项: %1 | 无效唤醒/项: %2").arg(wakeups,0,'f',2).arg(wasted,0,'f',2);
+        if(contextSwitches>=0 && m_lastContextSwitches>=0)
+        {
+            text+=QString(" | 上下文切换/项: %1").arg(double(contextSwitches-m_lastContextSwitches)/items,0,'f',2);
+        }
+        m_lblWakeups->setText(text);
+    }
+    m_lastContextSwitches=contextSwitches;
+
+    // 每线程吞吐：按各线程自己的计数求差
+    QStringList perThread;
+    for(int i=0;i<m_producers.size();++i)
+    {
+        const quint64 n=m_producers[i]->producedCount();
+        if(elapsedMs>0)
+        {
+            perThread<<QString("P%1 %2").arg(i+1).arg((n-m_lastProduced[i])*1000.0/elapsedMs,0,'f',0);
+        }
+        m_lastProduced[i]=n;
+    }
+    for(int i=0;i<m_consumers.size();++i)
+    {
+        const quint64 n=m_consumers[i]->consumedCount();
+        if(elapsedMs>0)
+        {
+            perThread<<QString("C%1 %2").arg(i+1).arg((n-m_lastConsumed[i])*1000.0/elapsedMs,0,'f',0);
+        }
+        m_lastConsumed[i]=n;
+    }
+    if(!perThread.isEmpty())
+    {
+        m_lblPerThread->setText("每线程 项/秒: "+perThread.join("  "));
+    }
+
+    if(!m_consumers.isEmpty())
+    {
+        // 各消费者的等待阶段计数求和，预算与平均等待取各消费者的均值
+        AdaptiveWaitStats wait;
+        qint64 budget=0;
+        quint64 avgNs=0;
+        for(ConsumerThread *consumer:qAsConst(m_consumers))
+        {
+            const AdaptiveWaitStats st=consumer->waitStats();
+            wait.immediate+=st.immediate;
+            wait.spins+=st.spins;
+            wait.yields+=st.yields;
+            wait.parks+=st.parks;
+            budget+=st.spinBudget;
+            avgNs+=st.avgWaitNs;
+        }
+        wait.spinBudget=static_cast<int>(budget/m_consumers.size());
+        wait.avgWaitNs=avgNs/static_cast<quint64>(m_consumers.size());
+        m_lblWaitPhases->setText(QString("消费者等待: 立即 %1 | 自旋 %2 | 让出 %3 | 休眠 %4 | 预算 %5 次 | 平均 %6 µs")
+                                 .arg(wait.immediate).arg(wait.spins).arg(wait.yields).arg(wait.parks)
+                                 .arg(wait.spinBudget).arg(wait.avgWaitNs/1000.0,0,'f',1));
+    }
+    // 优先级模式：各通道排队延迟（produce → 被取出）的分位数
+    QStringList laneLines;
+    for(int lane=0;lane<m_bufferController->laneCount() && m_bufferController->mode()==BufferMode::Priority;++lane)
+    {
+        const HistogramSnapshot h=m_bufferController->laneLatency(lane);
+        laneLines<<QString("通道 %1%2: %3 项 | p50 %4 µs | p99 %5 µs | p99.9 %6 µs | 最大 %7 µs")
+                   .arg(lane).arg(lane==0 ? "(紧急)" : "").arg(h.count)
+                   .arg(h.percentile(0.5)/1000.0,0,'f',1).arg(h.percentile(0.99)/1000.0,0,'f',1)
+                   .arg(h.percentile(0.999)/1000.0,0,'f',1).arg(h.max/1000.0,0,'f',1);
+    }
+    m_lblLaneLatency->setText(laneLines.join('\n'));
+
+    // 平均批量按累计值计算，反映“实际”每次交接了多少项（缓冲区不足时会小于设定值）
+    const double avgProduce=now.produceCalls>0 ? double(now.producedItems)/now.produceCalls : 0.0;
+    const double avgConsume=now.consumeCalls>0 ? double(now.consumedItems)/now.consumeCalls : 0.0;
+    m_lblBatch->setText(QString("平均批量: 生产 %1 / 消费 %2").arg(avgProduce,0,'f',1).arg(avgConsume,0,'f',1));
+    m_lblBackpressure->setText(QString("背压: 丢弃 %1 | 覆盖 %2 | 拒绝 %3 | 超时 %4 | 阻塞 %5 ms")
+                               .arg(now.droppedItems).arg(now.overwrittenItems)
+                               .arg(now.rejectedItems).arg(now.timedOutItems)
+                               .arg(now.blockedNs/1000000));
+    m_lastStats=now;
+}
+
+void QtProducerConsumerWidget::publishBufferState()
+{
+    if(m_bufferController==nullptr)
+    {
+        return;
+    }
+
+    const BufferStats now=m_bufferController->stats();
+    // 被覆盖的旧帧和被消费的一样从队头离开，序号区间的起点要把两者都算上
+    const quint64 removedItems=now.consumedItems+now.overwrittenItems;
+
+    // 1. 出队增量：从列表头部删除已被消费（或覆盖）的序号
+    while (m_listFirstSeq<removedItems && m_listBuffer->count()>0)
+    {
+        delete m_listBuffer->takeItem(0);
+        ++m_listFirstSeq;
+    }
+    m_listFirstSeq=qMax(m_listFirstSeq,removedItems);
+    m_listEndSeq=qMax(m_listEndSeq,m_listFirstSeq);
+
+    // 2. 入队增量：只追加上一帧之后新生产的序号
+    while (m_listEndSeq<now.producedItems)
+    {
+        int value=0;
+        const auto lookup=m_bufferController->recentValue(m_listEndSeq,value);
+        if(lookup==BufferController::RecentLookup::Pending)
+        {
+            break; // 值还在写入，下一帧再取
+        }
+        // 环装得下缓冲区的全部内容，仍在缓冲区里的序号不会被覆盖；
+        // Lost 只出现在读取统计之后该项又被消费、槽位被新序号占用的窗口里，显示为 “?”，下一帧就会从头部删掉
+        m_listBuffer->addItem(lookup==BufferController::RecentLookup::Ready ? QString::number(value) : QString("?"));
+        ++m_listEndSeq;
+    }
+
+    const quint64 occupancy=now.producedItems>removedItems ? now.producedItems-removedItems : 0;
+    m_lblStatus->setText(QString("占用: %1 | 满等待: %2 | 空等待: %3")
+                         .arg(occupancy).arg(now.fullWaits).arg(now.emptyWaits));
+}
+
+void QtProducerConsumerWidget::onBenchmarkClicked()
+{
+    if(m_benchWatcher->isRunning())
+    {
+        return;
+    }
+    const int capacity=m_spinBufferSize->value();
+    const int count=1000000;
+    m_btnBenchmark->setEnabled(false);
+    logMessage(QString(">>> SPSC 基准测试开始 (%1 项)...").arg(count));
+    m_benchWatcher->setFuture(QtConcurrent::run([capacity, count] {
+        return runSpscBenchmark(capacity, count);
+    }));
+}
+
+void QtProducerConsumerWidget::onBenchmarkFinished()
+{
+    logMessage(m_benchWatcher->result());
+    m_btnBenchmark->setEnabled(true);
+}
+
+void QtProducerConsumerWidget::onSweepClicked()
+{
+    if(m_sweepWatcher->isRunning())
+    {
+        // 再次点击为取消：当前这一格跑完后停止
+        m_sweepCancel=true;
+        m_btnSweep->setEnabled(false);
+        return;
+    }
+
+    ScalingConfig cfg;
+    cfg.capacity=m_spinBufferSize->value();
+    cfg.requested=static_cast<BufferMode>(m_comboMode->currentData().toInt());
+    cfg.wake=static_cast<WakeStrategy>(m_comboWake->currentData().toInt());
+    cfg.batchSize=m_spinBatchSize->value();
+    cfg.durationMs=m_spinSweepMs->value();
+    const int maxProducers=m_spinProducers->value();
+    const int maxConsumers=m_spinConsumers->value();
+
+    m_sweepMode=cfg.requested;
+    m_tableSweep->clear();
+    m_tableSweep->setRowCount(maxProducers);
+    m_tableSweep->setColumnCount(maxConsumers);
+    QStringList rows, columns;
+    for(int p=1;p<=maxProducers;++p)
+    {
+        rows<<QString("P=%1").arg(p);
+    }
+    for(int c=1;c<=maxConsumers;++c)
     {
-        m_producerThread=nullptr;
-        logMessage("生产者线程已完成");
+        columns<<QString("C=%1").arg(c);
     }
-    else if(senderThread==m_consumerThread)
+    m_tableSweep->setVerticalHeaderLabels(rows);
+    m_tableSweep->setHorizontalHeaderLabels(columns);
+
+    m_sweepCancel=false;
+    m_btnSweep->setText("取消扫描");
+    m_btnExportCsv->setEnabled(false);
+    logMessage(QString(">>> 扩展性扫描开始: %1, %2×%3, 每格 %4 ms")
+               .arg(m_comboMode->currentText()).arg(maxProducers).arg(maxConsumers).arg(cfg.durationMs));
+
+    m_sweepWatcher->setFuture(QtConcurrent::run([this, cfg, maxProducers, maxConsumers] {
+        for(int p=1;p<=maxProducers;++p)
+        {
+            for(int c=1;c<=maxConsumers;++c)
+            {
+                if(m_sweepCancel)
+                {
+                    return;
+                }
+                const double rate=runScalingCell(cfg,p,c);
+                // 每格跑完就回到 UI 线程填表，不必等整张表
+                QMetaObject::invokeMethod(this, [this, p, c, rate] {
+                    setSweepCell(p,c,rate);
+                }, Qt::QueuedConnection);
+            }
+        }
+    }));
+}
+
+void QtProducerConsumerWidget::setSweepCell(int producers, int consumers, double itemsPerSec)
+{
+    QTableWidgetItem *cell=new QTableWidgetItem(QString::number(itemsPerSec,'f',0));
+    cell->setData(Qt::UserRole,itemsPerSec);
+    const BufferMode mode=BufferController::resolveMode(m_sweepMode,producers,consumers);
+    cell->setToolTip(m_comboMode->itemText(m_comboMode->findData(static_cast<int>(mode))));
+    m_tableSweep->setItem(producers-1,consumers-1,cell);
+
+    // 热力图：按当前最大值归一化，蓝（低）→ 红（高）
+    double maxRate=0.0;
+    for(int r=0;r<m_tableSweep->rowCount();++r)
+    {
+        for(int c=0;c<m_tableSweep->columnCount();++c)
+        {
+            if(QTableWidgetItem *item=m_tableSweep->item(r,c))
+            {
+                maxRate=qMax(maxRate,item->data(Qt::UserRole).toDouble());
+            }
+        }
+    }
+    for(int r=0;r<m_tableSweep->rowCount();++r)
     {
-        m_consumerThread=nullptr;
-        logMessage("消费者线程已完成");
+        for(int c=0;c<m_tableSweep->columnCount();++c)
+        {
+            if(QTableWidgetItem *item=m_tableSweep->item(r,c))
+            {
+                const double ratio=maxRate>0 ? item->data(Qt::UserRole).toDouble()/maxRate : 0.0;
+                item->setBackground(QColor::fromHsvF((1.0-ratio)*240.0/360.0,0.5,1.0));
+            }
+        }
     }
+}
 
-    if(!m_producerThread && !m_consumerThread)
+void QtProducerConsumerWidget::onSweepFinished()
+{
+    logMessage(m_sweepCancel ? "扩展性扫描已取消" : "扩展性扫描完成");
+    m_btnSweep->setText("开始扫描");
+    m_btnSweep->setEnabled(true);
+    m_btnExportCsv->setEnabled(true);
+}
+
+void QtProducerConsumerWidget::onExportCsvClicked()
+{
+    const QString path=QFileDialog::getSaveFileName(this,"导出扫描结果","scaling.csv","CSV (*.csv)");
+    if(path.isEmpty())
     {
-        if(m_bufferController!=nullptr)
+        return;
+    }
+    QFile file(path);
+    if(!file.open(QIODevice::WriteOnly|QIODevice::Text))
+    {
+        logMessage(QString("无法写入 %1").arg(path));
+        return;
+    }
+    QTextStream out(&file);
+    out<<"mode,resolved_mode,producers,consumers,items_per_sec\n";
+    const QString modeName=m_comboMode->itemText(m_comboMode->findData(static_cast<int>(m_sweepMode)));
+    for(int r=0;r<m_tableSweep->rowCount();++r)
+    {
+        for(int c=0;c<m_tableSweep->columnCount();++c)
         {
-            delete m_bufferController;
-            m_bufferController=nullptr;
+            const QTableWidgetItem *item=m_tableSweep->item(r,c);
+            if(item==nullptr)
+            {
+                continue;
+            }
+            out<<'"'<<modeName<<"\",\""<<item->toolTip()<<"\","<<(r+1)<<','<<(c+1)<<','
+               <<QString::number(item->data(Qt::UserRole).toDouble(),'f',0)<<'\n';
         }
-        logMessage("系统已安全停止");
-        m_btnStart->setEnabled(true);
-        m_spinBufferSize->setEnabled(true);
     }
-}
\ No newline at end of file
+    logMessage(QString("扫描结果已导出到 %1").arg(path));
+}
@@ -13,42 +13,235 @@
 #include<QWaitCondition>
 #include<QMutex>
 #include<QVector>
+#include<QComboBox>
+#include<QTableWidget>
+#include<QTimer>
+#include<QElapsedTimer>
+#include<QFutureWatcher>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include "adaptivewait.h"
+#include "boundedqueue.h"
+#include "latencyhistogram.h"
+#include "mpmcringbuffer.h"
+#include "prioritylanes.h"
+#include "spscringbuffer.h"
 
+// 缓冲区存储后端
+enum class BufferMode {
+    Mutex,        // BoundedQueue：QMutex + QWaitCondition 保护的环形槽位
+    LockFreeRing, // 无锁 MPMC 环形队列，只在满/空时才阻塞
+    Spsc,         // 单生产者/单消费者无锁环，仅 1:1 时可用
+    Priority,     // PriorityLanes：K 条优先级通道，位图 O(1) 选通道 + 加权轮询防饿死
+    Auto          // 按生产者/消费者数量自动选择（见 BufferController::resolveMode）
+};
+
+// 缓冲区满时 produce 的处理策略（背压）
+enum class BackpressurePolicy {
+    Block,           // 阻塞等待空位（默认）
+    DropNewest,      // 丢弃当前这一帧，生产者从不阻塞
+    DropOldest,      // 覆盖最旧的一帧，缓冲区里始终是最新数据
+    Reject,          // 不放入并返回 Rejected，由调用方决定重试或丢弃
+    BlockWithTimeout // 最多阻塞指定毫秒，超时返回 TimedOut
+};
+
+// 单帧 produce 的结果
+enum class ProduceStatus {
+    Ok,        // 已放入
+    Overwrote, // 已放入，同时覆盖了最旧的一帧
+    Dropped,   // 缓冲区满，按 DropNewest 丢弃
+    Rejected,  // 缓冲区满，按 Reject 拒绝（帧仍归调用方所有）
+    TimedOut,  // 等待超时（帧仍归调用方所有）
+    Stopped    // 已停止
+};
+
+// 在生产者与消费者之间传递的数据帧：
+// value 用于界面显示，payload 模拟大消息体，全程只 move（交接的是缓冲区指针，不拷贝内容）
+struct Frame {
+    int value = 0;
+    std::vector<char> payload;
+    int lane = 0;          // 优先级通道，0 最高（仅 Priority 模式使用）
+    qint64 enqueueNs = 0;  // 进入 produce 的时刻（Priority 模式下用于统计各通道的排队延迟）
+};
 
+// 吞吐统计快照（单调递增的累计值，由 UI 定时采样求差）
+struct BufferStats {
+    quint64 producedItems = 0;
+    quint64 consumedItems = 0;
+    quint64 produceCalls = 0;  // produce/produceBatch 调用次数
+    quint64 consumeCalls = 0;  // consume/consumeBatch 调用次数
+    quint64 fullWaits = 0;     // 生产者因缓冲区满而休眠的次数
+    quint64 emptyWaits = 0;    // 消费者因缓冲区空而休眠的次数
+    // 背压统计
+    quint64 droppedItems = 0;     // DropNewest 丢弃的帧数
+    quint64 overwrittenItems = 0; // DropOldest 覆盖掉的旧帧数
+    quint64 rejectedItems = 0;    // Reject 拒绝的帧数
+    quint64 timedOutItems = 0;    // BlockWithTimeout 超时的帧数
+    quint64 blockedNs = 0;        // 生产者因缓冲区满而阻塞的累计时长
+    // 唤醒统计：每次唤醒约等于一次上下文切换
+    quint64 wakeups = 0;       // 等待线程被唤醒的次数
+    quint64 wastedWakeups = 0; // 醒来后条件仍不满足、只能再次休眠的次数
+};
 
 class BufferController : public QObject
 {
     Q_OBJECT
 public:
-    explicit BufferController(int maxsize,QObject *parent = nullptr):
-    QObject(parent),m_maxSize(maxsize)
+    // wake 只对互斥锁模式有效；无锁环的慢路径始终按等待者计数唤醒
+    explicit BufferController(int maxsize,BufferMode mode = BufferMode::Mutex,
+                              WakeStrategy wake = WakeStrategy::Counted,QObject *parent = nullptr):
+    QObject(parent),m_mode(mode)
     {
-        
+        const auto capacity=static_cast<std::size_t>(maxsize);
+        m_capacity=capacity;
+        switch (m_mode)
+        {
+        case BufferMode::LockFreeRing:
+            m_ring.reset(new MpmcRingBuffer<Frame>(capacity));
+            break;
+        case BufferMode::Spsc:
+            m_spsc.reset(new SpscRingBuffer<Frame>(capacity));
+            break;
+        case BufferMode::Priority:
+            setPriorityLanes(kDefaultLanes);
+            break;
+        default:
+            m_mode=BufferMode::Mutex;
+            m_queue.reset(new BoundedQueue<Frame>(capacity,wake));
+            break;
+        }
+        // 初始序号记为 -1，保证序号 0 在写入前被判定为“未就绪”
+        for(auto &entry:m_recent)
+        {
+            entry.store(quint64(0xFFFFFFFFu)<<32,std::memory_order_relaxed);
+        }
     }
 
-    // 生产数据（供生产者调用）
-    void produce(int data);
-    // 消费数据（供消费者调用）
-    int consume();
+    // 设置缓冲区满时的处理策略，需在生产者启动前调用；timeoutMs 仅对 BlockWithTimeout 有效
+    void setBackpressure(BackpressurePolicy policy, int timeoutMs = 0)
+    {
+        m_policy=policy;
+        m_timeoutMs=timeoutMs;
+    }
+    BackpressurePolicy backpressure() const { return m_policy; }
+
+    // 生产一帧（供生产者调用），满时按背压策略处理；帧只在 Rejected/TimedOut 时仍归调用方
+    ProduceStatus produce(Frame &&frame);
+    // 消费一帧（供消费者调用），空时阻塞；已停止返回 false
+    // 传入 waiter 时无锁环模式下先自旋/让出再休眠（互斥锁模式由 BoundedQueue 直接休眠，忽略 waiter）
+    bool consume(Frame &out, AdaptiveWaiter *waiter = nullptr);
+
+    // 批量生产：一次加锁/一次唤醒放入多帧（帧被 move 走），缓冲区满时分段阻塞；返回实际放入的数量
+    // 非 Block 策略下逐帧按策略处理，返回值同样是放入的数量
+    int produceBatch(Frame *frames, int count);
+    // 批量消费：至少等到一帧，然后一次取走最多 maxItems 帧追加到 out；停止时返回 0
+    int consumeBatch(std::vector<Frame> &out, int maxItems, AdaptiveWaiter *waiter = nullptr);
+
+    // 累计吞吐统计
+    BufferStats stats() const;
 
-    // 设置最大容量
-    void setMaxSize(int size) { m_maxSize = size; }
+    // 最近生产的数据按全局序号记录在一个小环里，供 UI 做增量显示：
+    // 缓冲区内容约等于序号区间 [consumedItems, producedItems) 的数据
+    // 界面允许的缓冲区大小和优先级通道数上限；Priority 模式每条通道都是缓冲区大小，
+    // 缓冲区里最多能有 kMaxPriorityLanes × kMaxBufferSize 项
+    static constexpr int kMaxBufferSize = 100;
+    static constexpr int kMaxPriorityLanes = 8;
+    static constexpr int kRecentCapacity = 1024; // 2 的幂，且大于缓冲区最多能容纳的项数
+    enum class RecentLookup {
+        Ready,   // 取到了该序号的值
+        Pending, // 序号已分配，值还没写入
+        Lost     // 已被更新的序号覆盖
+    };
+    RecentLookup recentValue(quint64 seq, int &value) const;
+    static_assert((kRecentCapacity & (kRecentCapacity - 1)) == 0, "kRecentCapacity 必须是 2 的幂");
+    static_assert(kRecentCapacity > kMaxPriorityLanes * kMaxBufferSize, "最近数据环必须装得下缓冲区的全部内容");
+
+    BufferMode mode() const { return m_mode; }
+
+    // Priority 模式：重建为 lanes 条通道（每条容量都是缓冲区大小），需在生产者启动前调用
+    static constexpr int kDefaultLanes = 3;
+    void setPriorityLanes(int lanes);
+    int laneCount() const { return m_lanes ? m_lanes->laneCount() : 1; }
+    // 某条通道从 produce 到被消费的延迟分布（纳秒）
+    HistogramSnapshot laneLatency(int lane) const;
+
+    // 把界面上选择的模式解析为实际可用的后端：Auto 在 1:1 时选 SPSC，否则选 MPMC 环；
+    // SPSC 在多生产者/消费者时同样退回 MPMC 环；DropOldest 需要生产者出队覆盖旧帧，也不能用 SPSC
+    static BufferMode resolveMode(BufferMode requested, int producers, int consumers,
+                                  BackpressurePolicy policy = BackpressurePolicy::Block);
 
     // 停止并唤醒所有等待线程
     void stop();
 
 signals:
-    // 通知 UI 更新的信号
-    void bufferUpdated(const QVector<int> &currentBuffer);
+    // 低频事件日志（启动/停止等），逐项数据变化由 UI 定时拉取，不再逐项发信号
     void logRequest(const QString &msg);
 
 private:
-    QVector<int> m_buffer;
-    int m_maxSize;
-    bool m_stop = false; // 停止标志
+    // 非 Block 策略下放入一帧
+    ProduceStatus produceWithPolicy(Frame &frame);
+    // Priority 模式下按背压策略放入一帧（含 Block）
+    ProduceStatus producePriority(Frame &frame);
+    // Priority 模式下记录出队帧的排队延迟
+    void recordLaneLatency(const Frame &frame, qint64 nowNs);
+    // 无锁环形队列模式下的批量生产/消费
+    int produceBatchLockFree(Frame *frames, int count);
+    int consumeBatchLockFree(std::vector<Frame> &out, int maxItems, AdaptiveWaiter *waiter);
+    // 非阻塞地访问当前的无锁环（MPMC 或 SPSC）
+    bool tryPushRing(Frame &frame);
+    bool tryPopRing(Frame &frame);
+    // 放入/取出一帧，满/空时阻塞；停止或超时（timeoutMs >= 0）时返回 false
+    bool pushLockFree(Frame &frame, int timeoutMs = -1);
+    bool popLockFree(Frame &frame, AdaptiveWaiter *waiter = nullptr);
+    // 消费者休眠一轮：登记为等待者后若环仍为空则等待唤醒（供 AdaptiveWaiter 的 park 阶段使用）
+    void parkConsumer();
+    std::size_t ringSizeApprox() const;
+    // 分配序号并记录最近生产的数据（不持锁，写原子槽位）
+    void recordProduced(int value);
+    // 仅在确有线程等待时才加锁唤醒（一个或全部），避免无谓的加锁
+    void wakeIfWaiting(std::atomic<int> &waiters, QWaitCondition &cond, bool all);
+
+    BufferMode m_mode;
+    BackpressurePolicy m_policy = BackpressurePolicy::Block;
+    int m_timeoutMs = 0;
+    std::atomic<bool> m_stop{false}; // 停止标志（无锁路径上不持锁读取）
+
+    std::size_t m_capacity = 0;
+
+    // 互斥锁模式
+    std::unique_ptr<BoundedQueue<Frame>> m_queue;
+
+    // 优先级模式：通道队列 + 每条通道的延迟直方图
+    std::unique_ptr<PriorityLanes<Frame>> m_lanes;
+    std::vector<std::unique_ptr<LatencyHistogram>> m_laneLatency;
+
+    // 无锁模式：环形队列 + 等待者计数（满/空时才借用 m_mutex 与条件变量休眠）
+    std::unique_ptr<MpmcRingBuffer<Frame>> m_ring;
+    std::unique_ptr<SpscRingBuffer<Frame>> m_spsc;
     QMutex m_mutex;
     QWaitCondition m_bufferNotFull;  // 条件变量：缓冲区不满（可以生产）
     QWaitCondition m_bufferNotEmpty; // 条件变量：缓冲区不空（可以消费）
+    std::atomic<int> m_waitingProducers{0};
+    std::atomic<int> m_waitingConsumers{0};
+
+    // 吞吐统计
+    std::atomic<quint64> m_producedItems{0};
+    std::atomic<quint64> m_consumedItems{0};
+    std::atomic<quint64> m_produceCalls{0};
+    std::atomic<quint64> m_consumeCalls{0};
+    std::atomic<quint64> m_fullWaits{0};
+    std::atomic<quint64> m_emptyWaits{0};
+    std::atomic<quint64> m_droppedItems{0};
+    std::atomic<quint64> m_overwrittenItems{0};
+    std::atomic<quint64> m_rejectedItems{0};
+    std::atomic<quint64> m_timedOutItems{0};
+    std::atomic<quint64> m_blockedNs{0};
+    std::atomic<quint64> m_wakeups{0};
+    std::atomic<quint64> m_wastedWakeups{0};
+
+    // 每个槽位存 (序号低32位 << 32 | 数据)，一次原子读即可判断是否对应所需序号
+    std::atomic<quint64> m_recent[kRecentCapacity];
 };
 
 class ProducerThread : public QThread
@@ -62,7 +255,15 @@ public:
     }
 
     void setInterval(int interval) { m_interval = interval; }
+    // 每次交接的数据项数，1 表示逐项调用 produce()
+    void setBatchSize(int size) { m_batchSize = size; }
+    // 每帧附带的负载字节数（模拟大消息）
+    void setPayloadSize(int bytes) { m_payloadSize = bytes; }
+    // Priority 模式下发往通道 0（紧急）的帧所占百分比，其余均匀分到低优先级通道
+    void setUrgentPercent(int percent) { m_urgentPercent = percent; }
     void stop() { m_running = false; }
+    // 本线程成功放入缓冲区的帧数（可在 UI 线程读取）
+    quint64 producedCount() const { return m_produced.load(std::memory_order_relaxed); }
 
 
 protected:
@@ -71,7 +272,11 @@ protected:
 private:
     BufferController *m_controller;
     int m_interval; // 生产间隔（毫秒）
+    int m_batchSize = 1;
+    int m_payloadSize = 0;
+    int m_urgentPercent = 0;
     bool m_running = true; // 运行标志
+    std::atomic<quint64> m_produced{0};
 };
 
 
@@ -86,7 +291,13 @@ public:
     }
 
     void setInterval(int interval) { m_interval = interval; }
+    // 每次交接的数据项数，1 表示逐项调用 consume()
+    void setBatchSize(int size) { m_batchSize = size; }
     void stop() { m_running = false; }
+    // 自旋/让出/休眠各阶段的命中统计（可在 UI 线程读取）
+    AdaptiveWaitStats waitStats() const { return m_waiter.stats(); }
+    // 本线程取到的帧数（可在 UI 线程读取）
+    quint64 consumedCount() const { return m_consumed.load(std::memory_order_relaxed); }
 
 
 protected:
@@ -95,7 +306,10 @@ protected:
 private:
     BufferController *m_controller;
     int m_interval; // 生产间隔（毫秒）
+    int m_batchSize = 1;
     bool m_running = true; // 运行标志
+    AdaptiveWaiter m_waiter;
+    std::atomic<quint64> m_consumed{0};
 };
 
 class QtProducerConsumerWidget : public QWidget
@@ -103,6 +317,7 @@ class QtProducerConsumerWidget : public QWidget
     Q_OBJECT
 public:
     explicit QtProducerConsumerWidget(QWidget *parent = nullptr);
+    ~QtProducerConsumerWidget();
 
 private slots:
     void onStartClicked();
@@ -111,26 +326,77 @@ private slots:
 
     void onThreadFinished();
     void logMessage(const QString &msg);
+    void updateStats(); // 定时刷新吞吐与批量统计
+    void publishBufferState(); // 按显示帧率拉取缓冲区快照，增量更新 m_listBuffer
+    void onBenchmarkClicked();     // SPSC vs 互斥锁队列 1:1 交接基准测试
+    void onBenchmarkFinished();
+    void onSweepClicked();         // 1..N 生产者 × 1..M 消费者扩展性扫描
+    void onSweepFinished();
+    void onExportCsvClicked();
 
 private:
     void setupUi();
+    void setConfigEnabled(bool enabled); // 运行期间锁定配置控件
+    void setSweepCell(int producers, int consumers, double itemsPerSec);
     
 
     // UI 控件
+    QComboBox *m_comboMode;       // 存储后端
+    QComboBox *m_comboPolicy;     // 背压策略
+    QComboBox *m_comboWake;       // 互斥锁模式的唤醒策略
+    QSpinBox *m_spinTimeout;      // BlockWithTimeout 的超时（毫秒）
     QSpinBox *m_spinBufferSize;
     QSpinBox *m_spinProduceSpeed; // 毫秒
     QSpinBox *m_spinConsumeSpeed; // 毫秒
+    QSpinBox *m_spinBatchSize;
+    QSpinBox *m_spinPayloadSize; // 每帧负载字节数
+    QSpinBox *m_spinProducers;
+    QSpinBox *m_spinConsumers;
+    QSpinBox *m_spinLanes;         // Priority 模式的通道数
+    QSpinBox *m_spinUrgentPercent; // 紧急帧占比
     
     QPushButton *m_btnStart;
     QPushButton *m_btnStop;
     QPushButton *m_btnClearLog;
+    QPushButton *m_btnBenchmark;
+    QFutureWatcher<QString> *m_benchWatcher;
 
     QListWidget *m_listBuffer; // 可视化缓冲区
     QTextEdit *m_logViewer;
     QLabel *m_lblStatus;
+    QLabel *m_lblThroughput;   // 吞吐（项/秒）
+    QLabel *m_lblBatch;        // 实际平均批量
+    QLabel *m_lblBackpressure; // 丢弃/覆盖/拒绝/超时计数与阻塞时长
+    QLabel *m_lblWakeups;      // 每项的唤醒次数 / 无效唤醒 / 上下文切换
+    QLabel *m_lblWaitPhases;   // 消费者自适应等待各阶段命中次数
+    QLabel *m_lblPerThread;    // 每个生产者/消费者线程的吞吐
+    QLabel *m_lblLaneLatency;  // Priority 模式下各通道的排队延迟分位数
+
+    // 扩展性扫描：行 = 生产者数，列 = 消费者数，单元格为项/秒
+    QSpinBox *m_spinSweepMs;   // 每格运行时长
+    QPushButton *m_btnSweep;
+    QPushButton *m_btnExportCsv;
+    QTableWidget *m_tableSweep;
+    QFutureWatcher<void> *m_sweepWatcher;
+    std::atomic<bool> m_sweepCancel{false};
+    BufferMode m_sweepMode = BufferMode::Auto; // 扫描时选择的存储模式（每格再按 P×C 解析）
+
+    // 缓冲区显示：m_listBuffer 当前对应序号区间 [m_listFirstSeq, m_listEndSeq)
+    QTimer *m_publishTimer;
+    quint64 m_listFirstSeq = 0;
+    quint64 m_listEndSeq = 0;
+
+    // 吞吐统计采样
+    QTimer *m_statsTimer;
+    QElapsedTimer m_statsClock;
+    BufferStats m_lastStats;
+    qint64 m_lastContextSwitches = -1;
+    QVector<quint64> m_lastProduced; // 每线程计数的上次采样值
+    QVector<quint64> m_lastConsumed;
 
     // 线程成员变量
-    ProducerThread *m_producerThread=nullptr;
-    ConsumerThread *m_consumerThread=nullptr;   
+    QVector<ProducerThread*> m_producers;
+    QVector<ConsumerThread*> m_consumers;
+    int m_runningThreads=0;
     BufferController *m_bufferController=nullptr;
 };
@@ -1,116 +1,22 @@
 #include "qtreaderswriterswidget.h"
 #include <QDateTime>
+#include <QHeaderView>
+#include <chrono>
 
-// ============================
-// SharedDataStore 实现
-// ============================
+namespace {
 
-/*
- * 构造函数：初始化状态
- */
-SharedDataStore::SharedDataStore(QObject* parent)
-    : QObject(parent) {}
-
-/*
- * 设置访问策略
- */
-void SharedDataStore::setPolicy(AccessPolicy policy) {
-  QMutexLocker locker(&gateMutex_);
-  policy_ = policy;
-  // 策略变更后，适当唤醒等待队列，避免长时间等待
-  // 公平做法：唤醒一个写者，唤醒全部读者，让他们重新评估条件
-  writersQueue_.wakeOne();
-  readersQueue_.wakeAll();
+// 从 begin 到现在经过的纳秒数
+quint64 elapsedNs(std::chrono::steady_clock::time_point begin) {
+  return static_cast<quint64>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now() - begin).count());
 }
 
-/*
- * 读者开始访问：根据策略判断是否需要等待
- * - WriterPreference：若有写者等待或有活动写者，读者需要等待
- * - ReaderPreference：读者尽量快进入，只有活动写者时才等待
- * - Fair：基本公平，写者等待时优先安排写者
- */
-void SharedDataStore::beginRead() {
-  QMutexLocker locker(&gateMutex_);
-  ++waitingReaders_;
-
-  while (activeWriter_ ||
-         (policy_ == AccessPolicy::WriterPreference && waitingWriters_ > 0)) {
-    readersQueue_.wait(&gateMutex_);
-  }
-
-  --waitingReaders_;
-  ++activeReaders_;
+// 纳秒 -> 表格里显示的微秒
+QString formatUs(quint64 ns) {
+  return QString::number(ns / 1000.0, 'f', 1);
 }
 
-/*
- * 读者结束访问：如果没有读者了，唤醒一个写者
- */
-void SharedDataStore::endRead() {
-  QMutexLocker locker(&gateMutex_);
-  --activeReaders_;
-  if (activeReaders_ == 0) {
-    // 读者全部退出后，优先让写者进行
-    writersQueue_.wakeOne();
-  }
-}
-
-/*
- * 写者开始访问：必须等待所有读者退出以及写者空闲
- */
-void SharedDataStore::beginWrite() {
-  QMutexLocker locker(&gateMutex_);
-  ++waitingWriters_;
-
-  while (activeWriter_ || activeReaders_ > 0) {
-    writersQueue_.wait(&gateMutex_);
-  }
-
-  --waitingWriters_;
-  activeWriter_ = true;
-}
-
-/*
- * 写者结束访问：根据策略唤醒后续访问者
- * - WriterPreference：若仍有写者在等，继续唤醒写者；否则唤醒所有读者
- * - ReaderPreference：优先唤醒所有读者；若无读者，则唤醒一个写者
- * - Fair：若有写者在等，唤醒一个写者；同时也唤醒读者，让他们重新竞争
- */
-void SharedDataStore::endWrite() {
-  QMutexLocker locker(&gateMutex_);
-  activeWriter_ = false;
-
-  switch (policy_) {
-    case AccessPolicy::WriterPreference:
-      if (waitingWriters_ > 0) writersQueue_.wakeOne();
-      else readersQueue_.wakeAll();
-      break;
-    case AccessPolicy::ReaderPreference:
-      if (waitingReaders_ > 0) readersQueue_.wakeAll();
-      else if (waitingWriters_ > 0) writersQueue_.wakeOne();
-      break;
-    case AccessPolicy::Fair:
-      if (waitingWriters_ > 0) writersQueue_.wakeOne();
-      // 公平策略下也允许读者竞争进入
-      readersQueue_.wakeAll();
-      break;
-  }
-}
-
-/*
- * 执行读取：需要持有读锁
- */
-QString SharedDataStore::readValue() const {
-  QReadLocker locker(&rwLock_);
-  return payload_;
-}
-
-/*
- * 执行写入：需要持有写锁
- */
-void SharedDataStore::writeValue(const QString& value) {
-  QWriteLocker locker(&rwLock_);
-  payload_ = value;
-}
+}  // namespace
 
 // ============================
 // ReaderThread 实现
@@ -137,8 +43,10 @@ void ReaderThread::run() {
   while (running_ && !isInterruptionRequested()) {
     msleep(intervalMs_);
 
-    // 访问开始
+    // 访问开始（记录获取读权限花了多久）
+    const auto waitBegin = std::chrono::steady_clock::now();
     store_->beginRead();
+    waitHistogram_.record(elapsedNs(waitBegin));
 
     // 执行读取（持有读锁）
     const QString value = store_->readValue();
@@ -175,8 +83,10 @@ void WriterThread::run() {
   while (running_ && !isInterruptionRequested()) {
     msleep(intervalMs_);
 
-    // 访问开始
+    // 访问开始（记录获取写权限花了多久）
+    const auto waitBegin = std::chrono::steady_clock::now();
     store_->beginWrite();
+    waitHistogram_.record(elapsedNs(waitBegin));
 
     // 执行写入（持有写锁）
     const QString newValue =
@@ -254,6 +164,9 @@ void QtReadersWritersWidget::setupUi() {
   comboPolicy_->addItem("读者优先", static_cast<int>(AccessPolicy::ReaderPreference));
   comboPolicy_->addItem("写者优先", static_cast<int>(AccessPolicy::WriterPreference));
   comboPolicy_->addItem("公平", static_cast<int>(AccessPolicy::Fair));
+  comboPolicy_->addItem("顺序锁 (SeqLock)", static_cast<int>(AccessPolicy::SeqLock));
+  comboPolicy_->addItem("RCU 快照", static_cast<int>(AccessPolicy::Rcu));
+  comboPolicy_->addItem("分片读者计数", static_cast<int>(AccessPolicy::ShardedReaders));
   ctlLayout->addWidget(comboPolicy_);
 
   // 按钮
@@ -267,6 +180,26 @@ void QtReadersWritersWidget::setupUi() {
 
   mainLayout->addWidget(grpControl);
 
+  // 统计区：等待时间单位为微秒，吞吐为最近一个统计周期的每秒次数
+  auto* grpStats = new QGroupBox("等待时间与吞吐（按策略）", this);
+  auto* statsLayout = new QVBoxLayout(grpStats);
+  statsTable_ = new QTableWidget(comboPolicy_->count(), 11, this);
+  statsTable_->setHorizontalHeaderLabels({"策略",
+                                          "读 p50(µs)", "读 p99(µs)", "读 p99.9(µs)", "读 最大(µs)", "读/秒",
+                                          "写 p50(µs)", "写 p99(µs)", "写 p99.9(µs)", "写 最大(µs)", "写/秒"});
+  statsTable_->verticalHeader()->setVisible(false);
+  statsTable_->setEditTriggers(QAbstractItemView::NoEditTriggers);
+  statsTable_->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+  for (int row = 0; row < comboPolicy_->count(); ++row) {
+    statsTable_->setItem(row, 0, new QTableWidgetItem(comboPolicy_->itemText(row)));
+  }
+  statsLayout->addWidget(statsTable_);
+  mainLayout->addWidget(grpStats);
+
+  statsTimer_ = new QTimer(this);
+  statsTimer_->setInterval(500);
+  connect(statsTimer_, &QTimer::timeout, this, &QtReadersWritersWidget::updateStats);
+
   // 日志区
   auto* grpLog = new QGroupBox("运行日志", this);
   auto* logLayout = new QVBoxLayout(grpLog);
@@ -320,6 +253,13 @@ void QtReadersWritersWidget::onStartClicked() {
     th->start();
   }
 
+  // 统计从零开始，结果写到当前策略那一行
+  statsRow_ = comboPolicy_->currentIndex();
+  lastReads_ = 0;
+  lastWrites_ = 0;
+  statsClock_.start();
+  statsTimer_->start();
+
   appendLog(">>> 系统已启动");
 }
 
@@ -331,6 +271,12 @@ void QtReadersWritersWidget::onStopClicked() {
   btnStart_->setEnabled(false);
   btnStop_->setEnabled(false);
 
+  // 最后刷新一次统计并冻结，线程退出后表格里保留本次运行的结果
+  if (statsTimer_->isActive()) {
+    updateStats();
+    statsTimer_->stop();
+  }
+
   // 停止读者
   for (auto* th : readers_) {
     if (!th) continue;
@@ -395,3 +341,36 @@ void QtReadersWritersWidget::appendLog(const QString& msg) {
   const auto ts = QDateTime::currentDateTime().toString("HH:mm:ss.zzz");
   logViewer_->append(QString("[%1] %2").arg(ts, msg));
 }
+
+/*
+ * 汇总所有线程的等待直方图：分位数按本次运行累计，吞吐按上一个统计周期计算
+ */
+void QtReadersWritersWidget::updateStats() {
+  if (statsRow_ < 0) return;
+
+  HistogramSnapshot readWait;
+  for (auto* th : readers_) {
+    if (th) readWait.merge(th->waitHistogram().snapshot());
+  }
+  HistogramSnapshot writeWait;
+  for (auto* th : writers_) {
+    if (th) writeWait.merge(th->waitHistogram().snapshot());
+  }
+
+  const double seconds = qMax(1e-3, statsClock_.restart() / 1000.0);
+  const double readsPerSec = (readWait.count - qMin(lastReads_, readWait.count)) / seconds;
+  const double writesPerSec = (writeWait.count - qMin(lastWrites_, writeWait.count)) / seconds;
+  lastReads_ = readWait.count;
+  lastWrites_ = writeWait.count;
+
+  const QStringList cells = {
+      formatUs(readWait.percentile(0.5)), formatUs(readWait.percentile(0.99)),
+      formatUs(readWait.percentile(0.999)), formatUs(readWait.max),
+      QString::number(readsPerSec, 'f', 1),
+      formatUs(writeWait.percentile(0.5)), formatUs(writeWait.percentile(0.99)),
+      formatUs(writeWait.percentile(0.999)), formatUs(writeWait.max),
+      QString::number(writesPerSec, 'f', 1)};
+  for (int i = 0; i < cells.size(); ++i) {
+    statsTable_->setItem(statsRow_, i + 1, new QTableWidgetItem(cells[i]));
+  }
+}
@@ -2,11 +2,6 @@
 
 #include <QWidget>
 #include <QThread>
-#include <QMutex>
-#include <QWaitCondition>
-#include <QReadWriteLock>
-#include <QReadLocker>
-#include <QWriteLocker>
 #include <QVector>
 #include <QPushButton>
 #include <QSpinBox>
@@ -16,73 +11,11 @@
 #include <QGroupBox>
 #include <QHBoxLayout>
 #include <QVBoxLayout>
-
-/*
- * 访问策略枚举：
- * - ReaderPreference: 读者优先（可能导致写者饥饿）
- * - WriterPreference: 写者优先（减少写者饥饿，读者可能等待）
- * - Fair: 公平策略（尽量轮流，降低饥饿可能）
- */
-enum class AccessPolicy {
-  ReaderPreference,
-  WriterPreference,
-  Fair
-};
-
-/*
- * 共享数据存储（读写者问题核心）
- * 负责：
- * - 用条件变量和互斥锁实现访问控制（公平/优先策略）
- * - 用 QReadWriteLock 保护真实数据读写
- * - 提供读/写接口给线程调用
- */
-class SharedDataStore : public QObject {
-  Q_OBJECT
- public:
-  explicit SharedDataStore(QObject* parent = nullptr);
-
-  // 设置访问策略
-  void setPolicy(AccessPolicy policy);
-
-  // 读者开始访问（可能阻塞等待）
-  void beginRead();
-
-  // 读者结束访问（唤醒等待的写者或读者）
-  void endRead();
-
-  // 写者开始访问（可能阻塞等待）
-  void beginWrite();
-
-  // 写者结束访问（唤醒等待的写者或读者）
-  void endWrite();
-
-  // 执行实际的读取操作（必须在 beginRead/endRead 内调用）
-  QString readValue() const;
-
-  // 执行实际的写入操作（必须在 beginWrite/endWrite 内调用）
-  void writeValue(const QString& value);
-
- signals:
-  // 输出日志到UI
-  void logMessage(const QString& msg);
-
- private:
-  // 访问策略
-  AccessPolicy policy_ = AccessPolicy::Fair;
-
-  // 条件变量与互斥锁，用于公平/优先控制
-  mutable QMutex gateMutex_;
-  QWaitCondition readersQueue_;
-  QWaitCondition writersQueue_;
-  int activeReaders_ = 0;
-  int waitingReaders_ = 0;
-  int waitingWriters_ = 0;
-  bool activeWriter_ = false;
-
-  // 真实数据锁与数据
-  mutable QReadWriteLock rwLock_;
-  QString payload_ = "初始数据";
-};
+#include <QTimer>
+#include <QTableWidget>
+#include <QElapsedTimer>
+#include "latencyhistogram.h"
+#include "shareddatastore.h"
 
 /*
  * 读者线程
@@ -96,6 +29,9 @@ class ReaderThread : public QThread {
   // 停止线程（软停止，配合 isInterruptionRequested）
   void stop();
 
+  // 获取读权限的等待时间分布，count 即完成的读次数
+  const LatencyHistogram& waitHistogram() const { return waitHistogram_; }
+
  protected:
   // 线程入口：周期性进行读操作
   void run() override;
@@ -105,6 +41,9 @@ class ReaderThread : public QThread {
   int id_ = 0;
   int intervalMs_ = 500;
   bool running_ = true;
+
+  // 本线程 beginRead 的等待时间（纳秒）；每个线程一份，记录时不与其他线程争用
+  LatencyHistogram waitHistogram_;
 };
 
 /*
@@ -119,6 +58,9 @@ class WriterThread : public QThread {
   // 停止线程（软停止，配合 isInterruptionRequested）
   void stop();
 
+  // 获取写权限的等待时间分布，count 即完成的写次数
+  const LatencyHistogram& waitHistogram() const { return waitHistogram_; }
+
  protected:
   // 线程入口：周期性进行写操作
   void run() override;
@@ -128,6 +70,9 @@ class WriterThread : public QThread {
   int id_ = 0;
   int intervalMs_ = 800;
   bool running_ = true;
+
+  // 本线程 beginWrite 的等待时间（纳秒）；每个线程一份，记录时不与其他线程争用
+  LatencyHistogram waitHistogram_;
 };
 
 /*
@@ -136,6 +81,7 @@ class WriterThread : public QThread {
  * - 配置读者/写者数量与速率
  * - 切换访问策略
  * - 启动/停止系统
+ * - 按策略对比读者/写者等待时间分位数与吞吐
  * - 查看运行日志
  */
 class QtReadersWritersWidget : public QWidget {
@@ -160,6 +106,9 @@ class QtReadersWritersWidget : public QWidget {
   // 追加日志到文本框
   void appendLog(const QString& msg);
 
+  // 定时汇总各线程的等待直方图，刷新当前策略那一行
+  void updateStats();
+
  private:
   // 初始化UI
   void setupUi();
@@ -177,6 +126,14 @@ class QtReadersWritersWidget : public QWidget {
 
   QTextEdit* logViewer_ = nullptr;
 
+  // 统计区：每种策略一行，保留各策略最近一次运行的结果用于横向对比
+  QTableWidget* statsTable_ = nullptr;
+  QTimer* statsTimer_ = nullptr;
+  QElapsedTimer statsClock_;
+  int statsRow_ = -1;
+  quint64 lastReads_ = 0;
+  quint64 lastWrites_ = 0;
+
   // 核心对象
   SharedDataStore* store_ = nullptr;
   QVector<ReaderThread*> readers_;
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <QtGlobal>
+#include <array>
+#include <atomic>
+#include <thread>
+#include <utility>
+#include "readerindicator.h"
+
+/*
+ * RcuCell：读-复制-更新（RCU）的单值容器
+ *
+ * - 当前版本是一个只读快照，挂在原子指针上。读者不加锁：声明所在纪元后读指针、访问快照；
+ * - 写者在旁边构造新版本，一次 exchange 发布，然后等待宽限期结束再释放旧版本；
+ * - 回收用双纪元计数（SRCU 思路）：读者进入时在“当前纪元奇偶位”对应的计数上加 1，
+ *   加完再核对一次纪元，奇偶位变了就撤销重来；写者发布后翻转纪元，只需等旧奇偶位的计数归零，
+ *   翻转后进来的读者必然看到新指针；
+ * - 计数按线程分片、每片独占缓存行，读者只写自己那片，不和其他读者争用；
+ * - 写者之间不互斥，调用方需保证同一时刻只有一个写者。写者会等待宽限期，读者永远不等写者。
+ */
+template <typename T>
+class RcuCell
+{
+public:
+    static constexpr int kShards = 64;
+
+    explicit RcuCell(T initial = T()) : m_current(new T(std::move(initial))) {}
+    ~RcuCell() { delete m_current.load(std::memory_order_relaxed); }
+
+    RcuCell(const RcuCell &) = delete;
+    RcuCell &operator=(const RcuCell &) = delete;
+
+    // 在读侧临界区内调用 f(const T&) 并返回其结果；f 里不要保存快照的引用
+    template <typename F>
+    auto read(F &&f) const -> decltype(f(std::declval<const T &>()))
+    {
+        Shard &shard = m_shards[static_cast<std::size_t>(threadShardIndex(kShards))];
+        // 先公开“我在读”，再确认纪元没在这期间翻转，最后读指针（都是 seq_cst）：
+        // 读纪元和加 1 之间如果有写者翻转，这次加 1 可能落在写者已经检查过的奇偶位上，
+        // 后面的写者又只等另一个奇偶位，快照会在读者手里被释放——所以奇偶位变了就撤销重来。
+        // 确认之后翻转的写者等的正是这个奇偶位；确认之前的翻转已经发生，读到的指针不会是它们释放的
+        int parity;
+        for (;;) {
+            parity = static_cast<int>(m_epoch.load(std::memory_order_seq_cst) & 1);
+            shard.readers[parity].fetch_add(1, std::memory_order_seq_cst);
+            if (static_cast<int>(m_epoch.load(std::memory_order_seq_cst) & 1) == parity) {
+                break;
+            }
+            shard.readers[parity].fetch_sub(1, std::memory_order_release);
+        }
+        const T *snapshot = m_current.load(std::memory_order_seq_cst);
+        struct Exit
+        {
+            std::atomic<quint32> &counter;
+            ~Exit() { counter.fetch_sub(1, std::memory_order_release); }
+        } exit{shard.readers[parity]};
+        return f(*snapshot);
+    }
+
+    // 发布新版本并在宽限期结束后释放旧版本（调用方保证写者互斥）
+    void publish(T value)
+    {
+        T *fresh = new T(std::move(value));
+        T *old = m_current.exchange(fresh, std::memory_order_seq_cst);
+        synchronize();
+        delete old;
+    }
+
+    // 已发布的版本数
+    quint64 version() const { return m_epoch.load(std::memory_order_acquire); }
+
+    // 写者累计在宽限期里让出 CPU 的次数
+    quint64 graceWaits() const { return m_graceWaits.load(std::memory_order_relaxed); }
+
+private:
+    struct alignas(64) Shard
+    {
+        std::atomic<quint32> readers[2] = {{0}, {0}};
+    };
+
+    // 翻转纪元并等待旧奇偶位上的读者全部离开
+    void synchronize()
+    {
+        const int parity = static_cast<int>(m_epoch.fetch_add(1, std::memory_order_seq_cst) & 1);
+        for (;;) {
+            quint64 inside = 0;
+            for (const Shard &shard : m_shards) {
+                inside += shard.readers[parity].load(std::memory_order_seq_cst);
+            }
+            if (inside == 0) {
+                return;
+            }
+            m_graceWaits.fetch_add(1, std::memory_order_relaxed);
+            std::this_thread::yield();
+        }
+    }
+
+    std::atomic<T *> m_current;
+    alignas(64) std::atomic<quint64> m_epoch{0};
+    std::atomic<quint64> m_graceWaits{0};
+    mutable std::array<Shard, kShards> m_shards;
+};
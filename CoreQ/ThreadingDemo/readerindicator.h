@@ -0,0 +1,102 @@
+#pragma once
+
+#include <QtGlobal>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include "adaptivewait.h"
+
+// 当前线程固定分到的分片号：首次调用时轮流分配，线程数不超过 shards 时各占一片
+inline int threadShardIndex(int shards)
+{
+    static std::atomic<int> nextShard{0};
+    thread_local const int shard = nextShard.fetch_add(1, std::memory_order_relaxed);
+    return shard % shards;
+}
+
+/*
+ * ShardedRwLock：分片读者指示器实现的读写锁
+ *
+ * - 每个线程一个独占缓存行的读者计数（按线程分片，超过 kShards 个线程时共用计数，仍然正确）；
+ *   读者加锁只对自己那片做一次加 1，再检查写者标志，读者之间没有任何共享写；
+ * - 写者先抢占写者标志（写者之间互斥），再扫描全部分片等读者排空；
+ * - 读者发现写者标志后撤销计数、等写者离开再重试，因此写者不会被源源不断的新读者饿死，
+ *   代价是持续写入时读者可能被推迟。
+ * 加锁/解锁必须在同一线程调用（解锁按线程找回分片）。
+ */
+class ShardedRwLock
+{
+public:
+    static constexpr int kShards = 64;
+    static constexpr int kSpinRounds = 64;
+
+    void lockShared()
+    {
+        std::atomic<quint32> &slot = m_slots[static_cast<std::size_t>(threadShardIndex(kShards))].readers;
+        for (;;) {
+            // 先公开“我在读”，再检查写者：与写者的“先置标志再扫描”配对，两边都是 seq_cst
+            slot.fetch_add(1, std::memory_order_seq_cst);
+            if (!m_writer.load(std::memory_order_seq_cst)) {
+                return;
+            }
+            slot.fetch_sub(1, std::memory_order_release);
+            m_readerBackoffs.fetch_add(1, std::memory_order_relaxed);
+            waitWhileWriter();
+        }
+    }
+
+    void unlockShared()
+    {
+        m_slots[static_cast<std::size_t>(threadShardIndex(kShards))].readers.fetch_sub(1, std::memory_order_release);
+    }
+
+    void lock()
+    {
+        bool expected = false;
+        int spins = 0;
+        while (!m_writer.compare_exchange_weak(expected, true, std::memory_order_seq_cst)) {
+            expected = false;
+            backoff(spins);
+        }
+        spins = 0;
+        for (const Slot &slot : m_slots) {
+            while (slot.readers.load(std::memory_order_seq_cst) != 0) {
+                backoff(spins);
+            }
+        }
+    }
+
+    void unlock() { m_writer.store(false, std::memory_order_release); }
+
+    // 读者因撞上写者而撤销重试的累计次数
+    quint64 readerBackoffs() const { return m_readerBackoffs.load(std::memory_order_relaxed); }
+
+private:
+    struct alignas(64) Slot
+    {
+        std::atomic<quint32> readers{0};
+    };
+
+    static void backoff(int &spins)
+    {
+        if (spins < kSpinRounds) {
+            ++spins;
+            cpuRelax();
+        } else {
+            std::this_thread::yield();
+        }
+    }
+
+    void waitWhileWriter() const
+    {
+        int spins = 0;
+        while (m_writer.load(std::memory_order_acquire)) {
+            backoff(spins);
+        }
+    }
+
+    std::array<Slot, kShards> m_slots;
+    alignas(64) std::atomic<bool> m_writer{false};
+    std::atomic<quint64> m_readerBackoffs{0};
+};
@@ -0,0 +1,656 @@
+/*
+ * RwLockBenchmark：无界面的读写锁基准
+ *
+ * 在给定的线程数 × 读比例 × 临界区长度组合上逐一运行各读写锁策略，输出 JSON 或 CSV，
+ * 供构建机跨版本追踪性能回归。只依赖 Qt Core。
+ *
+ * 每个线程按读比例随机决定本次是读还是写，记录获取读/写权限的等待时间（含一次计时开销），
+ * 临界区内按 cpuRelax() 的实测耗时空转到指定纳秒数。
+ *
+ * 用法示例：
+ *   RwLockBenchmark --threads 1,2,4,8 --read-ratio 0.9,0.99 --critical-ns 0,200 --format csv
+ *   RwLockBenchmark --rcu-stress --duration-ms 5000   # RcuCell 回收正确性压力测试，发现问题时返回 1
+ *   RwLockBenchmark --ring-check                      # MpmcRingBuffer 小容量边界检查，发现问题时返回 1
+ */
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDateTime>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
+#include <QReadLocker>
+#include <QReadWriteLock>
+#include <QWaitCondition>
+#include <QWriteLocker>
+#include <QStringList>
+#include <QTextStream>
+#include <QThread>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <shared_mutex>
+#include <thread>
+#include <vector>
+#include "adaptivewait.h"
+#include "latencyhistogram.h"
+#include "mpmcringbuffer.h"
+#include "rcucell.h"
+#include "seqlock.h"
+#include "shareddatastore.h"
+
+namespace {
+
+/*
+ * 被测策略的统一接口，形状与 SharedDataStore 的 begin/value/end 一致
+ */
+class LockStrategy {
+ public:
+  virtual ~LockStrategy() = default;
+  virtual void beginRead() = 0;
+  virtual void read() = 0;
+  virtual void endRead() = 0;
+  virtual void beginWrite() = 0;
+  virtual void write(quint64 version) = 0;
+  virtual void endWrite() = 0;
+};
+
+// 写入时轮流使用的两个值，避免把字符串构造的开销算进锁里
+const QString& sampleValue(quint64 version) {
+  static const QString values[2] = {QStringLiteral("基准数据-A"), QStringLiteral("基准数据-B")};
+  return values[version & 1];
+}
+
+/*
+ * SharedDataStore 的某种 AccessPolicy（准入控制 + 数据保护整体）
+ */
+class StoreStrategy : public LockStrategy {
+ public:
+  explicit StoreStrategy(AccessPolicy policy) { store_.setPolicy(policy); }
+  void beginRead() override { store_.beginRead(); }
+  void read() override { sink_ = store_.readValue(); }
+  void endRead() override { store_.endRead(); }
+  void beginWrite() override { store_.beginWrite(); }
+  void write(quint64 version) override { store_.writeValue(sampleValue(version)); }
+  void endWrite() override { store_.endWrite(); }
+
+ private:
+  SharedDataStore store_;
+  static thread_local QString sink_;
+};
+
+thread_local QString StoreStrategy::sink_;
+
+/*
+ * 旧版 SharedDataStore 的双层协议：互斥锁 + 条件变量做准入（公平策略），内层再加 QReadWriteLock。
+ * 保留作对照，衡量 PolicyRwLock 单层实现省下了多少
+ */
+class GateRwLockStrategy : public LockStrategy {
+ public:
+  void beginRead() override {
+    QMutexLocker locker(&gateMutex_);
+    while (activeWriter_) readersQueue_.wait(&gateMutex_);
+    ++activeReaders_;
+  }
+  void read() override {
+    QReadLocker locker(&rwLock_);
+    sink_ = payload_;
+  }
+  void endRead() override {
+    QMutexLocker locker(&gateMutex_);
+    if (--activeReaders_ == 0) writersQueue_.wakeOne();
+  }
+  void beginWrite() override {
+    QMutexLocker locker(&gateMutex_);
+    ++waitingWriters_;
+    while (activeWriter_ || activeReaders_ > 0) writersQueue_.wait(&gateMutex_);
+    --waitingWriters_;
+    activeWriter_ = true;
+  }
+  void write(quint64 version) override {
+    QWriteLocker locker(&rwLock_);
+    payload_ = sampleValue(version);
+  }
+  void endWrite() override {
+    QMutexLocker locker(&gateMutex_);
+    activeWriter_ = false;
+    if (waitingWriters_ > 0) writersQueue_.wakeOne();
+    readersQueue_.wakeAll();
+  }
+
+ private:
+  QMutex gateMutex_;
+  QWaitCondition readersQueue_;
+  QWaitCondition writersQueue_;
+  int activeReaders_ = 0;
+  int waitingWriters_ = 0;
+  bool activeWriter_ = false;
+  QReadWriteLock rwLock_;
+  QString payload_ = sampleValue(0);
+  static thread_local QString sink_;
+};
+
+thread_local QString GateRwLockStrategy::sink_;
+
+/*
+ * 裸 QReadWriteLock，数据操作与 SharedDataStore 相同（拷贝 QString）
+ */
+class QReadWriteLockStrategy : public LockStrategy {
+ public:
+  void beginRead() override { lock_.lockForRead(); }
+  void read() override { sink_ = payload_; }
+  void endRead() override { lock_.unlock(); }
+  void beginWrite() override { lock_.lockForWrite(); }
+  void write(quint64 version) override { payload_ = sampleValue(version); }
+  void endWrite() override { lock_.unlock(); }
+
+ private:
+  QReadWriteLock lock_;
+  QString payload_ = sampleValue(0);
+  static thread_local QString sink_;
+};
+
+thread_local QString QReadWriteLockStrategy::sink_;
+
+/*
+ * std::shared_mutex（MutexDemoWidget::startReadersWriters 使用的方式）
+ */
+class StdSharedMutexStrategy : public LockStrategy {
+ public:
+  void beginRead() override { mutex_.lock_shared(); }
+  void read() override { sink_ = payload_; }
+  void endRead() override { mutex_.unlock_shared(); }
+  void beginWrite() override { mutex_.lock(); }
+  void write(quint64 version) override { payload_ = sampleValue(version); }
+  void endWrite() override { mutex_.unlock(); }
+
+ private:
+  std::shared_mutex mutex_;
+  QString payload_ = sampleValue(0);
+  static thread_local QString sink_;
+};
+
+thread_local QString StdSharedMutexStrategy::sink_;
+
+/*
+ * 顺序锁基线：直接读写定长块（与 SharedDataStore 的 SeqLock 载荷同尺寸），不经过 QString
+ */
+class SeqLockStrategy : public LockStrategy {
+ public:
+  using Buffer = SeqLockBuffer<17>;
+
+  void beginRead() override {}
+  void read() override { sink_ = buffer_.read(); }
+  void endRead() override {}
+  void beginWrite() override { writerMutex_.lock(); }
+  void write(quint64 version) override {
+    Buffer::Block block;
+    block.fill(version);
+    buffer_.write(block);
+  }
+  void endWrite() override { writerMutex_.unlock(); }
+
+ private:
+  QMutex writerMutex_;
+  Buffer buffer_;
+  static thread_local Buffer::Block sink_;
+};
+
+thread_local SeqLockStrategy::Buffer::Block SeqLockStrategy::sink_;
+
+struct StrategyInfo {
+  QString name;
+  std::function<std::unique_ptr<LockStrategy>()> create;
+};
+
+const std::vector<StrategyInfo>& allStrategies() {
+  static const std::vector<StrategyInfo> strategies = {
+      {"store-reader-pref", [] { return std::make_unique<StoreStrategy>(AccessPolicy::ReaderPreference); }},
+      {"store-writer-pref", [] { return std::make_unique<StoreStrategy>(AccessPolicy::WriterPreference); }},
+      {"store-fair", [] { return std::make_unique<StoreStrategy>(AccessPolicy::Fair); }},
+      {"store-seqlock", [] { return std::make_unique<StoreStrategy>(AccessPolicy::SeqLock); }},
+      {"store-rcu", [] { return std::make_unique<StoreStrategy>(AccessPolicy::Rcu); }},
+      {"store-sharded", [] { return std::make_unique<StoreStrategy>(AccessPolicy::ShardedReaders); }},
+      {"gate-qreadwritelock", [] { return std::make_unique<GateRwLockStrategy>(); }},
+      {"qreadwritelock", [] { return std::make_unique<QReadWriteLockStrategy>(); }},
+      {"std-shared-mutex", [] { return std::make_unique<StdSharedMutexStrategy>(); }},
+      {"seqlock", [] { return std::make_unique<SeqLockStrategy>(); }},
+  };
+  return strategies;
+}
+
+// 一个组合的参数
+struct BenchCase {
+  QString strategy;
+  int threads = 1;
+  double readRatio = 0.9;
+  int criticalNs = 0;
+  int durationMs = 300;
+};
+
+// 一个组合的结果
+struct BenchResult {
+  BenchCase config;
+  quint64 reads = 0;
+  quint64 writes = 0;
+  double seconds = 0.0;
+  HistogramSnapshot readWait;
+  HistogramSnapshot writeWait;
+};
+
+// 每个线程各自的计数与直方图，结束后再合并，运行期间线程之间不共享写
+struct WorkerState {
+  quint64 reads = 0;
+  quint64 writes = 0;
+  LatencyHistogram readWait;
+  LatencyHistogram writeWait;
+};
+
+quint64 elapsedNs(std::chrono::steady_clock::time_point begin) {
+  return static_cast<quint64>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now() - begin).count());
+}
+
+// 模拟临界区：空转 spins 次 cpuRelax()
+void spinCriticalSection(int spins) {
+  for (int i = 0; i < spins; ++i) cpuRelax();
+}
+
+/*
+ * 运行单个组合：所有线程就绪后同时开跑，到时间后统一停止
+ */
+BenchResult runCase(const BenchCase& config, const StrategyInfo& info) {
+  std::unique_ptr<LockStrategy> lock = info.create();
+  const int spins = static_cast<int>(config.criticalNs / AdaptiveWaiter::relaxNs());
+  const quint32 readThreshold = static_cast<quint32>(qBound(0.0, config.readRatio, 1.0) * 4294967295.0);
+
+  std::vector<std::unique_ptr<WorkerState>> states;
+  for (int i = 0; i < config.threads; ++i) states.push_back(std::make_unique<WorkerState>());
+
+  std::atomic<int> ready{0};
+  std::atomic<bool> go{false};
+  std::atomic<bool> stop{false};
+  std::vector<std::thread> workers;
+  for (int i = 0; i < config.threads; ++i) {
+    workers.emplace_back([&, i] {
+      WorkerState& state = *states[static_cast<std::size_t>(i)];
+      quint32 rng = 0x9E3779B9u * static_cast<quint32>(i + 1);
+      quint64 version = 0;
+      ready.fetch_add(1);
+      while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+      while (!stop.load(std::memory_order_relaxed)) {
+        // xorshift32：线程私有的随机数，决定本次读还是写
+        rng ^= rng << 13;
+        rng ^= rng >> 17;
+        rng ^= rng << 5;
+        const auto waitBegin = std::chrono::steady_clock::now();
+        if (rng <= readThreshold) {
+          lock->beginRead();
+          state.readWait.record(elapsedNs(waitBegin));
+          lock->read();
+          spinCriticalSection(spins);
+          lock->endRead();
+          ++state.reads;
+        } else {
+          lock->beginWrite();
+          state.writeWait.record(elapsedNs(waitBegin));
+          spinCriticalSection(spins);
+          lock->write(++version);
+          lock->endWrite();
+          ++state.writes;
+        }
+      }
+    });
+  }
+
+  while (ready.load() < config.threads) std::this_thread::yield();
+  const auto begin = std::chrono::steady_clock::now();
+  go.store(true, std::memory_order_release);
+  std::this_thread::sleep_for(std::chrono::milliseconds(config.durationMs));
+  stop.store(true, std::memory_order_relaxed);
+  for (auto& worker : workers) worker.join();
+
+  BenchResult result;
+  result.config = config;
+  result.seconds = elapsedNs(begin) / 1e9;
+  for (const auto& state : states) {
+    result.reads += state->reads;
+    result.writes += state->writes;
+    result.readWait.merge(state->readWait.snapshot());
+    result.writeWait.merge(state->writeWait.snapshot());
+  }
+  return result;
+}
+
+/*
+ * RcuCell 压力测试：一个写者背靠背地发布新版本，多个慢读者在读侧临界区里停留、让出 CPU，
+ * 并在进出时各校验一次快照的标记。快照被提前释放时析构函数已经改写了标记，计为一次失效；
+ * 配合 AddressSanitizer 运行还能直接报告释放后使用。
+ */
+struct RcuStressPayload {
+  static constexpr quint64 kAlive = 0x5afec0de5afec0deull;
+  static constexpr quint64 kFreed = 0xdeaddeaddeaddeadull;
+
+  explicit RcuStressPayload(quint64 v = 0) : version(v) {}
+  RcuStressPayload(const RcuStressPayload& other) : version(other.version) {}
+  RcuStressPayload(RcuStressPayload&& other) noexcept : version(other.version) {}
+  // volatile 写：防止编译器把 delete 前的这次写入当成死存储删掉
+  ~RcuStressPayload() { *static_cast<volatile quint64*>(&magic) = kFreed; }
+
+  bool alive() const { return *static_cast<const volatile quint64*>(&magic) == kAlive; }
+
+  quint64 magic = kAlive;
+  quint64 version;
+};
+
+struct RcuStressResult {
+  quint64 publishes = 0;
+  quint64 reads = 0;
+  quint64 staleReads = 0;  // 临界区内看到已释放快照的次数
+};
+
+RcuStressResult runRcuStress(int readers, int durationMs) {
+  RcuCell<RcuStressPayload> cell;
+  std::atomic<bool> stop{false};
+  std::atomic<quint64> reads{0};
+  std::atomic<quint64> staleReads{0};
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < readers; ++i) {
+    threads.emplace_back([&, i] {
+      quint64 localReads = 0;
+      quint64 localStale = 0;
+      while (!stop.load(std::memory_order_relaxed)) {
+        cell.read([&](const RcuStressPayload& payload) {
+          bool ok = payload.alive();
+          // 慢读者：在临界区里空转、让出 CPU，让写者有机会在这期间连续发布几次
+          spinCriticalSection(64 + (i & 3) * 64);
+          std::this_thread::yield();
+          ok = ok && payload.alive();
+          if (!ok) ++localStale;
+          return ok;
+        });
+        ++localReads;
+      }
+      reads.fetch_add(localReads, std::memory_order_relaxed);
+      staleReads.fetch_add(localStale, std::memory_order_relaxed);
+    });
+  }
+
+  RcuStressResult result;
+  const auto begin = std::chrono::steady_clock::now();
+  while (elapsedNs(begin) < static_cast<quint64>(durationMs) * 1000000ull) {
+    cell.publish(RcuStressPayload(++result.publishes));
+  }
+  stop.store(true, std::memory_order_relaxed);
+  for (auto& thread : threads) thread.join();
+  result.reads = reads.load();
+  result.staleReads = staleReads.load();
+  return result;
+}
+
+/*
+ * MpmcRingBuffer 小容量回归检查：容量 1 曾经会在第二次 tryPush 时覆盖未读元素、tryPop 随后卡死。
+ * 单线程按“填满 → 满时拒绝 → 按序取空 → 空时拒绝”走多轮，用存活计数检查元素没有泄漏；
+ * 再用 2 生产者 × 2 消费者交换一批数据核对总和。返回发现的问题数。
+ */
+struct RingCheckItem {
+  static std::atomic<int> live;
+  explicit RingCheckItem(quint64 v = 0) : value(v) { live.fetch_add(1, std::memory_order_relaxed); }
+  RingCheckItem(const RingCheckItem& other) : value(other.value) { live.fetch_add(1, std::memory_order_relaxed); }
+  RingCheckItem(RingCheckItem&& other) noexcept : value(other.value) { live.fetch_add(1, std::memory_order_relaxed); }
+  RingCheckItem& operator=(const RingCheckItem&) = default;
+  RingCheckItem& operator=(RingCheckItem&&) noexcept = default;
+  ~RingCheckItem() { live.fetch_sub(1, std::memory_order_relaxed); }
+  quint64 value;
+};
+std::atomic<int> RingCheckItem::live{0};
+
+int runRingCheck(QTextStream& err) {
+  int failures = 0;
+  auto fail = [&](const QString& what) {
+    err << "  失败: " << what << '\n';
+    ++failures;
+  };
+  for (std::size_t requested : {std::size_t(1), std::size_t(2)}) {
+    const int liveBefore = RingCheckItem::live.load();
+    {
+      MpmcRingBuffer<RingCheckItem> ring(requested);
+      const std::size_t capacity = ring.capacity();
+      if (capacity < 2 || capacity < requested) fail(QString("请求容量 %1，实际 %2").arg(requested).arg(capacity));
+      quint64 next = 0;
+      for (int round = 0; round < 1000; ++round) {
+        const quint64 first = next;
+        for (std::size_t i = 0; i < capacity; ++i) {
+          if (!ring.tryPush(RingCheckItem(next++))) fail(QString("容量 %1：未满时 tryPush 失败").arg(requested));
+        }
+        if (ring.tryPush(RingCheckItem(next))) fail(QString("容量 %1：已满时 tryPush 仍成功").arg(requested));
+        RingCheckItem item;
+        for (std::size_t i = 0; i < capacity; ++i) {
+          if (!ring.tryPop(item) || item.value != first + i) fail(QString("容量 %1：取出顺序或内容错误").arg(requested));
+        }
+        if (ring.tryPop(item)) fail(QString("容量 %1：已空时 tryPop 仍成功").arg(requested));
+        if (failures > 0) break;
+      }
+      if (RingCheckItem::live.load() != liveBefore) fail(QString("容量 %1：元素泄漏或重复析构").arg(requested));
+
+      // 多生产者/多消费者：每个数恰好取出一次
+      const quint64 perProducer = 50000;
+      std::atomic<quint64> consumed{0};
+      std::atomic<quint64> sum{0};
+      std::vector<std::thread> threads;
+      for (int p = 0; p < 2; ++p) {
+        threads.emplace_back([&ring, p, perProducer] {
+          for (quint64 i = 0; i < perProducer; ++i) {
+            while (!ring.tryPush(RingCheckItem(p * perProducer + i + 1))) std::this_thread::yield();
+          }
+        });
+      }
+      for (int c = 0; c < 2; ++c) {
+        threads.emplace_back([&] {
+          RingCheckItem item;
+          while (consumed.load(std::memory_order_relaxed) < 2 * perProducer) {
+            if (ring.tryPop(item)) {
+              sum.fetch_add(item.value, std::memory_order_relaxed);
+              consumed.fetch_add(1, std::memory_order_relaxed);
+            } else {
+              std::this_thread::yield();
+            }
+          }
+        });
+      }
+      for (auto& thread : threads) thread.join();
+      const quint64 n = 2 * perProducer;
+      if (sum.load() != n * (n + 1) / 2) fail(QString("容量 %1：多线程交换后总和不符").arg(requested));
+    }
+    if (RingCheckItem::live.load() != liveBefore) fail(QString("容量 %1：析构后仍有元素存活").arg(requested));
+  }
+  return failures;
+}
+
+// "1,2,4" -> {1,2,4}；非法项报错返回 false
+template <typename T>
+bool parseList(const QString& text, std::vector<T>& out, T (*convert)(const QString&, bool*)) {
+  out.clear();
+  for (const QString& part : text.split(',', Qt::SkipEmptyParts)) {
+    bool ok = false;
+    const T value = convert(part.trimmed(), &ok);
+    if (!ok) return false;
+    out.push_back(value);
+  }
+  return !out.empty();
+}
+
+int toInt(const QString& text, bool* ok) { return text.toInt(ok); }
+double toDouble(const QString& text, bool* ok) { return text.toDouble(ok); }
+
+const QStringList& csvColumns() {
+  static const QStringList columns = {
+      "strategy", "threads", "read_ratio", "critical_ns", "duration_ms", "reads", "writes",
+      "ops_per_sec", "read_p50_ns", "read_p99_ns", "read_p999_ns", "read_max_ns",
+      "write_p50_ns", "write_p99_ns", "write_p999_ns", "write_max_ns"};
+  return columns;
+}
+
+QJsonObject toJson(const BenchResult& r) {
+  QJsonObject o;
+  o["strategy"] = r.config.strategy;
+  o["threads"] = r.config.threads;
+  o["read_ratio"] = r.config.readRatio;
+  o["critical_ns"] = r.config.criticalNs;
+  o["duration_ms"] = r.config.durationMs;
+  o["reads"] = static_cast<double>(r.reads);
+  o["writes"] = static_cast<double>(r.writes);
+  o["ops_per_sec"] = r.seconds > 0 ? (r.reads + r.writes) / r.seconds : 0.0;
+  o["read_p50_ns"] = static_cast<double>(r.readWait.percentile(0.5));
+  o["read_p99_ns"] = static_cast<double>(r.readWait.percentile(0.99));
+  o["read_p999_ns"] = static_cast<double>(r.readWait.percentile(0.999));
+  o["read_max_ns"] = static_cast<double>(r.readWait.max);
+  o["write_p50_ns"] = static_cast<double>(r.writeWait.percentile(0.5));
+  o["write_p99_ns"] = static_cast<double>(r.writeWait.percentile(0.99));
+  o["write_p999_ns"] = static_cast<double>(r.writeWait.percentile(0.999));
+  o["write_max_ns"] = static_cast<double>(r.writeWait.max);
+  return o;
+}
+
+QString toCsvRow(const BenchResult& r) {
+  const QJsonObject o = toJson(r);
+  QStringList cells;
+  for (const QString& column : csvColumns()) {
+    const QJsonValue v = o.value(column);
+    cells << (v.isString() ? v.toString() : QString::number(v.toDouble(), 'g', 12));
+  }
+  return cells.join(',');
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  QCoreApplication app(argc, argv);
+  QCoreApplication::setApplicationName("RwLockBenchmark");
+
+  QCommandLineParser parser;
+  parser.setApplicationDescription("读写锁策略基准：线程数 × 读比例 × 临界区长度，输出 JSON/CSV");
+  parser.addHelpOption();
+  const int hardwareThreads = qMax(1, QThread::idealThreadCount());
+  const QCommandLineOption threadsOpt({"t", "threads"}, "线程数列表，逗号分隔", "list",
+                                      QString("1,2,4,%1").arg(hardwareThreads));
+  const QCommandLineOption ratioOpt({"r", "read-ratio"}, "读操作比例列表 (0~1)", "list", "0.9,0.99");
+  const QCommandLineOption criticalOpt({"c", "critical-ns"}, "临界区长度列表（纳秒）", "list", "0,200");
+  const QCommandLineOption durationOpt({"d", "duration-ms"}, "每个组合的运行时长（毫秒）", "ms", "300");
+  const QCommandLineOption strategyOpt({"s", "strategies"}, "要测的策略，逗号分隔，默认全部", "list");
+  const QCommandLineOption formatOpt({"f", "format"}, "输出格式：json 或 csv", "format", "json");
+  const QCommandLineOption outputOpt({"o", "output"}, "输出文件，默认标准输出", "file");
+  const QCommandLineOption listOpt("list", "列出全部策略后退出");
+  const QCommandLineOption rcuStressOpt("rcu-stress", "运行 RcuCell 回收压力测试（读者数取 --threads 的最大值，时长取 --duration-ms）后退出");
+  const QCommandLineOption ringCheckOpt("ring-check", "运行 MpmcRingBuffer 小容量（1、2）边界检查后退出");
+  parser.addOptions({threadsOpt, ratioOpt, criticalOpt, durationOpt, strategyOpt, formatOpt, outputOpt, listOpt,
+                     rcuStressOpt, ringCheckOpt});
+  parser.process(app);
+
+  QTextStream err(stderr);
+  if (parser.isSet(listOpt)) {
+    QTextStream out(stdout);
+    for (const auto& info : allStrategies()) out << info.name << '\n';
+    return 0;
+  }
+
+  std::vector<int> threadCounts;
+  std::vector<double> readRatios;
+  std::vector<int> criticalNs;
+  bool durationOk = false;
+  const int durationMs = parser.value(durationOpt).toInt(&durationOk);
+  if (!parseList(parser.value(threadsOpt), threadCounts, toInt) ||
+      !parseList(parser.value(ratioOpt), readRatios, toDouble) ||
+      !parseList(parser.value(criticalOpt), criticalNs, toInt) || !durationOk || durationMs <= 0) {
+    err << "参数格式错误\n";
+    parser.showHelp(1);
+  }
+  if (parser.isSet(ringCheckOpt)) {
+    const int failures = runRingCheck(err);
+    err << (failures == 0 ? QString("MpmcRingBuffer 边界检查通过\n")
+                          : QString("MpmcRingBuffer 边界检查发现 %1 个问题\n").arg(failures));
+    return failures == 0 ? 0 : 1;
+  }
+  if (parser.isSet(rcuStressOpt)) {
+    const int readers = qMax(2, *std::max_element(threadCounts.begin(), threadCounts.end()));
+    const RcuStressResult r = runRcuStress(readers, durationMs);
+    err << QString("RcuCell 压力测试：%1 个慢读者，发布 %2 次，读 %3 次，读到已释放快照 %4 次\n")
+               .arg(readers).arg(r.publishes).arg(r.reads).arg(r.staleReads);
+    return r.staleReads == 0 ? 0 : 1;
+  }
+  const QString format = parser.value(formatOpt).toLower();
+  if (format != "json" && format != "csv") {
+    err << "不支持的输出格式: " << format << '\n';
+    return 1;
+  }
+
+  std::vector<const StrategyInfo*> selected;
+  QStringList wanted;
+  for (const QString& name : parser.value(strategyOpt).split(',', Qt::SkipEmptyParts)) wanted << name.trimmed();
+  for (const auto& info : allStrategies()) {
+    if (wanted.isEmpty() || wanted.contains(info.name)) selected.push_back(&info);
+  }
+  for (const QString& name : wanted) {
+    const bool known = std::any_of(allStrategies().begin(), allStrategies().end(),
+                                   [&](const StrategyInfo& info) { return info.name == name; });
+    if (!known) {
+      err << "未知策略: " << name << "（用 --list 查看）\n";
+      return 1;
+    }
+  }
+
+  std::vector<BenchResult> results;
+  for (const StrategyInfo* info : selected) {
+    for (int threads : threadCounts) {
+      for (double ratio : readRatios) {
+        for (int ns : criticalNs) {
+          BenchCase config;
+          config.strategy = info->name;
+          config.threads = qMax(1, threads);
+          config.readRatio = ratio;
+          config.criticalNs = qMax(0, ns);
+          config.durationMs = durationMs;
+          err << QString("%1 threads=%2 read=%3 cs=%4ns ...")
+                     .arg(config.strategy).arg(config.threads).arg(ratio).arg(config.criticalNs);
+          err.flush();
+          results.push_back(runCase(config, *info));
+          const BenchResult& r = results.back();
+          err << QString(" %1 ops/s\n").arg((r.reads + r.writes) / qMax(1e-9, r.seconds), 0, 'f', 0);
+        }
+      }
+    }
+  }
+
+  QFile file;
+  if (parser.isSet(outputOpt)) {
+    file.setFileName(parser.value(outputOpt));
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+      err << "无法写入 " << file.fileName() << '\n';
+      return 1;
+    }
+  } else if (!file.open(stdout, QIODevice::WriteOnly | QIODevice::Text)) {
+    return 1;
+  }
+
+  QTextStream out(&file);
+  if (format == "csv") {
+    out << csvColumns().join(',') << '\n';
+    for (const auto& r : results) out << toCsvRow(r) << '\n';
+  } else {
+    QJsonArray rows;
+    for (const auto& r : results) rows.append(toJson(r));
+    QJsonObject root;
+    root["benchmark"] = "rwlock";
+    root["timestamp"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+    root["qt_version"] = QString(qVersion());
+    root["hardware_threads"] = hardwareThreads;
+    root["relax_ns"] = AdaptiveWaiter::relaxNs();
+    root["results"] = rows;
+    out << QJsonDocument(root).toJson(QJsonDocument::Indented);
+  }
+  return 0;
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <QtGlobal>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include "adaptivewait.h"
+
+/*
+ * SeqLockBuffer：定长数据的顺序锁（seqlock）
+ *
+ * - 写者在更新前后各把序号加 1，序号为奇数表示正在写；
+ * - 读者先读序号、再逐字读数据、最后再读一次序号，两次相同且为偶数才算读到完整的一版，否则重试。
+ *   读者不写任何共享内存，读者之间没有缓存行争用，读吞吐随读者数线性增长；
+ * - 数据按 64 位原子字存放、relaxed 读写，读到写了一半的数据也不是未定义行为，只会被序号校验丢弃；
+ * - 写者之间不互斥，调用方需保证同一时刻只有一个写者。
+ */
+template <std::size_t Words>
+class SeqLockBuffer
+{
+public:
+    using Block = std::array<quint64, Words>;
+
+    SeqLockBuffer()
+    {
+        for (auto &word : m_data) {
+            word.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    // 乐观读取；retries 不为空时返回本次因并发写入而重试的次数
+    Block read(int *retries = nullptr) const
+    {
+        Block out;
+        int attempts = 0;
+        for (;;) {
+            const quint64 begin = m_seq.load(std::memory_order_acquire);
+            if (begin & 1) {
+                ++attempts;
+                cpuRelax();
+                continue;
+            }
+            for (std::size_t i = 0; i < Words; ++i) {
+                out[i] = m_data[i].load(std::memory_order_relaxed);
+            }
+            // 数据读取不能被重排到第二次读序号之后
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (m_seq.load(std::memory_order_relaxed) == begin) {
+                break;
+            }
+            ++attempts;
+        }
+        if (retries) {
+            *retries = attempts;
+        }
+        return out;
+    }
+
+    // 写入一版新数据（调用方保证写者互斥）
+    void write(const Block &value)
+    {
+        const quint64 seq = m_seq.load(std::memory_order_relaxed);
+        m_seq.store(seq + 1, std::memory_order_relaxed);
+        // 序号变为奇数必须先于任何数据写入被读者看到
+        std::atomic_thread_fence(std::memory_order_release);
+        for (std::size_t i = 0; i < Words; ++i) {
+            m_data[i].store(value[i], std::memory_order_relaxed);
+        }
+        m_seq.store(seq + 2, std::memory_order_release);
+    }
+
+    // 已完成的写入次数
+    quint64 version() const { return m_seq.load(std::memory_order_acquire) / 2; }
+
+private:
+    alignas(64) std::atomic<quint64> m_seq{0};
+    std::array<std::atomic<quint64>, Words> m_data;
+};
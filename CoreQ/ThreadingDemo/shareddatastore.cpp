@@ -0,0 +1,188 @@
+#include "shareddatastore.h"
+
+// ============================
+// SharedDataStore 实现
+// ============================
+
+/*
+ * 构造函数：初始化状态
+ */
+SharedDataStore::SharedDataStore(QObject* parent)
+    : QObject(parent) {}
+
+/*
+ * 设置访问策略（只应在没有读者/写者时调用）
+ */
+void SharedDataStore::setPolicy(AccessPolicy policy) {
+  QMutexLocker writerLocker(&writerMutex_);
+  const AccessPolicy previous = policy_;
+  if (policy != previous) {
+    // 不同策略的数据存放位置不同：把当前值迁移到新策略使用的存储里
+    QString value = payload_;
+    if (previous == AccessPolicy::SeqLock) {
+      value = decodeSeqLock(seqPayload_.read());
+    } else if (previous == AccessPolicy::Rcu) {
+      value = rcuPayload_.read([](const QString& snapshot) { return snapshot; });
+    }
+    if (policy == AccessPolicy::SeqLock) {
+      seqPayload_.write(encodeSeqLock(value));
+    } else if (policy == AccessPolicy::Rcu) {
+      rcuPayload_.publish(value);
+    } else {
+      payload_ = value;
+    }
+  }
+  switch (policy) {
+    case AccessPolicy::ReaderPreference:
+      rwLock_.setPolicy(PolicyRwLock::Policy::ReaderPreference);
+      break;
+    case AccessPolicy::WriterPreference:
+      rwLock_.setPolicy(PolicyRwLock::Policy::WriterPreference);
+      break;
+    case AccessPolicy::Fair:
+      rwLock_.setPolicy(PolicyRwLock::Policy::Fair);
+      break;
+    case AccessPolicy::SeqLock:
+    case AccessPolicy::Rcu:
+    case AccessPolicy::ShardedReaders:
+      break;
+  }
+  policy_ = policy;
+}
+
+/*
+ * 读者开始访问：根据策略判断是否需要等待
+ * - WriterPreference：若有写者等待或有活动写者，读者需要等待
+ * - ReaderPreference：读者尽量快进入，只有活动写者时才等待
+ * - Fair：有写者等待时排队，等当前写者结束后与其他排队读者一起整批进入
+ * - ShardedReaders：只在自己的分片上计数，碰到写者才退让
+ */
+void SharedDataStore::beginRead() {
+  // 顺序锁/RCU 的读者不需要准入：冲突由 readValue 内的重试或快照处理
+  const AccessPolicy policy = policy_;
+  if (isLockFreeRead(policy)) return;
+  if (policy == AccessPolicy::ShardedReaders) {
+    shardedLock_.lockShared();
+    return;
+  }
+  rwLock_.lockShared();
+}
+
+/*
+ * 读者结束访问：最后一个读者离开时，锁直接移交给等待的写者
+ */
+void SharedDataStore::endRead() {
+  const AccessPolicy policy = policy_;
+  if (isLockFreeRead(policy)) return;
+  if (policy == AccessPolicy::ShardedReaders) {
+    shardedLock_.unlockShared();
+    return;
+  }
+  rwLock_.unlockShared();
+}
+
+/*
+ * 写者开始访问：必须等待所有读者退出以及写者空闲
+ * SeqLock/Rcu：只和其他写者互斥，不等待读者
+ * ShardedReaders：抢到写者标志后扫描全部分片，等读者排空
+ */
+void SharedDataStore::beginWrite() {
+  const AccessPolicy policy = policy_;
+  if (isLockFreeRead(policy)) {
+    writerMutex_.lock();
+    return;
+  }
+  if (policy == AccessPolicy::ShardedReaders) {
+    shardedLock_.lock();
+    return;
+  }
+  rwLock_.lock();
+}
+
+/*
+ * 写者结束访问：根据策略移交给后续访问者
+ * - WriterPreference：若仍有写者在等，交给下一个写者；否则放行所有排队读者
+ * - ReaderPreference：优先放行所有排队读者；若无读者，则交给一个写者
+ * - Fair：先放行此前排队的读者，写者在这批读者结束后接手
+ */
+void SharedDataStore::endWrite() {
+  const AccessPolicy policy = policy_;
+  if (isLockFreeRead(policy)) {
+    writerMutex_.unlock();
+    return;
+  }
+  if (policy == AccessPolicy::ShardedReaders) {
+    shardedLock_.unlock();
+    return;
+  }
+  rwLock_.unlock();
+}
+
+/*
+ * 执行读取：必须在 beginRead/endRead 之间
+ * SeqLock：乐观读出一份完整快照，期间遇到写者则重试
+ * Rcu：读当前快照并逐字复制，不增加共享引用计数（否则读者又会争用同一缓存行）
+ */
+QString SharedDataStore::readValue() const {
+  const AccessPolicy policy = policy_;
+  if (policy == AccessPolicy::SeqLock) {
+    return decodeSeqLock(seqPayload_.read());
+  }
+  if (policy == AccessPolicy::Rcu) {
+    return rcuPayload_.read([](const QString& snapshot) {
+      return QString(snapshot.constData(), snapshot.size());
+    });
+  }
+  if (policy == AccessPolicy::ShardedReaders) {
+    // 分片锁已经排斥了写者；逐字复制，避免所有读者去改同一个引用计数
+    return QString(payload_.constData(), payload_.size());
+  }
+  // beginRead 持有的 rwLock_ 已经排斥了写者
+  return payload_;
+}
+
+/*
+ * 执行写入：必须在 beginWrite/endWrite 之间
+ * SeqLock：由 beginWrite 保证写者互斥，这里只推进序号并写入数据
+ * Rcu：在旁边构造新版本并发布，宽限期过后释放旧版本
+ */
+void SharedDataStore::writeValue(const QString& value) {
+  const AccessPolicy policy = policy_;
+  if (policy == AccessPolicy::SeqLock) {
+    seqPayload_.write(encodeSeqLock(value));
+    return;
+  }
+  if (policy == AccessPolicy::Rcu) {
+    // 深拷贝，快照不和写者手里的字符串共享引用计数
+    rcuPayload_.publish(QString(value.constData(), value.size()));
+    return;
+  }
+  // ShardedReaders 与三种排队策略都已在 beginWrite 中取得独占
+  payload_ = value;
+}
+
+/*
+ * QString -> 顺序锁定长块：第 0 字为长度，之后每字打包 4 个 UTF-16 码元
+ */
+SharedDataStore::SeqLockPayload::Block SharedDataStore::encodeSeqLock(const QString& value) {
+  SeqLockPayload::Block block{};
+  const int length = qMin(value.size(), kSeqLockChars);
+  block[0] = static_cast<quint64>(length);
+  for (int i = 0; i < length; ++i) {
+    const quint64 unit = value.at(i).unicode();
+    block[1 + i / 4] |= unit << (16 * (i % 4));
+  }
+  return block;
+}
+
+/*
+ * 顺序锁定长块 -> QString（在读者自己的栈上完成，不触碰共享数据）
+ */
+QString SharedDataStore::decodeSeqLock(const SeqLockPayload::Block& block) {
+  const int length = qMin(static_cast<int>(block[0]), kSeqLockChars);
+  QString value(length, Qt::Uninitialized);
+  for (int i = 0; i < length; ++i) {
+    value[i] = QChar(static_cast<ushort>(block[1 + i / 4] >> (16 * (i % 4))));
+  }
+  return value;
+}
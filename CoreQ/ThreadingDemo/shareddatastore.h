@@ -0,0 +1,98 @@
+#pragma once
+
+#include <QObject>
+#include <QString>
+#include <QMutex>
+#include <atomic>
+#include "policyrwlock.h"
+#include "rcucell.h"
+#include "readerindicator.h"
+#include "seqlock.h"
+
+/*
+ * 访问策略枚举：
+ * - ReaderPreference: 读者优先（可能导致写者饥饿）
+ * - WriterPreference: 写者优先（减少写者饥饿，读者可能等待）
+ * - Fair: 公平策略（尽量轮流，降低饥饿可能）
+ * - SeqLock: 顺序锁（读者不加锁、乐观重试，不写共享内存；写者之间互斥）
+ * - Rcu: 读-复制-更新（读者无锁读取不可变快照，写者发布新版本后等宽限期回收旧版本）
+ * - ShardedReaders: 分片读者指示器（每线程独占缓存行的读者计数，写者扫描全部分片等读者排空）
+ */
+enum class AccessPolicy {
+  ReaderPreference,
+  WriterPreference,
+  Fair,
+  SeqLock,
+  Rcu,
+  ShardedReaders
+};
+
+/*
+ * 共享数据存储（读写者问题核心）
+ * 负责：
+ * - 公平/优先三种策略由 PolicyRwLock 一层完成：同一个原子状态字既做准入控制又保护数据，
+ *   无竞争时读/写各只需一次 CAS，不再叠加“准入互斥锁 + QReadWriteLock”两套协议
+ * - SeqLock 策略下改用定长的顺序锁缓冲区：读者完全不碰互斥锁和计数器
+ * - Rcu 策略下数据是原子指针上的不可变快照：读者永远不会被 beginWrite 挡住
+ * - ShardedReaders 策略下改用分片读写锁，读者之间连状态字都不共享
+ * - 提供读/写接口给线程调用
+ */
+class SharedDataStore : public QObject {
+  Q_OBJECT
+ public:
+  explicit SharedDataStore(QObject* parent = nullptr);
+
+  // 设置访问策略
+  void setPolicy(AccessPolicy policy);
+
+  // 读者开始访问（可能阻塞等待）
+  void beginRead();
+
+  // 读者结束访问（唤醒等待的写者或读者）
+  void endRead();
+
+  // 写者开始访问（可能阻塞等待）
+  void beginWrite();
+
+  // 写者结束访问（唤醒等待的写者或读者）
+  void endWrite();
+
+  // 执行实际的读取操作（必须在 beginRead/endRead 内调用）
+  QString readValue() const;
+
+  // 执行实际的写入操作（必须在 beginWrite/endWrite 内调用）
+  void writeValue(const QString& value);
+
+ signals:
+  // 输出日志到UI
+  void logMessage(const QString& msg);
+
+ private:
+  // 顺序锁缓冲区：第 0 字存长度，其后每字 4 个 UTF-16 码元，超出部分截断
+  static constexpr int kSeqLockChars = 64;
+  using SeqLockPayload = SeqLockBuffer<1 + kSeqLockChars / 4>;
+
+  static SeqLockPayload::Block encodeSeqLock(const QString& value);
+  static QString decodeSeqLock(const SeqLockPayload::Block& block);
+
+  // SeqLock/Rcu 两种无锁读策略：读者不经过准入控制，写者只需彼此互斥
+  static bool isLockFreeRead(AccessPolicy policy) {
+    return policy == AccessPolicy::SeqLock || policy == AccessPolicy::Rcu;
+  }
+
+  // 访问策略（读者不经过任何公共互斥锁读取它，因此用原子变量）
+  std::atomic<AccessPolicy> policy_{AccessPolicy::Fair};
+
+  // ReaderPreference/WriterPreference/Fair：准入与数据保护合一的读写锁，以及它保护的数据
+  PolicyRwLock rwLock_;
+  QString payload_ = "初始数据";
+
+  // SeqLock/Rcu 策略：写者之间用 writerMutex_ 互斥，读者只读 seqPayload_ / rcuPayload_
+  // （setPolicy 也借用它串行化策略切换）
+  QMutex writerMutex_;
+  SeqLockPayload seqPayload_;
+  RcuCell<QString> rcuPayload_;
+
+  // ShardedReaders 策略：读者只改自己分片的计数，同时保护 payload_
+  ShardedRwLock shardedLock_;
+};
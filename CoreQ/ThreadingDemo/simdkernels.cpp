@@ -0,0 +1,293 @@
+#include "simdkernels.h"
+#include <cmath>
+#include "simdkernelsisa.h"
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define SIMD_KERNELS_X86 1
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SIMD_KERNELS_SSE2 1
+#include <emmintrin.h>
+#endif
+
+using namespace SimdIsa;
+
+namespace {
+
+#ifdef SIMD_KERNELS_X86
+void cpuid(int leaf, unsigned regs[4])
+{
+#if defined(_MSC_VER)
+    int r[4];
+    __cpuidex(r, leaf, 0);
+    for (int i = 0; i < 4; ++i) {
+        regs[i] = static_cast<unsigned>(r[i]);
+    }
+#else
+    regs[0] = regs[1] = regs[2] = regs[3] = 0;
+    __get_cpuid_count(static_cast<unsigned>(leaf), 0, &regs[0], &regs[1], &regs[2], &regs[3]);
+#endif
+}
+
+// 操作系统是否在上下文切换时保存 XMM/YMM 寄存器（XCR0 的第 1、2 位）
+bool osSavesYmm()
+{
+#if defined(_MSC_VER)
+    return (_xgetbv(0) & 0x6) == 0x6;
+#else
+    unsigned eax = 0;
+    unsigned edx = 0;
+    __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return (eax & 0x6) == 0x6;
+#endif
+}
+
+bool cpuHasAvx2Fma()
+{
+    unsigned regs[4];
+    cpuid(0, regs);
+    if (regs[0] < 7) {
+        return false;
+    }
+    cpuid(1, regs);
+    const bool osxsave = regs[2] & (1u << 27);
+    const bool avx = regs[2] & (1u << 28);
+    const bool fma = regs[2] & (1u << 12);
+    if (!osxsave || !avx || !fma || !osSavesYmm()) {
+        return false;
+    }
+    cpuid(7, regs);
+    return regs[1] & (1u << 5);
+}
+#endif
+
+SimdLevel detectBestLevel()
+{
+#ifdef SIMD_KERNELS_X86
+    if (avx2Compiled() && cpuHasAvx2Fma()) {
+        return SimdLevel::Avx2;
+    }
+#endif
+#ifdef SIMD_KERNELS_SSE2
+    return SimdLevel::Sse2;
+#else
+    return SimdLevel::Scalar;
+#endif
+}
+
+// 参考实现：逐项调用 std::sin/std::cos，double 精度
+double sinCosSumScalar(std::uint32_t seed, std::uint32_t begin, std::size_t count)
+{
+    const std::uint32_t key1 = streamKey(seed);
+    const std::uint32_t key2 = key1 ^ kSecondStream;
+    double sum = 0.0;
+    for (std::size_t i = 0; i < count; ++i) {
+        const std::uint32_t index = begin + static_cast<std::uint32_t>(i);
+        const double u1 = unitFloat(hash(index ^ key1));
+        const double u2 = unitFloat(hash(index ^ key2));
+        sum += std::sin(u1) * std::cos(u2);
+    }
+    return sum;
+}
+
+std::int64_t squareSumScalar(std::uint32_t seed, std::uint32_t begin, std::size_t count)
+{
+    const std::uint32_t key = streamKey(seed);
+    std::int64_t sum = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        sum += squareTerm(unitFloat(hash((begin + static_cast<std::uint32_t>(i)) ^ key)));
+    }
+    return sum;
+}
+
+#ifdef SIMD_KERNELS_SSE2
+// SSE2 没有 32 位低位乘法（SSE4.1 才有 pmulld）：奇偶两组各做一次 32×32→64，再把低 32 位拼回来
+inline __m128i mullo32(__m128i a, __m128i b)
+{
+    const __m128i even = _mm_mul_epu32(a, b);
+    const __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+    return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                              _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+inline __m128i hash4(__m128i x)
+{
+    x = _mm_xor_si128(x, _mm_srli_epi32(x, 16));
+    x = mullo32(x, _mm_set1_epi32(static_cast<int>(kHashMul1)));
+    x = _mm_xor_si128(x, _mm_srli_epi32(x, 15));
+    x = mullo32(x, _mm_set1_epi32(static_cast<int>(kHashMul2)));
+    x = _mm_xor_si128(x, _mm_srli_epi32(x, 16));
+    return x;
+}
+
+// 高 24 位转成 [0, 1)：右移后不超过 2^24，按有符号转换也是精确的
+inline __m128 unit4(__m128i bits)
+{
+    return _mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(bits, 8)), _mm_set1_ps(kUnitScale));
+}
+
+inline __m128 sin4(__m128 x)
+{
+    const __m128 x2 = _mm_mul_ps(x, x);
+    __m128 p = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(kSin9), x2), _mm_set1_ps(kSin7));
+    p = _mm_add_ps(_mm_mul_ps(p, x2), _mm_set1_ps(kSin5));
+    p = _mm_add_ps(_mm_mul_ps(p, x2), _mm_set1_ps(kSin3));
+    return _mm_add_ps(x, _mm_mul_ps(_mm_mul_ps(x, x2), p));
+}
+
+inline __m128 cos4(__m128 x)
+{
+    const __m128 x2 = _mm_mul_ps(x, x);
+    __m128 p = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(kCos10), x2), _mm_set1_ps(kCos8));
+    p = _mm_add_ps(_mm_mul_ps(p, x2), _mm_set1_ps(kCos6));
+    p = _mm_add_ps(_mm_mul_ps(p, x2), _mm_set1_ps(kCos4));
+    p = _mm_add_ps(_mm_mul_ps(p, x2), _mm_set1_ps(kCos2));
+    return _mm_add_ps(_mm_set1_ps(1.0f), _mm_mul_ps(x2, p));
+}
+
+// 水平归约：高低两半相加，再把剩下两个通道相加
+inline float hsum4(__m128 v)
+{
+    v = _mm_add_ps(v, _mm_movehl_ps(v, v));
+    v = _mm_add_ss(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1)));
+    return _mm_cvtss_f32(v);
+}
+
+inline std::int32_t hsum4(__m128i v)
+{
+    v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2)));
+    v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(v);
+}
+
+double sinCosSumSse2(std::uint32_t seed, std::uint32_t begin, std::size_t count)
+{
+    const std::uint32_t key1 = streamKey(seed);
+    const std::uint32_t key2 = key1 ^ kSecondStream;
+    const __m128i vkey1 = _mm_set1_epi32(static_cast<int>(key1));
+    const __m128i vkey2 = _mm_set1_epi32(static_cast<int>(key2));
+    const __m128i step = _mm_set1_epi32(4);
+    __m128i index = _mm_add_epi32(_mm_set1_epi32(static_cast<int>(begin)), _mm_setr_epi32(0, 1, 2, 3));
+
+    double sum = 0.0;
+    std::size_t i = 0;
+    const std::size_t vectorEnd = count & ~std::size_t(3);
+    while (i < vectorEnd) {
+        const std::size_t blockEnd = qMin(vectorEnd, i + kBlock);
+        __m128 acc = _mm_setzero_ps();
+        for (; i < blockEnd; i += 4) {
+            const __m128 u1 = unit4(hash4(_mm_xor_si128(index, vkey1)));
+            const __m128 u2 = unit4(hash4(_mm_xor_si128(index, vkey2)));
+            acc = _mm_add_ps(acc, _mm_mul_ps(sin4(u1), cos4(u2)));
+            index = _mm_add_epi32(index, step);
+        }
+        sum += hsum4(acc);
+    }
+    for (; i < count; ++i) {
+        const std::uint32_t scalarIndex = begin + static_cast<std::uint32_t>(i);
+        sum += sinPoly(unitFloat(hash(scalarIndex ^ key1))) * cosPoly(unitFloat(hash(scalarIndex ^ key2)));
+    }
+    return sum;
+}
+
+std::int64_t squareSumSse2(std::uint32_t seed, std::uint32_t begin, std::size_t count)
+{
+    const std::uint32_t key = streamKey(seed);
+    const __m128i vkey = _mm_set1_epi32(static_cast<int>(key));
+    const __m128i step = _mm_set1_epi32(4);
+    const __m128 thousand = _mm_set1_ps(1000.0f);
+    __m128i index = _mm_add_epi32(_mm_set1_epi32(static_cast<int>(begin)), _mm_setr_epi32(0, 1, 2, 3));
+
+    std::int64_t sum = 0;
+    std::size_t i = 0;
+    const std::size_t vectorEnd = count & ~std::size_t(3);
+    while (i < vectorEnd) {
+        const std::size_t blockEnd = qMin(vectorEnd, i + kBlock);
+        __m128i acc = _mm_setzero_si128();
+        for (; i < blockEnd; i += 4) {
+            const __m128 u = unit4(hash4(_mm_xor_si128(index, vkey)));
+            acc = _mm_add_epi32(acc, _mm_cvttps_epi32(_mm_mul_ps(_mm_mul_ps(u, u), thousand)));
+            index = _mm_add_epi32(index, step);
+        }
+        sum += hsum4(acc);
+    }
+    for (; i < count; ++i) {
+        sum += squareTerm(unitFloat(hash((begin + static_cast<std::uint32_t>(i)) ^ key)));
+    }
+    return sum;
+}
+#endif
+
+// 请求的级别高于本机支持时降到本机最高级别，避免在旧 CPU 上执行非法指令
+SimdLevel usableLevel(SimdLevel level)
+{
+    return qMin(level, simdBestLevel());
+}
+
+} // namespace
+
+SimdLevel simdBestLevel()
+{
+    static const SimdLevel best = detectBestLevel();
+    return best;
+}
+
+QList<SimdLevel> simdAvailableLevels()
+{
+    QList<SimdLevel> levels;
+    levels << SimdLevel::Scalar;
+    if (simdBestLevel() >= SimdLevel::Sse2) {
+        levels << SimdLevel::Sse2;
+    }
+    if (simdBestLevel() >= SimdLevel::Avx2) {
+        levels << SimdLevel::Avx2;
+    }
+    return levels;
+}
+
+QString simdLevelName(SimdLevel level)
+{
+    switch (level) {
+    case SimdLevel::Scalar:
+        return "标量";
+    case SimdLevel::Sse2:
+        return "SSE2 ×4";
+    case SimdLevel::Avx2:
+        return "AVX2+FMA ×8";
+    }
+    return QString();
+}
+
+double simdSinCosSum(SimdLevel level, quint32 seed, quint32 begin, std::size_t count)
+{
+    switch (usableLevel(level)) {
+    case SimdLevel::Avx2:
+        return sinCosSumAvx2(seed, begin, count);
+#ifdef SIMD_KERNELS_SSE2
+    case SimdLevel::Sse2:
+        return sinCosSumSse2(seed, begin, count);
+#endif
+    default:
+        return sinCosSumScalar(seed, begin, count);
+    }
+}
+
+qint64 simdSquareSum(SimdLevel level, quint32 seed, quint32 begin, std::size_t count)
+{
+    switch (usableLevel(level)) {
+    case SimdLevel::Avx2:
+        return squareSumAvx2(seed, begin, count);
+#ifdef SIMD_KERNELS_SSE2
+    case SimdLevel::Sse2:
+        return squareSumSse2(seed, begin, count);
+#endif
+    default:
+        return squareSumScalar(seed, begin, count);
+    }
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <QList>
+#include <QString>
+#include <QtGlobal>
+#include <cstddef>
+
+// 数值内核的实现级别；Scalar 是逐项调用 std::sin/std::cos 的参考实现
+enum class SimdLevel { Scalar, Sse2, Avx2 };
+
+/*
+ * 数值 map 内核：批量生成随机数 + 向量化的 sin/cos 近似 + 水平归约
+ *
+ * - 随机数是计数器型的：第 i 项只由 (seed, i) 决定，不依赖调用顺序，
+ *   所以任意分块、任意线程数、任意级别算的都是同一批输入（各级别只差近似误差和求和顺序）；
+ * - SSE2 一次算 4 项、AVX2 一次算 8 项（含 FMA），每 4096 项把向量累加器归约一次；
+ * - 运行时按 CPU 特性选择：AVX2 内核在单独的翻译单元里以 AVX2 编译，
+ *   只有 CPU 和操作系统都支持（CPUID + XGETBV）时才会调用；非 x86 平台只有标量版本。
+ * 下标是 32 位的，一个 seed 最多 2^32 项。
+ */
+SimdLevel simdBestLevel();
+QList<SimdLevel> simdAvailableLevels(); // 从 Scalar 到 simdBestLevel() 的全部级别
+QString simdLevelName(SimdLevel level);
+
+// Σ sin(u1) × cos(u2)，u1/u2 为第 i 项的两个 [0, 1) 均匀随机数（StdThreadWidget::multiThreadWork 的计算）
+double simdSinCosSum(SimdLevel level, quint32 seed, quint32 begin, std::size_t count);
+
+// Σ ⌊u² × 1000⌋，u 为第 i 项的 [0, 1) 均匀随机数（QPromise::compute 的计算）
+qint64 simdSquareSum(SimdLevel level, quint32 seed, quint32 begin, std::size_t count);
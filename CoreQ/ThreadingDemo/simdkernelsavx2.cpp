@@ -0,0 +1,157 @@
+// 本文件以 -mavx2 -mfma（MSVC 为 /arch:AVX2）单独编译，只能由 simdkernels.cpp 在检测到 AVX2 后调用。
+// 不要在这里包含 Qt 或标准库中带内联函数的头文件，原因见 simdkernelsisa.h。
+#include "simdkernelsisa.h"
+
+#if defined(__AVX2__) && (defined(__FMA__) || defined(_MSC_VER))
+#include <immintrin.h>
+
+namespace SimdIsa {
+
+namespace {
+
+inline __m256i hash8(__m256i x)
+{
+    x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 16));
+    x = _mm256_mullo_epi32(x, _mm256_set1_epi32(static_cast<int>(kHashMul1)));
+    x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 15));
+    x = _mm256_mullo_epi32(x, _mm256_set1_epi32(static_cast<int>(kHashMul2)));
+    x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 16));
+    return x;
+}
+
+inline __m256 unit8(__m256i bits)
+{
+    return _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_srli_epi32(bits, 8)), _mm256_set1_ps(kUnitScale));
+}
+
+inline __m256 sin8(__m256 x)
+{
+    const __m256 x2 = _mm256_mul_ps(x, x);
+    __m256 p = _mm256_fmadd_ps(_mm256_set1_ps(kSin9), x2, _mm256_set1_ps(kSin7));
+    p = _mm256_fmadd_ps(p, x2, _mm256_set1_ps(kSin5));
+    p = _mm256_fmadd_ps(p, x2, _mm256_set1_ps(kSin3));
+    return _mm256_fmadd_ps(_mm256_mul_ps(x, x2), p, x);
+}
+
+inline __m256 cos8(__m256 x)
+{
+    const __m256 x2 = _mm256_mul_ps(x, x);
+    __m256 p = _mm256_fmadd_ps(_mm256_set1_ps(kCos10), x2, _mm256_set1_ps(kCos8));
+    p = _mm256_fmadd_ps(p, x2, _mm256_set1_ps(kCos6));
+    p = _mm256_fmadd_ps(p, x2, _mm256_set1_ps(kCos4));
+    p = _mm256_fmadd_ps(p, x2, _mm256_set1_ps(kCos2));
+    return _mm256_fmadd_ps(x2, p, _mm256_set1_ps(1.0f));
+}
+
+// 水平归约：先把 256 位的高低两半相加成 128 位，再在 128 位内两两相加
+inline float hsum8(__m256 v)
+{
+    __m128 x = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+    x = _mm_add_ps(x, _mm_movehl_ps(x, x));
+    x = _mm_add_ss(x, _mm_movehdup_ps(x));
+    return _mm_cvtss_f32(x);
+}
+
+inline std::int32_t hsum8(__m256i v)
+{
+    __m128i x = _mm_add_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+    x = _mm_add_epi32(x, _mm_shuffle_epi32(x, _MM_SHUFFLE(1, 0, 3, 2)));
+    x = _mm_add_epi32(x, _mm_shuffle_epi32(x, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(x);
+}
+
+inline __m256i firstIndices(std::uint32_t begin)
+{
+    return _mm256_add_epi32(_mm256_set1_epi32(static_cast<int>(begin)), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+}
+
+} // namespace
+
+bool avx2Compiled()
+{
+    return true;
+}
+
+double sinCosSumAvx2(std::uint32_t seed, std::uint32_t begin, std::size_t count)
+{
+    const std::uint32_t key1 = streamKey(seed);
+    const std::uint32_t key2 = key1 ^ kSecondStream;
+    const __m256i vkey1 = _mm256_set1_epi32(static_cast<int>(key1));
+    const __m256i vkey2 = _mm256_set1_epi32(static_cast<int>(key2));
+    const __m256i step = _mm256_set1_epi32(8);
+    __m256i index = firstIndices(begin);
+
+    double sum = 0.0;
+    std::size_t i = 0;
+    const std::size_t vectorEnd = count & ~std::size_t(7);
+    while (i < vectorEnd) {
+        const std::size_t blockEnd = vectorEnd - i < kBlock ? vectorEnd : i + kBlock;
+        __m256 acc = _mm256_setzero_ps();
+        for (; i < blockEnd; i += 8) {
+            const __m256 u1 = unit8(hash8(_mm256_xor_si256(index, vkey1)));
+            const __m256 u2 = unit8(hash8(_mm256_xor_si256(index, vkey2)));
+            acc = _mm256_fmadd_ps(sin8(u1), cos8(u2), acc);
+            index = _mm256_add_epi32(index, step);
+        }
+        sum += hsum8(acc);
+    }
+    for (; i < count; ++i) {
+        const std::uint32_t scalarIndex = begin + static_cast<std::uint32_t>(i);
+        sum += sinPoly(unitFloat(hash(scalarIndex ^ key1))) * cosPoly(unitFloat(hash(scalarIndex ^ key2)));
+    }
+    return sum;
+}
+
+std::int64_t squareSumAvx2(std::uint32_t seed, std::uint32_t begin, std::size_t count)
+{
+    const std::uint32_t key = streamKey(seed);
+    const __m256i vkey = _mm256_set1_epi32(static_cast<int>(key));
+    const __m256i step = _mm256_set1_epi32(8);
+    const __m256 thousand = _mm256_set1_ps(1000.0f);
+    __m256i index = firstIndices(begin);
+
+    std::int64_t sum = 0;
+    std::size_t i = 0;
+    const std::size_t vectorEnd = count & ~std::size_t(7);
+    while (i < vectorEnd) {
+        const std::size_t blockEnd = vectorEnd - i < kBlock ? vectorEnd : i + kBlock;
+        __m256i acc = _mm256_setzero_si256();
+        for (; i < blockEnd; i += 8) {
+            // 这里不用 FMA：先平方、再乘 1000 各舍入一次，与其他级别逐项一致
+            const __m256 u = unit8(hash8(_mm256_xor_si256(index, vkey)));
+            acc = _mm256_add_epi32(acc, _mm256_cvttps_epi32(_mm256_mul_ps(_mm256_mul_ps(u, u), thousand)));
+            index = _mm256_add_epi32(index, step);
+        }
+        sum += hsum8(acc);
+    }
+    for (; i < count; ++i) {
+        sum += squareTerm(unitFloat(hash((begin + static_cast<std::uint32_t>(i)) ^ key)));
+    }
+    return sum;
+}
+
+} // namespace SimdIsa
+
+#else
+
+namespace SimdIsa {
+
+// 没有以 AVX2 编译（非 x86 平台或编译器不支持）：simdBestLevel() 不会选 AVX2，下面两个函数不会被调用
+bool avx2Compiled()
+{
+    return false;
+}
+
+double sinCosSumAvx2(std::uint32_t, std::uint32_t, std::size_t)
+{
+    return 0.0;
+}
+
+std::int64_t squareSumAvx2(std::uint32_t, std::uint32_t, std::size_t)
+{
+    return 0;
+}
+
+} // namespace SimdIsa
+
+#endif
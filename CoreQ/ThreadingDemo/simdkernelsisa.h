@@ -0,0 +1,75 @@
+#pragma once
+
+/*
+ * 各指令集版本的 SIMD 内核之间共享的声明和常量（内部使用，界面代码请包含 simdkernels.h）
+ *
+ * AVX2 版本所在的 simdkernelsavx2.cpp 单独以 -mavx2 -mfma（MSVC 为 /arch:AVX2）编译。
+ * 这个头文件因此只放纯 C 类型的声明和 constexpr 常量：如果 AVX2 翻译单元里实例化了
+ * Qt 或标准库的内联函数，链接器可能把这份带 AVX2 指令的副本挑给其他翻译单元用，
+ * 在不支持 AVX2 的 CPU 上就会非法指令崩溃。
+ */
+
+#include <cstddef>
+#include <cstdint>
+
+namespace SimdIsa {
+
+// 计数器型随机数：第 index 个数只由 (key, index) 决定，lowbias32 整数哈希（Chris Wellons）
+constexpr std::uint32_t kHashMul1 = 0x7feb352du;
+constexpr std::uint32_t kHashMul2 = 0x846ca68bu;
+constexpr std::uint32_t kSeedMul = 0x9e3779b9u;
+constexpr std::uint32_t kSecondStream = 0x85ebca6bu; // sin/cos 内核第二个随机数流的密钥扰动
+constexpr float kUnitScale = 1.0f / 16777216.0f;     // 高 24 位 -> [0, 1)
+
+// [0, 1] 上的泰勒多项式（Horner 形式），误差在 float 精度以内；更大的输入需要先做区间约简
+constexpr float kSin3 = -1.0f / 6.0f;
+constexpr float kSin5 = 1.0f / 120.0f;
+constexpr float kSin7 = -1.0f / 5040.0f;
+constexpr float kSin9 = 1.0f / 362880.0f;
+constexpr float kCos2 = -1.0f / 2.0f;
+constexpr float kCos4 = 1.0f / 24.0f;
+constexpr float kCos6 = -1.0f / 720.0f;
+constexpr float kCos8 = 1.0f / 40320.0f;
+constexpr float kCos10 = -1.0f / 3628800.0f;
+
+// 向量累加器每处理这么多项就归约进 double / int64 一次：
+// float 累加器不至于丢精度，int32 累加器（每项 < 1000）不会溢出
+constexpr std::size_t kBlock = 4096;
+
+// 下面几个辅助函数用于向量宽度以外的尾部；声明为 static，每个翻译单元各有一份，不参与链接时的合并
+static inline std::uint32_t streamKey(std::uint32_t seed) { return seed * kSeedMul; }
+
+static inline std::uint32_t hash(std::uint32_t x)
+{
+    x ^= x >> 16;
+    x *= kHashMul1;
+    x ^= x >> 15;
+    x *= kHashMul2;
+    x ^= x >> 16;
+    return x;
+}
+
+static inline float unitFloat(std::uint32_t bits) { return static_cast<float>(bits >> 8) * kUnitScale; }
+
+static inline float sinPoly(float x)
+{
+    const float x2 = x * x;
+    const float p = ((kSin9 * x2 + kSin7) * x2 + kSin5) * x2 + kSin3;
+    return x + x * x2 * p;
+}
+
+static inline float cosPoly(float x)
+{
+    const float x2 = x * x;
+    const float p = (((kCos10 * x2 + kCos8) * x2 + kCos6) * x2 + kCos4) * x2 + kCos2;
+    return 1.0f + x2 * p;
+}
+
+// 与向量版本相同的运算顺序（先平方再乘 1000，都是 float），所以各级别的结果逐项一致
+static inline std::int32_t squareTerm(float u) { return static_cast<std::int32_t>(u * u * 1000.0f); }
+
+bool avx2Compiled();
+double sinCosSumAvx2(std::uint32_t seed, std::uint32_t begin, std::size_t count);
+std::int64_t squareSumAvx2(std::uint32_t seed, std::uint32_t begin, std::size_t count);
+
+} // namespace SimdIsa
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+
+/*
+ * SpscRingBuffer：单生产者/单消费者无锁环形队列
+ *
+ * 只允许一个线程调用 tryPush/tryEmplace、一个线程调用 tryPop：
+ * - 写索引 m_tail 只由生产者写，读索引 m_head 只由消费者写，无需 CAS，
+ *   同步只靠一对 release-store / acquire-load，入队/出队都是 wait-free；
+ * - 双方各自缓存对方的索引（m_cachedHead / m_cachedTail），只有缓存值显示
+ *   满/空时才去读对方的缓存行，稳态下几乎不产生跨核缓存行传递；
+ * - 生产者侧与消费者侧的字段分别放在独立缓存行，避免伪共享。
+ */
+template <typename T>
+class SpscRingBuffer
+{
+public:
+    static constexpr std::size_t kCacheLine = 64;
+
+    explicit SpscRingBuffer(std::size_t capacity)
+        : m_capacity(capacity > 0 ? capacity : 1)
+        , m_slots(new Slot[m_capacity])
+    {
+    }
+
+    ~SpscRingBuffer()
+    {
+        T item;
+        while (tryPop(item)) {
+        }
+    }
+
+    SpscRingBuffer(const SpscRingBuffer &) = delete;
+    SpscRingBuffer &operator=(const SpscRingBuffer &) = delete;
+
+    // 以下三个接口只能由生产者线程调用；失败时不会移动 item
+    bool tryPush(const T &item) { return tryEmplace(item); }
+    bool tryPush(T &&item) { return tryEmplace(std::move(item)); }
+
+    template <typename... Args>
+    bool tryEmplace(Args &&...args)
+    {
+        const std::size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_cachedHead == m_capacity) {
+            m_cachedHead = m_head.load(std::memory_order_acquire);
+            if (tail - m_cachedHead == m_capacity) {
+                return false; // 已满
+            }
+        }
+        new (m_slots[tail % m_capacity].storage) T(std::forward<Args>(args)...);
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 只能由消费者线程调用
+    bool tryPop(T &out)
+    {
+        const std::size_t head = m_head.load(std::memory_order_relaxed);
+        if (head == m_cachedTail) {
+            m_cachedTail = m_tail.load(std::memory_order_acquire);
+            if (head == m_cachedTail) {
+                return false; // 已空
+            }
+        }
+        T *item = m_slots[head % m_capacity].ptr();
+        out = std::move(*item);
+        item->~T();
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    std::size_t capacity() const { return m_capacity; }
+
+    // 近似元素个数：仅用于显示/统计
+    std::size_t sizeApprox() const
+    {
+        const std::size_t head = m_head.load(std::memory_order_acquire);
+        const std::size_t tail = m_tail.load(std::memory_order_acquire);
+        return tail > head ? tail - head : 0;
+    }
+
+private:
+    struct Slot
+    {
+        alignas(T) unsigned char storage[sizeof(T)];
+
+        T *ptr() { return std::launder(reinterpret_cast<T *>(storage)); }
+    };
+
+    const std::size_t m_capacity;
+    std::unique_ptr<Slot[]> m_slots;
+
+    // 消费者侧：读索引 + 对写索引的缓存
+    alignas(kCacheLine) std::atomic<std::size_t> m_head{0};
+    std::size_t m_cachedTail = 0;
+
+    // 生产者侧：写索引 + 对读索引的缓存
+    alignas(kCacheLine) std::atomic<std::size_t> m_tail{0};
+    std::size_t m_cachedHead = 0;
+};
@@ -5,7 +5,6 @@
 #include <QScrollBar>
 #include <algorithm>
 #include <random>
-#include <cmath>
 
 StdThreadWidget::StdThreadWidget(QWidget *parent)
     : QWidget(parent)
@@ -65,9 +64,18 @@ void StdThreadWidget::initUI()
     
     multiLayout->addWidget(new QLabel("迭代次数:"));
     m_iterations = new QSpinBox();
-    m_iterations->setRange(100, 10000);
-    m_iterations->setValue(1000);
+    m_iterations->setRange(100, 100000000);
+    m_iterations->setValue(1000000);
     multiLayout->addWidget(m_iterations);
+
+    multiLayout->addWidget(new QLabel("计算内核:"));
+    m_kernelCombo = new QComboBox();
+    for (SimdLevel level : simdAvailableLevels()) {
+        m_kernelCombo->addItem(simdLevelName(level), static_cast<int>(level));
+    }
+    m_kernelCombo->setCurrentIndex(m_kernelCombo->count() - 1);
+    m_kernelCombo->setToolTip("本机 CPU 支持的内核；SIMD 内核批量生成随机数并用多项式近似 sin/cos");
+    multiLayout->addWidget(m_kernelCombo);
     
     m_startMultiBtn = new QPushButton("启动多线程任务");
     multiLayout->addWidget(m_startMultiBtn);
@@ -198,6 +206,7 @@ void StdThreadWidget::startMultipleThreads()
     
     int threadCount = m_threadCount->value();
     int iterations = m_iterations->value();
+    const auto level = static_cast<SimdLevel>(m_kernelCombo->currentData().toInt());
     m_totalTasks = threadCount;
     
     // 更新UI状态
@@ -210,12 +219,12 @@ void StdThreadWidget::startMultipleThreads()
     m_statusLabel->setText(QString("多线程运行中... (0/%1)").arg(threadCount));
     
     addLogSafe("=== 启动多线程演示 ===");
-    addLogSafe(QString("创建 %1 个线程，每个线程执行 %2 次迭代")
-               .arg(threadCount).arg(iterations));
+    addLogSafe(QString("创建 %1 个线程，每个线程执行 %2 次迭代，计算内核: %3")
+               .arg(threadCount).arg(iterations).arg(simdLevelName(level)));
     
     // 创建多个线程
     for (int i = 0; i < threadCount; ++i) {
-        m_threads.emplace_back(&StdThreadWidget::multiThreadWork, this, i + 1, iterations);
+        m_threads.emplace_back(&StdThreadWidget::multiThreadWork, this, i + 1, iterations, level);
         addLogSafe(QString("创建线程 %1").arg(i + 1));
     }
 }
@@ -341,36 +350,38 @@ void StdThreadWidget::singleThreadWork(int threadId, int workTime)
     m_completedTasks++;
 }
 
-void StdThreadWidget::multiThreadWork(int threadId, int iterations)
+void StdThreadWidget::multiThreadWork(int threadId, int iterations, SimdLevel level)
 {
     addLogSafe(QString("[线程 %1] 开始执行 %2 次迭代")
                .arg(threadId).arg(iterations));
 
     auto startTime = std::chrono::steady_clock::now();
 
-    // 模拟计算密集型任务
+    // 模拟计算密集型任务：每个线程一个随机种子，第 i 次迭代的随机数由 (种子, i) 直接算出，
+    // 所以可以按块批量生成并交给向量化内核，不必逐个调用随机数引擎
     std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_real_distribution<> dis(0.0, 1.0);
+    const quint32 seed = rd();
+    constexpr int kChunk = 4096;
 
     double result = 0.0;
     int step = std::max(1, iterations / 10);
-    for (int i = 0; i < iterations && !m_stopFlag; ++i) {
-        // 模拟一些计算
-        result += std::sin(dis(gen)) * std::cos(dis(gen));
+    int done = 0;
+    while (done < iterations && !m_stopFlag) {
+        const int chunk = std::min(kChunk, iterations - done);
+        result += simdSinCosSum(level, seed, static_cast<quint32>(done), static_cast<std::size_t>(chunk));
+        const int previous = done;
+        done += chunk;
 
-        // 每完成固定步长报告一次进度（避免除以0）
-        if (i % step == 0 && i > 0) {
+        // 每跨过一个固定步长报告一次进度（避免除以0）
+        if (done / step != previous / step && done < iterations) {
             addLogSafe(QString("[线程 %1] 进度: %2% (结果: %3)")
                        .arg(threadId)
-                       .arg(i * 100 / iterations)
+                       .arg(static_cast<int>(static_cast<qint64>(done) * 100 / iterations))
                        .arg(result, 0, 'f', 2));
         }
 
-        // 偶尔让出CPU时间
-        if (i % 100 == 0) {
-            std::this_thread::yield();
-        }
+        // 每块之间检查停止标志并让出CPU时间
+        std::this_thread::yield();
     }
 
     auto endTime = std::chrono::steady_clock::now();
@@ -11,12 +11,14 @@
 #include <QTimer>
 #include <QSpinBox>
 #include <QGroupBox>
+#include <QComboBox>
 #include <thread>
 #include <atomic>
 #include <chrono>
 #include <vector>
 #include <mutex>
 #include <future>
+#include "simdkernels.h"
 /**
  * @class StdThreadWidget
  * @brief std::thread 演示类 - C++11标准线程库的使用示例
@@ -111,8 +113,9 @@ private:
      * @brief 多线程工作函数
      * @param threadId 线程标识符
      * @param iterations 迭代次数
+     * @param level 计算内核（标量或 SIMD），每块迭代批量生成随机数并向量化计算
      */
-    void multiThreadWork(int threadId, int iterations);
+    void multiThreadWork(int threadId, int iterations, SimdLevel level);
     
     /**
      * @brief 线程安全的日志添加函数
@@ -135,6 +138,7 @@ private:
     QSpinBox* m_singleWorkTime;         ///< 单线程工作时间设置
     QSpinBox* m_threadCount;            ///< 线程数量设置
     QSpinBox* m_iterations;             ///< 迭代次数设置
+    QComboBox* m_kernelCombo;           ///< 计算内核选择（标量/SSE2/AVX2）
     
     QProgressBar* m_progressBar;        ///< 进度条
     QLabel* m_statusLabel;              ///< 状态标签
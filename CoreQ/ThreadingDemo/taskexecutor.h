@@ -0,0 +1,76 @@
+#pragma once
+
+#include <QRunnable>
+#include <QString>
+#include <QThreadPool>
+#include <atomic>
+#include <functional>
+#include <thread>
+
+/*
+ * TaskExecutor：演示里可以互换的任务执行器
+ *
+ * - execute()：提交一个独立任务，不关心何时完成；
+ * - invoke(a, b)：fork-join 的基本形式，a 交给执行器、b 在当前线程执行，两者都完成后返回；
+ *   递归算法（并行 fib、快速排序）只需要它。等待 a 的线程不能干等：
+ *   工作线程全都阻塞在等子任务上时就没有人去执行子任务了，所以各实现都要在等待时设法推进 a。
+ */
+class TaskExecutor
+{
+public:
+    virtual ~TaskExecutor() = default;
+
+    virtual QString name() const = 0;
+    virtual int threadCount() const = 0;
+    virtual void execute(std::function<void()> task) = 0;
+    virtual void invoke(const std::function<void()> &a, const std::function<void()> &b) = 0;
+};
+
+/*
+ * QThreadPoolExecutor：以 QThreadPool（默认全局线程池，即 QtConcurrent::run 所用的那个）作为执行器
+ *
+ * QThreadPool 只有一条加锁的共享队列：每次提交、每次取任务都要抢同一把锁。
+ * invoke() 在等待时用 tryTake() 把还没开始的 a 收回来自己执行（这也要拿那把锁，
+ * 还要线性扫描队列）；a 已被别的线程取走时只能让出 CPU 等它做完。
+ */
+class QThreadPoolExecutor : public TaskExecutor
+{
+public:
+    explicit QThreadPoolExecutor(QThreadPool *pool = QThreadPool::globalInstance()) : m_pool(pool) {}
+
+    QString name() const override { return "QThreadPool"; }
+    int threadCount() const override { return m_pool->maxThreadCount(); }
+
+    void execute(std::function<void()> task) override { m_pool->start(QRunnable::create(std::move(task))); }
+
+    void invoke(const std::function<void()> &a, const std::function<void()> &b) override
+    {
+        // 放在栈上、不自动删除：线程池在调用 run() 之前就读取了 autoDelete()，
+        // run() 里置位 done 之后不会再访问它
+        InvokeTask task(a);
+        m_pool->start(&task);
+        b();
+        if (m_pool->tryTake(&task)) {
+            a();
+            return;
+        }
+        while (!task.done.load(std::memory_order_acquire)) {
+            std::this_thread::yield();
+        }
+    }
+
+private:
+    struct InvokeTask : QRunnable {
+        explicit InvokeTask(const std::function<void()> &f) : fn(f) { setAutoDelete(false); }
+        void run() override
+        {
+            fn();
+            done.store(true, std::memory_order_release);
+        }
+
+        const std::function<void()> &fn;
+        std::atomic<bool> done{false};
+    };
+
+    QThreadPool *m_pool;
+};
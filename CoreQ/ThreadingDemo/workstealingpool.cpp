@@ -0,0 +1,242 @@
+#include "workstealingpool.h"
+#include <QMutexLocker>
+#include <QThread>
+#include "adaptivewait.h"
+
+namespace {
+
+// 当前线程所属的池和工作线程（非工作线程为空）
+thread_local const WorkStealingPool *t_pool = nullptr;
+thread_local void *t_worker = nullptr;
+
+// 休眠前的空转轮数：刚做完任务的线程很可能马上又有活，先别睡
+constexpr int kSpinRounds = 64;
+
+quint32 nextRandom(quint32 &state)
+{
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+// 计数器只由本线程写，不需要原子的读-改-写
+void bump(std::atomic<quint64> &counter)
+{
+    counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+} // namespace
+
+WorkStealingPool::WorkStealingPool(int threads)
+{
+    const int count = threads > 0 ? threads : qMax(1, QThread::idealThreadCount());
+    for (int i = 0; i < count; ++i) {
+        m_workers.emplace_back(new Worker);
+        m_workers.back()->rng = 0x9E3779B9u * static_cast<quint32>(i + 1);
+    }
+    for (auto &worker : m_workers) {
+        m_threads.emplace_back([this, self = worker.get()] { workerLoop(self); });
+    }
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+    m_stop.store(true, std::memory_order_seq_cst);
+    {
+        QMutexLocker locker(&m_sleepMutex);
+        m_epoch.fetch_add(1, std::memory_order_seq_cst);
+        m_wake.wakeAll();
+    }
+    for (auto &thread : m_threads) {
+        thread.join();
+    }
+}
+
+void WorkStealingPool::execute(std::function<void()> task)
+{
+    Task *t = new Task;
+    t->owned = std::move(task);
+    t->fn = &t->owned;
+    t->detached = true;
+    if (Worker *self = currentWorker()) {
+        self->deque.push(t);
+    } else {
+        QMutexLocker locker(&m_injectMutex);
+        m_injected.push_back(t);
+        m_injectedCount.fetch_add(1, std::memory_order_relaxed);
+    }
+    wakeIfSleeping();
+}
+
+void WorkStealingPool::invoke(const std::function<void()> &a, const std::function<void()> &b)
+{
+    Worker *self = currentWorker();
+    if (!self) {
+        // 外部线程：a 交给池，自己做 b，然后等 a
+        std::atomic<bool> done{false};
+        execute([&a, &done] {
+            a();
+            done.store(true, std::memory_order_release);
+        });
+        b();
+        while (!done.load(std::memory_order_acquire)) {
+            std::this_thread::yield();
+        }
+        return;
+    }
+
+    Task task;
+    task.fn = &a;
+    self->deque.push(&task);
+    wakeIfSleeping();
+    b();
+    // a 没被偷走时，下面第一次 findTask() 取到的就是它
+    while (!task.done.load(std::memory_order_acquire)) {
+        if (Task *next = findTask(self)) {
+            runTask(self, next);
+        } else {
+            cpuRelax();
+        }
+    }
+}
+
+WorkStealingStats WorkStealingPool::stats() const
+{
+    WorkStealingStats total;
+    for (const auto &worker : m_workers) {
+        total.executed += worker->executed.load(std::memory_order_relaxed);
+        total.localPops += worker->localPops.load(std::memory_order_relaxed);
+        total.steals += worker->steals.load(std::memory_order_relaxed);
+        total.stealAttempts += worker->stealAttempts.load(std::memory_order_relaxed);
+        total.injected += worker->injected.load(std::memory_order_relaxed);
+        total.parks += worker->parks.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+WorkStealingPool::Worker *WorkStealingPool::currentWorker() const
+{
+    return t_pool == this ? static_cast<Worker *>(t_worker) : nullptr;
+}
+
+// 先自己的队列，再偷，最后看外部提交队列
+WorkStealingPool::Task *WorkStealingPool::findTask(Worker *self)
+{
+    if (Task *task = self->deque.pop()) {
+        bump(self->localPops);
+        return task;
+    }
+    if (Task *task = steal(self)) {
+        return task;
+    }
+    if (m_injectedCount.load(std::memory_order_relaxed) > 0) {
+        QMutexLocker locker(&m_injectMutex);
+        if (!m_injected.empty()) {
+            Task *task = m_injected.front();
+            m_injected.pop_front();
+            m_injectedCount.fetch_sub(1, std::memory_order_relaxed);
+            bump(self->injected);
+            return task;
+        }
+    }
+    return nullptr;
+}
+
+// 从随机位置开始把其他线程轮一遍，随机化避免所有空闲线程同时扑向同一个目标
+WorkStealingPool::Task *WorkStealingPool::steal(Worker *self)
+{
+    const std::size_t count = m_workers.size();
+    if (count < 2) {
+        return nullptr;
+    }
+    const std::size_t start = nextRandom(self->rng) % count;
+    for (std::size_t i = 0; i < count; ++i) {
+        Worker *victim = m_workers[(start + i) % count].get();
+        if (victim == self || victim->deque.sizeApprox() == 0) {
+            continue;
+        }
+        bump(self->stealAttempts);
+        if (Task *task = victim->deque.steal()) {
+            bump(self->steals);
+            return task;
+        }
+    }
+    return nullptr;
+}
+
+void WorkStealingPool::runTask(Worker *self, Task *task)
+{
+    (*task->fn)();
+    bump(self->executed);
+    if (task->detached) {
+        delete task;
+    } else {
+        // 置位之后 invoke() 的调用方可能立即返回、销毁栈上的 task，之后不能再碰它
+        task->done.store(true, std::memory_order_release);
+    }
+}
+
+/*
+ * 提交方：任务已经可见之后，只有看到有人在睡才推进 epoch 并唤醒；
+ * 与 park() 里 “先登记 sleepers、再复查一遍” 配对：两边都在 “写” 和 “读” 之间放一道 seq_cst 栅栏
+ * （这边是任务入队与读 sleepers，那边是登记 sleepers 与读队列），
+ * 队列本身的读写不是 seq_cst，少了任何一边的栅栏，两边就可能都读到旧值而漏唤醒
+ */
+void WorkStealingPool::wakeIfSleeping()
+{
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (m_sleepers.load(std::memory_order_seq_cst) == 0) {
+        return;
+    }
+    QMutexLocker locker(&m_sleepMutex);
+    m_epoch.fetch_add(1, std::memory_order_seq_cst);
+    m_wake.wakeOne();
+}
+
+void WorkStealingPool::park(Worker *self)
+{
+    m_sleepers.fetch_add(1, std::memory_order_seq_cst);
+    // 与 wakeIfSleeping() 开头的栅栏配对：之后 findTask() 对队列的读取不会排到登记之前
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const quint64 epoch = m_epoch.load(std::memory_order_seq_cst);
+    // 登记之后再找一次：登记前提交的任务在这里一定能看到
+    if (Task *task = findTask(self)) {
+        m_sleepers.fetch_sub(1, std::memory_order_seq_cst);
+        runTask(self, task);
+        return;
+    }
+    {
+        QMutexLocker locker(&m_sleepMutex);
+        if (m_epoch.load(std::memory_order_seq_cst) == epoch && !m_stop.load(std::memory_order_seq_cst)) {
+            bump(self->parks);
+            m_wake.wait(&m_sleepMutex);
+        }
+    }
+    m_sleepers.fetch_sub(1, std::memory_order_seq_cst);
+}
+
+void WorkStealingPool::workerLoop(Worker *self)
+{
+    t_pool = this;
+    t_worker = self;
+    int idleRounds = 0;
+    while (true) {
+        if (Task *task = findTask(self)) {
+            runTask(self, task);
+            idleRounds = 0;
+            continue;
+        }
+        if (m_stop.load(std::memory_order_seq_cst)) {
+            break;
+        }
+        if (++idleRounds < kSpinRounds) {
+            cpuRelax();
+            continue;
+        }
+        idleRounds = 0;
+        park(self);
+    }
+    t_pool = nullptr;
+    t_worker = nullptr;
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <QMutex>
+#include <QWaitCondition>
+#include <QtGlobal>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "chaselevdeque.h"
+#include "taskexecutor.h"
+
+// 工作窃取池的累计统计（所有工作线程求和）
+struct WorkStealingStats {
+    quint64 executed = 0;      // 工作线程执行的任务数（invoke 里被收回就地执行的也算）
+    quint64 localPops = 0;     // 从自己的双端队列底部取到的
+    quint64 steals = 0;        // 从别的线程队列顶部偷到的
+    quint64 stealAttempts = 0; // 去偷的次数（含空手而归）
+    quint64 injected = 0;      // 从外部提交队列取到的
+    quint64 parks = 0;         // 找不到任务而休眠的次数
+};
+
+/*
+ * WorkStealingPool：每个工作线程一个 Chase-Lev 双端队列的线程池
+ *
+ * - 工作线程里产生的任务压进自己的队列底部，自己也从底部取（LIFO，缓存最热、无锁无竞争）；
+ * - 自己的队列空了，从随机选的一个线程开始轮询，从别人队列顶部偷最老的任务；
+ * - 非工作线程 execute() 的任务进一条加锁的外部提交队列，只在偷不到时才去看它；
+ * - 找不到任务时短暂自旋再休眠：提交方只在有线程休眠时才去拿锁唤醒，任务密集时提交不碰共享状态；
+ * - invoke() 等待时不阻塞：先取自己队列里的任务（通常就是刚压进去的 a），a 被偷走了就去偷别的任务做。
+ * 析构时执行完已提交的任务再退出。
+ */
+class WorkStealingPool : public TaskExecutor
+{
+public:
+    explicit WorkStealingPool(int threads = 0);
+    ~WorkStealingPool() override;
+
+    WorkStealingPool(const WorkStealingPool &) = delete;
+    WorkStealingPool &operator=(const WorkStealingPool &) = delete;
+
+    QString name() const override { return "WorkStealingPool"; }
+    int threadCount() const override { return static_cast<int>(m_workers.size()); }
+    void execute(std::function<void()> task) override;
+    void invoke(const std::function<void()> &a, const std::function<void()> &b) override;
+
+    WorkStealingStats stats() const;
+
+private:
+    struct Task {
+        std::function<void()> owned;             // execute() 提交的任务：由池持有，执行后删除
+        const std::function<void()> *fn = nullptr; // 指向 owned，或 invoke() 调用方栈上的函数
+        std::atomic<bool> done{false};
+        bool detached = false;
+    };
+
+    struct Worker {
+        ChaseLevDeque<Task> deque;
+        quint32 rng = 0;
+        // 只由本线程写，stats() 随时读
+        std::atomic<quint64> executed{0};
+        std::atomic<quint64> localPops{0};
+        std::atomic<quint64> steals{0};
+        std::atomic<quint64> stealAttempts{0};
+        std::atomic<quint64> injected{0};
+        std::atomic<quint64> parks{0};
+    };
+
+    Worker *currentWorker() const;
+    Task *findTask(Worker *self);
+    Task *steal(Worker *self);
+    void runTask(Worker *self, Task *task);
+    void wakeIfSleeping();
+    void park(Worker *self);
+    void workerLoop(Worker *self);
+
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    std::vector<std::thread> m_threads;
+
+    QMutex m_injectMutex;
+    std::deque<Task *> m_injected;
+    std::atomic<std::size_t> m_injectedCount{0};
+
+    alignas(64) std::atomic<int> m_sleepers{0};
+    std::atomic<quint64> m_epoch{0};
+    QMutex m_sleepMutex;
+    QWaitCondition m_wake;
+    std::atomic<bool> m_stop{false};
+};